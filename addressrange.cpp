@@ -2,3 +2,12 @@
 
 const AddressRange AddressRange::Max(0, 0xffff);
 const AddressRange AddressRange::Invalid = AddressRange();
+
+std::array<AddressRange, 2> AddressRange::wrapping(Address first, size_t size) {
+  if (!size) return {Invalid, Invalid};
+  if (size > 0xffff) return {Max, Invalid};
+
+  const auto last = first + size - 1;
+  if (last <= 0xffff) return {AddressRange(first, static_cast<Address>(last)), Invalid};
+  return {AddressRange(first, 0xffff), AddressRange(0, static_cast<Address>(last))};
+}
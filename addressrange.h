@@ -2,6 +2,7 @@
 
 #include "commondefs.h"
 #include <algorithm>
+#include <array>
 #include <cstdint>
 
 struct AddressRange {
@@ -15,7 +16,9 @@ struct AddressRange {
   bool valid() const { return first <= last; }
   size_t size() const { return last - first + 1; }
   bool contains(Address addr) const { return addr == std::clamp(addr, first, last); }
-  bool overlapsWith(AddressRange range) const { return range.contains(first) || range.contains(last); }
+  bool overlapsWith(AddressRange range) const {
+    return valid() && range.valid() && first <= range.last && range.first <= last;
+  }
 
   void expand(Address addr) {
     if (valid()) {
@@ -26,6 +29,10 @@ struct AddressRange {
     }
   }
 
+  // of size bytes from first on, which wrap past $FFFF to $0000: the part up to $FFFF and the part from $0000,
+  // which is Invalid unless they wrap
+  static std::array<AddressRange, 2> wrapping(Address first, size_t size);
+
   static const AddressRange Max;
   static const AddressRange Invalid;
 };
@@ -1,81 +1,31 @@
 #include "assembler.h"
 #include "instructiontable.h"
-#include "mnemonics.h"
-#include <QRegularExpression>
 #include <algorithm>
 
-static constexpr auto LabelGroup = 1;
-static constexpr auto OperationGroup = 2;
-static constexpr auto FirstOperandGroup = 3;
-
-static constexpr QChar LoBytePrefix('<');
-static constexpr QChar HiBytePrefix('>');
-static constexpr QChar HexPrefix('$');
-static constexpr QChar BinPrefix('%');
-
-static const QString Symbol("[a-z]\\w*");
-static const QString Label("^(?:(" + Symbol + "):)?\\s*");
-static const QString Comment("(?:;.*)?$");
-static const QString OrgCmd("((?:\\.ORG\\s+)|(?:\\*\\s*\\=\\s*))");
-static const QString ByteCmd("(\\.BYTE|DCB)\\s+");
-static const QString WordCmd("(\\.WORD)\\s+");
-static const QString HexNum("\\$[\\d|a-h]{1,4}");
-static const QString DecNum("\\d{1,5}");
-static const QString BinNum("\\%[01]{1,16}");
-static const QString Mnemonic("([a-z]{3})\\s*");
-static const QString NumOrSymbol("(?:" + HexNum + ")|(?:" + DecNum + ")|(?:" + BinNum + ")|(?:" + Symbol + ")");
-static const QString LoHiPrefix("[" + QString(LoBytePrefix) + "|" + QString(HiBytePrefix) + "]?");
-static const QString Operand("(" + LoHiPrefix + "(?:" + NumOrSymbol + "))\\s*");
-static const QString OperandSeparator("\\s*,?\\s*");
-static const QString OperandList("((?:(?:" + LoHiPrefix + "(?:" + NumOrSymbol + "))" + OperandSeparator + ")+)\\s*");
-static const QString BranchMnemonic("(BCC|BCS|BNE|BEQ|BMI|BPL|BVC|BVS)\\s*");
-static const QString BranchTarget("((?:[+|-]?\\d{1,3})|(?:" + Symbol + "))\\s*");
-
-Assembler::PatternEntry::PatternEntry(const QString& pattern, const Handler handler)
-    : regex(Label + pattern + Comment, QRegularExpression::CaseInsensitiveOption), handler(handler) {
-}
-
-const Assembler::PatternEntry Assembler::Patterns[]{{"", &Assembler::handleNoOperation},
-                                                    {OrgCmd + Operand, &Assembler::handleSetLocationCounter},
-                                                    {ByteCmd + OperandList, &Assembler::handleEmitBytes},
-                                                    {WordCmd + OperandList, &Assembler::handleEmitWords},
-                                                    {Mnemonic, &Assembler::handleImpliedOrAccumulator},
-                                                    {Mnemonic + "#" + Operand, &Assembler::handleImmediate},
-                                                    {BranchMnemonic + BranchTarget, &Assembler::handleBranch},
-                                                    {Mnemonic + Operand, &Assembler::handleAbsolute},
-                                                    {Mnemonic + Operand + ",x", &Assembler::handleAbsoluteIndexedX},
-                                                    {Mnemonic + Operand + ",y", &Assembler::handleAbsoluteIndexedY},
-                                                    {Mnemonic + "\\(" + Operand + "\\)", &Assembler::handleIndirect},
-                                                    {Mnemonic + "\\(" + Operand + ",x\\)", &Assembler::handleIndexedIndirectX},
-                                                    {Mnemonic + "\\(" + Operand + "\\),y", &Assembler::handleIndirectIndexedY}};
-
-static const QRegularExpression OperandItemRegEx(Operand + OperandSeparator, QRegularExpression::CaseInsensitiveOption);
-
-static InstructionType resolveInstructionType(const QString& str) {
-  const auto it = std::find_if(MnemonicTable.begin(), MnemonicTable.end(), [=](const auto& kv) { return str == kv.second; });
-  if (it == MnemonicTable.end()) throw AssemblyResult::InvalidMnemonic;
-  return it->first;
+static OperandsFormat zeroPageMode(OperandsFormat mode) {
+  switch (mode) {
+  case OperandsFormat::Absolute: return OperandsFormat::ZeroPage;
+  case OperandsFormat::AbsoluteX: return OperandsFormat::ZeroPageX;
+  case OperandsFormat::AbsoluteY: return OperandsFormat::ZeroPageY;
+  default: return mode;
+  }
 }
 
+// stays absolute where there is no zero page form, e.g. LDA abs,Y
 static OperandsFormat adjustAddressingMode(InstructionType type, OperandsFormat mode, bool zp) {
-  if (zp && type != InstructionType::JMP && type != InstructionType::JSR) {
-    switch (mode) {
-    case OperandsFormat::Absolute: return OperandsFormat::ZeroPage;
-    case OperandsFormat::AbsoluteX: return OperandsFormat::ZeroPageX;
-    case OperandsFormat::AbsoluteY: return OperandsFormat::ZeroPageY;
-    default: break;
-    }
-  }
+  if (zp && type != InstructionType::JMP && type != InstructionType::JSR && OpcodeTable[type][zeroPageMode(mode)] >= 0)
+    return zeroPageMode(mode);
   return mode;
 }
 
-static const Instruction* resolveInstruction(const QString& str, OperandsFormat mode, bool zp) {
-  const auto type = resolveInstructionType(str.toUpper());
-  const auto adjustedMode = adjustAddressingMode(type, mode, zp);
-  const auto it = std::find_if(InstructionTable.begin(), InstructionTable.end(),
-                               [=](const Instruction& ins) { return ins.type == type && ins.mode == adjustedMode; });
-  if (it == InstructionTable.end()) { throw AssemblyResult::InvalidInstructionFormat; }
-  return it;
+static bool hasZeroPageForm(InstructionType type, OperandsFormat mode) {
+  return adjustAddressingMode(type, mode, true) != mode;
+}
+
+static uint8_t resolveOpcode(InstructionType type, OperandsFormat mode, bool zp) {
+  const auto opcode = OpcodeTable[type][adjustAddressingMode(type, mode, zp)];
+  if (opcode < 0) throw AssemblyResult::InvalidInstructionFormat;
+  return static_cast<uint8_t>(opcode);
 }
 
 template <typename T>
@@ -85,30 +35,6 @@ T safeCast(int n) {
   throw AssemblyResult::ValueOutOfRange;
 }
 
-static bool isNumber(const QString& str) {
-  const auto front = str.front();
-  return front == HexPrefix || front == BinPrefix || front.isDigit() || front == '+' || front == '-';
-}
-
-static int parseNumber(const QString& str) {
-  const auto op = str;
-  const auto front = op.front();
-  if (front == HexPrefix) return op.right(op.length() - 1).toInt(nullptr, 16);
-  if (front == BinPrefix) return op.right(op.length() - 1).toInt(nullptr, 2);
-  return op.toInt(nullptr, 10);
-}
-
-static std::vector<QString> split(const QString& str) {
-  std::vector<QString> items;
-  int offset = 0;
-  QRegularExpressionMatch m;
-  while ((m = OperandItemRegEx.match(str, offset)).hasMatch()) {
-    offset = m.capturedEnd();
-    items.push_back(m.captured(1));
-  }
-  return items;
-}
-
 Assembler::Assembler(Memory& memory) : memory(memory) {
   init();
 }
@@ -119,30 +45,64 @@ void Assembler::initPreserveSymbols(Address addr) {
   locationCounter = addr;
   lastLocationCounter = addr;
   written = 0;
+  definedInPass.clear();
+  sizeGuesses.clear();
+  relocating = true;
+  if (object) {
+    *object = {};
+    object->sections.push_back({true, 0, {}});
+  }
 }
 
 void Assembler::init(Address addr) {
   initPreserveSymbols(addr);
   symbolTable.clear();
+  relocatableSymbols.clear();
 }
 
 void Assembler::changeMode(Assembler::ProcessingMode mode) {
   this->mode = mode;
 }
 
+void Assembler::setObjectOutput(ObjectModule* module) {
+  object = module;
+  init();
+}
+
 AssemblyResult Assembler::processLine(const QString& str) {
+  if (const auto result = parser.parse(str, line); result != AssemblyResult::Ok) {
+    lastLocationCounter = locationCounter;
+    errorPosition = parser.errorColumn();
+    return result;
+  }
+  return processParsedLine();
+}
+
+AssemblyResult Assembler::processLine(const ParsedLine& parsed) {
+  line = parsed;
+  return processParsedLine();
+}
+
+AssemblyResult Assembler::processParsedLine() {
   lastLocationCounter = locationCounter;
-  for (const auto& entry : Patterns) {
-    match = entry.regex.match(str);
-    if (match.hasMatch()) {
-      try {
-        if (auto label = match.captured(LabelGroup); !label.isEmpty()) defineSymbol(label, locationCounter);
-        (this->*entry.handler)();
-        return AssemblyResult::Ok;
-      } catch (AssemblyResult result) { return result; }
+  try {
+    errorPosition = line.labelColumn;
+    if (!line.label.isEmpty()) defineSymbol(line.label, locationCounter);
+
+    switch (line.kind) {
+    case ParsedLine::NoOperation: break;
+    case ParsedLine::SetLocationCounter: handleSetLocationCounter(); break;
+    case ParsedLine::Align:
+    case ParsedLine::KeepOnPage: handleAlign(); break;
+    case ParsedLine::EmitBytes: handleEmitBytes(); break;
+    case ParsedLine::EmitWords: handleEmitWords(); break;
+    case ParsedLine::Instruction: handleInstruction(); break;
+    case ParsedLine::Include: errorPosition = line.operationColumn; throw AssemblyResult::CommandProcessingError;
+    case ParsedLine::Export: handleExport(); break;
+    case ParsedLine::SamePage: handleSamePage(); break;
     }
-  }
-  return AssemblyResult::SyntaxError;
+    return AssemblyResult::Ok;
+  } catch (AssemblyResult result) { return result; }
 }
 
 AddressRange Assembler::affectedAddressRange() const {
@@ -153,118 +113,205 @@ int Assembler::bytesWritten() const {
   return written;
 }
 
-QString Assembler::operation() const {
-  return match.captured(OperationGroup);
+int Assembler::emittedSize(const ParsedLine& line) const {
+  switch (line.kind) {
+  case ParsedLine::EmitBytes: return static_cast<int>(line.operands.size());
+  case ParsedLine::EmitWords: return static_cast<int>(line.operands.size() * 2);
+  case ParsedLine::Instruction: {
+    const auto opcode = emittedOpcode(line);
+    return opcode < 0 ? 0 : InstructionTable[opcode].size;
+  }
+  default: return 0;
+  }
 }
 
-QString Assembler::operand() const {
-  return match.captured(FirstOperandGroup);
+int Assembler::emittedOpcode(const ParsedLine& line) const {
+  if (line.kind != ParsedLine::Instruction) return -1;
+  const auto zp = !line.operands.empty() && fitsZeroPage(line.operands.front());
+  return OpcodeTable[line.type][adjustAddressingMode(line.type, line.format, zp)];
 }
 
-static QString removeLoHiPrefix(QChar& prefix, const QString& str) {
-  const auto f = str.front();
-  if (f == LoBytePrefix || f == HiBytePrefix) {
-    prefix = f;
-    return str.right(str.length() - 1);
-  }
-  prefix = QChar::Null;
-  return str;
+bool Assembler::sizesSettled() const {
+  return std::all_of(sizeGuesses.begin(), sizeGuesses.end(), [this](const auto& guess) {
+    return fitsZeroPage(guess.first) == guess.second;
+  });
 }
 
-static int applyLoHiPrefix(QChar prefix, int num) {
-  if (prefix.isNull()) return num;
-  if (prefix == HiBytePrefix) return num >> 8;
-  return num & 0xff;
+// a symbol placed by the linker may end up anywhere, so it is never taken for a zero page address
+bool Assembler::fitsZeroPage(const ParsedOperand& op) const {
+  auto value = op.literal;
+  if (!op.isLiteral()) {
+    const auto opt = symbolTable.get(op.symbol);
+    if (!opt || (object && relocatableSymbols.count(op.symbol))) return false;
+    value = *opt;
+  }
+  value = applyByteSelector(op.selector, value);
+  return value >= 0 && value <= 255;
 }
 
-OperandValue Assembler::operandValue(const QString& ostr) const {
-  QChar prefix;
-  const QString str = removeLoHiPrefix(prefix, ostr);
-  if (isNumber(str)) return {OperandValue::Literal, applyLoHiPrefix(prefix, parseNumber(str))};
-  if (const auto& opt = symbolTable.get(str)) return {OperandValue::Identifier, applyLoHiPrefix(prefix, *opt)};
-  if (mode == Assembler::ProcessingMode::EmitCode) throw AssemblyResult::SymbolNotDefined;
+OperandValue Assembler::operandValue(const ParsedOperand& op) {
+  errorPosition = op.column;
+  if (op.isLiteral()) return {OperandValue::Literal, applyByteSelector(op.selector, op.literal)};
+  if (const auto& opt = symbolTable.get(op.symbol)) return {OperandValue::Identifier, applyByteSelector(op.selector, *opt)};
+  if (mode == Assembler::ProcessingMode::EmitCode && !object) throw AssemblyResult::SymbolNotDefined;
   return {OperandValue::UndefinedIdentifier};
 }
 
-OperandValue Assembler::operandValue() const {
-  return operandValue(operand());
-}
-
-int8_t Assembler::operandAsBranchDisplacement() const {
-  const auto op = operandValue();
-  if (mode == Assembler::ProcessingMode::ScanForSymbols) return 0;
-  return safeCast<int8_t>(op.isLiteral() ? op : op - locationCounter - 2);
-}
-void Assembler::handleNoOperation() {
+int8_t Assembler::operandAsBranchDisplacement(const ParsedOperand& op) {
+  const auto value = operandValue(op);
+  if (addRelocation(op, ObjectModule::Relocation::Displacement, static_cast<Address>(locationCounter + 1))) return 0;
+  if (mode == Assembler::ProcessingMode::ScanForSymbols || value.type == OperandValue::UndefinedIdentifier) return 0;
+  return safeCast<int8_t>(value.isLiteral() ? value : value - locationCounter - 2);
 }
 
 void Assembler::handleSetLocationCounter() {
-  locationCounter = safeCast<uint16_t>(operandValue());
-}
+  const auto value = operandValue(line.operands.front());
+  if (object && mode == ProcessingMode::EmitCode) {
+    // a module cannot place code relative to where the linker puts it
+    const auto& op = line.operands.front();
+    if (!op.isLiteral() && (value.type == OperandValue::UndefinedIdentifier || relocatableSymbols.count(op.symbol)))
+      throw AssemblyResult::CommandProcessingError;
+  }
+  locationCounter = safeCast<uint16_t>(value);
+  relocating = false;
+  if (object && mode == ProcessingMode::EmitCode) object->sections.push_back({false, locationCounter, {}});
+}
+
+// .ALIGN moves to the next multiple of its operand, .PAGE to the next page unless that many bytes fit on this one
+void Assembler::handleAlign() {
+  const auto count = line.operands.front().literal;
+  errorPosition = line.operands.front().column;
+  if (count < 1 || (line.kind == ParsedLine::KeepOnPage && count > 0x100)) throw AssemblyResult::ValueOutOfRange;
+  if (object && relocating) {
+    // the linker does not align sections
+    errorPosition = line.operationColumn;
+    throw AssemblyResult::CommandProcessingError;
+  }
 
-void Assembler::handleEmitBytes() {
-  for (const auto& op : split(operand())) emitByte(safeCast<uint8_t>(operandValue(op)));
-}
+  auto target = static_cast<int>(locationCounter);
+  if (line.kind == ParsedLine::Align)
+    target = (target + count - 1) / count * count;
+  else if ((target & 0xff) + count > 0x100)
+    target = (target | 0xff) + 1;
+  if (target == locationCounter) return;
 
-void Assembler::handleEmitWords() {
-  for (const auto& op : split(operand())) emitWord(safeCast<uint16_t>(operandValue(op)));
+  locationCounter = safeCast<uint16_t>(target);
+  if (object && mode == ProcessingMode::EmitCode) object->sections.push_back({false, locationCounter, {}});
 }
 
-void Assembler::handleImpliedOrAccumulator() {
-  assemble(OperandsFormat::ImpliedOrAccumulator);
-}
+// the code from the label up to here must not cross a page, as a branch or an indexed read across one costs a cycle
+void Assembler::handleSamePage() {
+  if (mode == ProcessingMode::ScanForSymbols) return;
 
-void Assembler::handleImmediate() {
-  assemble(OperandsFormat::Immediate, operandValue());
-}
+  const auto& op = line.operands.front();
+  const auto value = operandValue(op);
+  if (value.type == OperandValue::UndefinedIdentifier) throw AssemblyResult::SymbolNotDefined;
+  if (object && (relocating || relocatableSymbols.count(op.symbol))) throw AssemblyResult::CommandProcessingError;
 
-void Assembler::handleAbsolute() {
-  assemble(OperandsFormat::Absolute, operandValue());
+  const auto first = std::min<int>(value, locationCounter);
+  const auto last = std::max<int>(value, locationCounter) - 1;
+  if (first <= last && (first ^ last) & 0xff00) throw AssemblyResult::PageCrossed;
 }
 
-void Assembler::handleAbsoluteIndexedX() {
-  assemble(OperandsFormat::AbsoluteX, operandValue());
+void Assembler::handleEmitBytes() {
+  for (const auto& op : line.operands) {
+    const auto value = operandValue(op);
+    emitByte(addRelocation(op, ObjectModule::Relocation::DataByte, locationCounter) ? 0 : safeCast<uint8_t>(value));
+  }
 }
 
-void Assembler::handleAbsoluteIndexedY() {
-  assemble(OperandsFormat::AbsoluteY, operandValue());
+void Assembler::handleEmitWords() {
+  for (const auto& op : line.operands) {
+    const auto value = operandValue(op);
+    emitWord(addRelocation(op, ObjectModule::Relocation::Word, locationCounter) ? 0 : safeCast<uint16_t>(value));
+  }
 }
 
-void Assembler::handleIndirect() {
-  assemble(OperandsFormat::Indirect, operandValue());
+void Assembler::handleInstruction() {
+  if (line.format == ImpliedOrAccumulator) {
+    assemble(line.type, line.format);
+  } else if (line.format == Branch) {
+    assemble(line.type, line.format, {OperandValue::Literal, operandAsBranchDisplacement(line.operands.front())});
+  } else {
+    assemble(line.type, line.format, operandValue(line.operands.front()));
+  }
 }
 
-void Assembler::handleIndexedIndirectX() {
-  assemble(OperandsFormat::IndexedIndirectX, operandValue());
-}
+void Assembler::assemble(InstructionType type, OperandsFormat mode, OperandValue operand) {
+  const auto operandColumn = errorPosition;
+  errorPosition = line.operationColumn;
+  auto zp = false;
+  if (!line.operands.empty() && mode != OperandsFormat::Branch) {
+    const auto& op = line.operands.front();
+    zp = fitsZeroPage(op);
+    // a forward reference is sized by the value of the previous pass
+    if (this->mode == ProcessingMode::ScanForSymbols && !op.isLiteral() && !definedInPass.contains(op.symbol) &&
+        hasZeroPageForm(type, mode))
+      sizeGuesses.emplace_back(op, zp);
+  }
+  const auto opcode = resolveOpcode(type, mode, zp);
+  errorPosition = operandColumn;
+  const auto size = InstructionTable[opcode].size;
+  if (size > 1 && mode != OperandsFormat::Branch) {
+    addRelocation(line.operands.front(), size == 2 ? ObjectModule::Relocation::OperandByte : ObjectModule::Relocation::Word,
+                  static_cast<Address>(locationCounter + 1));
+  }
 
-void Assembler::handleIndirectIndexedY() {
-  assemble(OperandsFormat::IndirectIndexedY, operandValue());
+  emitByte(opcode);
+  if (size == 2)
+    emitByte(static_cast<uint8_t>(operand));
+  else if (size == 3)
+    emitWord(static_cast<uint16_t>(operand));
 }
 
-void Assembler::handleBranch() {
-  assemble(OperandsFormat::Branch, {OperandValue::Literal, operandAsBranchDisplacement()});
-}
+void Assembler::handleExport() {
+  if (!object || mode != ProcessingMode::EmitCode) return;
 
-void Assembler::assemble(OperandsFormat mode, OperandValue operand) {
-  const auto instruction = resolveInstruction(operation(), mode, operand.isLiteral() && operand >= 0 && operand <= 255);
-  emitByte(static_cast<uint8_t>(std::distance(InstructionTable.begin(), instruction)));
-  if (instruction->size == 2)
-    emitByte(static_cast<uint8_t>(operand));
-  else if (instruction->size == 3)
-    emitWord(static_cast<uint16_t>(operand));
+  for (const auto& op : line.operands) {
+    errorPosition = op.column;
+    const auto value = symbolTable.get(op.symbol);
+    if (!value) throw AssemblyResult::SymbolNotDefined;
+    object->exports.push_back({op.symbol, relocatableSymbols.count(op.symbol) > 0, static_cast<Address>(*value)});
+  }
 }
 
 void Assembler::defineSymbol(const QString& name, uint16_t value) {
-  if (mode == ProcessingMode::ScanForSymbols) {
-    if (!symbolTable.put(name, value)) throw AssemblyResult::SymbolAlreadyDefined;
+  if (mode == ProcessingMode::EmitCode) {
+    if (object) object->labels.push_back({name, relocating, value});
+    return;
   }
+
+  // the value of the previous pass gets replaced
+  if (definedInPass.contains(name)) throw AssemblyResult::SymbolAlreadyDefined;
+  definedInPass.insert(name);
+  symbolTable.set(name, value);
+  if (object && relocating) relocatableSymbols.insert(name);
+}
+
+// the value of an imported symbol, or of a relocatable one, is known only to the linker; the byte emitted for it is 0
+bool Assembler::addRelocation(const ParsedOperand& op, ObjectModule::Relocation::Kind kind, Address at) {
+  if (!object || mode != ProcessingMode::EmitCode || op.isLiteral()) return false;
+
+  const auto imported = !symbolTable.contains(op.symbol);
+  const auto relocatable = relocatableSymbols.count(op.symbol) > 0;
+  // a branch within the same kind of section does not depend on where the linker puts the module
+  if (!imported && (kind == ObjectModule::Relocation::Displacement ? relocatable == relocating : !relocatable)) return false;
+
+  const auto section = static_cast<int>(object->sections.size() - 1);
+  const auto offset = static_cast<Address>(relocating ? at : at - object->sections.back().origin);
+  const auto addend = imported ? Address(0) : symbolTable.at(op.symbol);
+  object->relocations.push_back(
+      {kind, op.selector, section, offset, imported ? op.symbol : QString(), relocatable, addend});
+  return true;
 }
 
 void Assembler::emitByte(uint8_t b) {
   if (mode == ProcessingMode::EmitCode) {
     updateAddressRange(locationCounter);
-    memory[locationCounter] = b;
+    if (object)
+      object->sections.back().bytes.push_back(b);
+    else
+      memory[locationCounter] = b;
     written++;
   }
   locationCounter++;
@@ -4,23 +4,37 @@
 #include "assemblyresult.h"
 #include "commondefs.h"
 #include "instruction.h"
+#include "lineparser.h"
 #include "memory.h"
+#include "objectmodule.h"
 #include "operandvalue.h"
 #include "symboltable.h"
-#include <QRegularExpression>
+#include <QSet>
 #include <QString>
 #include <iterator>
 #include <map>
 #include <optional>
+#include <set>
 #include <vector>
 
 class Assembler
 {
 public:
+  // ScanForSymbols is repeated until sizesSettled, then EmitCode follows
   enum class ProcessingMode { ScanForSymbols, EmitCode };
 
+  struct DeferredError {
+    AssemblyResult result;
+    int line; // counted from 0
+    int column;
+    QString symbol;
+  };
+
   static constexpr uint16_t DefaultOrigin = 0;
 
+  // to be changed whenever the same source could assemble differently, as it invalidates cached builds
+  static constexpr int Version = 3;
+
   const auto& symbols() const { return symbolTable; }
 
   Assembler(Memory&);
@@ -28,52 +42,64 @@ public:
   void initPreserveSymbols(Address = DefaultOrigin);
   void changeMode(ProcessingMode mode);
   AssemblyResult processLine(const QString&);
+  AssemblyResult processLine(const ParsedLine&);
   AddressRange affectedAddressRange() const;
   int bytesWritten() const;
 
+  // code goes to the module instead of the memory: labels before the first .ORG are relocatable, symbols that are
+  // not defined are imported and .EXPORT lists the symbols other modules may use; nullptr to write the memory again
+  void setObjectOutput(ObjectModule*);
+
+  // column of the last error, counted from 0
+  int errorColumn() const { return errorPosition; }
+
+  // as processLine would emit it with the symbols defined now; 0 for an invalid format
+  int emittedSize(const ParsedLine&) const;
+
+  // of an instruction as processLine would emit it, -1 for an invalid format or a line that is no instruction
+  int emittedOpcode(const ParsedLine&) const;
+
+  // after a ScanForSymbols pass: false if a forward reference was sized by a value that did not hold, in which case
+  // the source has to be scanned again, as an instruction only shrinks when its symbol turns out to fit zero page
+  bool sizesSettled() const;
+
 private:
   friend class AssemblerTest;
   friend class InstructionsTest;
-
-  struct PatternEntry {
-    using Handler = void (Assembler::*)();
-    const QRegularExpression regex;
-    const Handler handler;
-
-    PatternEntry(const QString& pattern, const Handler handler);
-  };
-  static const PatternEntry Patterns[];
+  friend class IncrementalAssembler;
+  friend class PeepholeOptimizer;
 
   Memory& memory;
   AddressRange addressRange;
   ProcessingMode mode;
   int written;
-  QRegularExpressionMatch match;
+  LineParser parser;
+  ParsedLine line;
+  int errorPosition = 0;
   uint16_t locationCounter;
   uint16_t lastLocationCounter;
   SymbolTable symbolTable;
+  ObjectModule* object = nullptr;
+  bool relocating;
+  std::set<QString> relocatableSymbols;
+  QSet<QString> definedInPass;
+  std::vector<std::pair<ParsedOperand, bool>> sizeGuesses;
 
-  QString operation() const;
-  QString operand() const;
-  OperandValue operandValue(const QString&) const;
-  OperandValue operandValue() const;
-  int8_t operandAsBranchDisplacement() const;
+  AssemblyResult processParsedLine();
+  OperandValue operandValue(const ParsedOperand&);
+  int8_t operandAsBranchDisplacement(const ParsedOperand&);
+  bool fitsZeroPage(const ParsedOperand&) const;
 
-  void handleNoOperation();
   void handleSetLocationCounter();
+  void handleAlign();
+  void handleSamePage();
   void handleEmitBytes();
   void handleEmitWords();
-  void handleImpliedOrAccumulator();
-  void handleImmediate();
-  void handleAbsolute();
-  void handleAbsoluteIndexedX();
-  void handleAbsoluteIndexedY();
-  void handleIndirect();
-  void handleIndexedIndirectX();
-  void handleIndirectIndexedY();
-  void handleBranch();
-  void assemble(OperandsFormat mode, OperandValue = OperandValue());
+  void handleInstruction();
+  void handleExport();
+  void assemble(InstructionType, OperandsFormat mode, OperandValue = OperandValue());
   void defineSymbol(const QString&, uint16_t);
+  bool addRelocation(const ParsedOperand&, ObjectModule::Relocation::Kind, Address at);
   void emitByte(uint8_t);
   void emitWord(uint16_t);
   void updateAddressRange(uint16_t);
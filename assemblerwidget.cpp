@@ -1,5 +1,4 @@
 #include "assemblerwidget.h"
-#include "assembler.h"
 #include "commonformatters.h"
 #include "ui_assemblerwidget.h"
 #include "uitools.h"
@@ -10,23 +9,50 @@
 #include <QTextBlock>
 #include <QTextStream>
 
-AssemblerWidget::AssemblerWidget(QWidget* parent, Memory& memory)
-    : QWidget(parent), ui(new Ui::AssemblerWidget), assembler(memory) {
+AssemblerWidget::AssemblerWidget(QWidget* parent) : QWidget(parent), ui(new Ui::AssemblerWidget) {
   ui->setupUi(this);
+
+  worker = new AssemblyWorker();
+  worker->moveToThread(&assemblyThread);
+  connect(&assemblyThread, &QThread::finished, worker, &AssemblyWorker::deleteLater);
+  connect(this, &AssemblerWidget::linesChanged, worker, &AssemblyWorker::replaceLines);
+  connect(this, &AssemblerWidget::assemblyRequested, worker, &AssemblyWorker::assemble);
+  connect(this, &AssemblerWidget::listingRequested, worker, &AssemblyWorker::saveListing);
+  connect(worker, &AssemblyWorker::assembled, this, &AssemblerWidget::showReport);
+  connect(worker, &AssemblyWorker::operationCompleted, this, &AssemblerWidget::operationCompleted);
+  assemblyThread.start();
+
   connect(ui->newFile, &QAbstractButton::clicked, this, &AssemblerWidget::newFile);
   connect(ui->loadFile, &QAbstractButton::clicked, this, &AssemblerWidget::loadEditorFile);
   connect(ui->saveFile, &QAbstractButton::clicked, this, &AssemblerWidget::saveEditorFile);
   connect(ui->saveFileAs, &QAbstractButton::clicked, this, &AssemblerWidget::saveEditorFileAs);
+  connect(ui->exportListing, &QAbstractButton::clicked, this, &AssemblerWidget::exportListing);
   connect(ui->assembleSourceCode, &QAbstractButton::clicked, this, &AssemblerWidget::assembleSourceCode);
-  connect(ui->goToOrigin, &QAbstractButton::clicked, [&] { emit programCounterChanged(assembler.affectedAddressRange().first); });
+  connect(ui->goToOrigin, &QAbstractButton::clicked, [&] { emit programCounterChanged(codeRange.first); });
+  connect(ui->liveAssembly, &QAbstractButton::toggled, [&](bool checked) {
+    if (checked) assembleLive();
+  });
+  connect(ui->patchWhileRunning, &QAbstractButton::toggled, this, &AssemblerWidget::patchWhileRunningChanged);
+
+  const auto document = ui->sourceCode->document();
+  connect(document, &QTextDocument::contentsChange, this,
+          [this](int position, int, int charsAdded) { updateSourceLines(position, charsAdded); });
+  updateSourceLines(0, document->characterCount());
 
   setMonospaceFont(ui->sourceCode);
 }
 
 AssemblerWidget::~AssemblerWidget() {
+  assemblyThread.quit();
+  assemblyThread.wait();
   delete ui;
 }
 
+void AssemblerWidget::updateState(EmulatorState state) {
+  programCounter = state.regs.pc;
+  highlightExecutedLine();
+}
+
 void AssemblerWidget::loadFile(const QString& fname) {
   QFile file(fname);
   if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
@@ -68,25 +94,60 @@ void AssemblerWidget::saveEditorFileAs() {
     saveFile(fname);
 }
 
-std::optional<QString> AssemblerWidget::process() {
-  QString src = ui->sourceCode->toPlainText();
-  QTextStream is(&src, QIODevice::ReadOnly);
-  int lineNum = 0;
-  while (!is.atEnd()) {
-    const auto line = is.readLine();
-    if (line.isNull()) break;
-    if (auto result = assembler.processLine(line); result != AssemblyResult::Ok) {
-      auto block = ui->sourceCode->document()->findBlockByLineNumber(lineNum);
-      auto cursor = ui->sourceCode->textCursor();
-      cursor.setPosition(block.position() + block.length() - 1, QTextCursor::MoveAnchor);
-      cursor.setPosition(block.position(), QTextCursor::KeepAnchor);
-      ui->sourceCode->setTextCursor(cursor);
-      ui->sourceCode->setFocus();
-      return tr("%1 at line %2").arg(formatAssemblyResult(result)).arg(lineNum + 1);
-    }
-    lineNum++;
+void AssemblerWidget::exportListing() {
+  const auto fname = QFileDialog::getSaveFileName(this, tr("Save Listing"), QFileInfo(fileName).absolutePath());
+  if (!fname.isEmpty()) emit listingRequested(fname);
+}
+
+// mirrors the blocks touched by a document change in the assembler, the removed count follows from the block counts
+void AssemblerWidget::updateSourceLines(int position, int charsAdded) {
+  const auto document = ui->sourceCode->document();
+  const auto first = document->findBlock(position);
+  const auto last = document->findBlock(std::min(position + charsAdded, document->characterCount() - 1));
+
+  QStringList lines;
+  for (auto block = first; block.isValid() && block.blockNumber() <= last.blockNumber(); block = block.next()) {
+    lines.append(block.text());
   }
-  return std::nullopt;
+  const auto removed = lines.size() - (document->blockCount() - lineCount);
+  lineCount = document->blockCount();
+  emit linesChanged(first.blockNumber(), removed, lines);
+
+  if (ui->liveAssembly->isChecked()) assembleLive();
+}
+
+void AssemblerWidget::selectError(int lineNum, int column) {
+  auto block = ui->sourceCode->document()->findBlockByLineNumber(lineNum);
+  // the source may have changed while it was assembled
+  if (!block.isValid()) return;
+
+  auto cursor = ui->sourceCode->textCursor();
+  cursor.setPosition(block.position() + block.length() - 1, QTextCursor::MoveAnchor);
+  cursor.setPosition(block.position() + column, QTextCursor::KeepAnchor);
+  ui->sourceCode->setTextCursor(cursor);
+  ui->sourceCode->setFocus();
+}
+
+void AssemblerWidget::highlightExecutedLine() {
+  ui->sourceCode->setExecutedLine(programCounter && sourceMap ? sourceMap->at(*programCounter).line : -1);
+}
+
+QString AssemblerWidget::formatErrors(const std::vector<Assembler::DeferredError>& errors) {
+  QStringList items;
+  for (const auto& error : errors) {
+    const auto what = error.symbol.isEmpty() ? formatAssemblyResult(error.result)
+                                             : tr("%1 %2").arg(formatAssemblyResult(error.result), error.symbol);
+    items.append(tr("%1 at line %2, column %3").arg(what).arg(error.line + 1).arg(error.column + 1));
+  }
+  return items.join(", ");
+}
+
+QString AssemblerWidget::formatWarnings(const std::vector<Listing::Warning>& warnings) {
+  QStringList items;
+  for (const auto& warning : warnings) {
+    items.append(tr("%1 at line %2").arg(Listing::formatWarning(warning)).arg(warning.line + 1));
+  }
+  return items.isEmpty() ? QString() : tr(", warnings: %1").arg(items.join(", "));
 }
 
 void AssemblerWidget::newFile() {
@@ -96,25 +157,36 @@ void AssemblerWidget::newFile() {
 }
 
 void AssemblerWidget::assembleSourceCode() {
-  assembler.init();
-  assembler.changeMode(Assembler::ProcessingMode::ScanForSymbols);
-  if (auto ph0 = process()) {
-    emit operationCompleted(*ph0, false);
-    return;
-  }
+  emit assemblyRequested(true);
+}
 
-  assembler.initPreserveSymbols();
-  assembler.changeMode(Assembler::ProcessingMode::EmitCode);
-  if (auto ph1 = process()) {
-    emit operationCompleted(*ph1, false);
+void AssemblerWidget::assembleLive() {
+  emit assemblyRequested(false);
+}
+
+// while typing, errors are only reported and the cursor is left alone
+void AssemblerWidget::showReport(const AssemblyReport& report) {
+  codeRange = report.codeRange;
+  sourceMap = report.sourceMap;
+  ui->sourceCode->setAnnotations(report.annotations, report.longestAnnotation);
+  highlightExecutedLine();
+  if (!report.patch.empty()) emit codeAssembled(report.patch);
+
+  if (!report.errors.empty()) {
+    if (report.rewrite) selectError(report.errors.front().line, report.errors.front().column);
+    emit operationCompleted(formatErrors(report.errors), false);
     return;
   }
 
-  emit codeWritten(assembler.affectedAddressRange());
-  emit programCounterChanged(assembler.affectedAddressRange().first);
-  emit operationCompleted(tr("%1 B written in range $%2-$%3, symbols: %4")
-                              .arg(assembler.bytesWritten())
-                              .arg(formatHexWord(assembler.affectedAddressRange().first))
-                              .arg(formatHexWord(assembler.affectedAddressRange().last))
-                              .arg(assembler.symbols().size()));
+  if (report.rewrite) {
+    emit programCounterChanged(codeRange.first);
+    emit operationCompleted(tr("%1 B written in range $%2-$%3, symbols: %4")
+                                .arg(report.patch.size())
+                                .arg(formatHexWord(codeRange.first))
+                                .arg(formatHexWord(codeRange.last))
+                                .arg(report.symbols) +
+                            formatWarnings(report.warnings));
+  } else if (!report.patch.empty()) {
+    emit operationCompleted(tr("%1 B written").arg(report.patch.size()));
+  }
 }
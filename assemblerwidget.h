@@ -1,7 +1,11 @@
 #pragma once
 
-#include "assembler.h"
+#include "assemblyworker.h"
+#include "emulatorstate.h"
+#include <QThread>
 #include <QWidget>
+#include <memory>
+#include <optional>
 
 namespace Ui {
 class AssemblerWidget;
@@ -11,16 +15,23 @@ class AssemblerWidget : public QWidget {
   Q_OBJECT
 
 public:
-  explicit AssemblerWidget(QWidget* parent, Memory& memory);
+  explicit AssemblerWidget(QWidget* parent);
   ~AssemblerWidget();
 
+  // highlights the line of the program counter
+  void updateState(EmulatorState);
+
 signals:
   void newFileCreated();
   void fileLoaded(const QString&);
   void fileSaved(const QString&);
-  void codeWritten(AddressRange);
+  void codeAssembled(const MemoryPatch&);
+  void patchWhileRunningChanged(bool);
   void operationCompleted(const QString& message, bool success = true);
   void programCounterChanged(uint16_t);
+  void linesChanged(int first, int removed, const QStringList& added);
+  void assemblyRequested(bool rewrite);
+  void listingRequested(const QString& fname);
 
 public slots:
   void loadFile(const QString& fname);
@@ -29,14 +40,26 @@ public slots:
 private:
   Ui::AssemblerWidget* ui;
   QString fileName;
-  Assembler assembler;
+  QThread assemblyThread;
+  AssemblyWorker* worker;
+  int lineCount = 0;
+  AddressRange codeRange;
+  std::shared_ptr<const SourceMap> sourceMap; // of the last report
+  std::optional<Address> programCounter;
 
-  std::optional<QString> process();
+  void updateSourceLines(int position, int charsAdded);
+  void selectError(int lineNum, int column);
+  void highlightExecutedLine();
+  QString formatErrors(const std::vector<Assembler::DeferredError>&);
+  QString formatWarnings(const std::vector<Listing::Warning>&);
 
 private slots:
   void newFile();
   void loadEditorFile();
   void saveEditorFile();
   void saveEditorFileAs();
+  void exportListing();
   void assembleSourceCode();
+  void assembleLive();
+  void showReport(const AssemblyReport&);
 };
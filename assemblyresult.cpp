@@ -12,6 +12,12 @@ const char* formatAssemblyResult(AssemblyResult ar) {
   case AssemblyResult::ValueOutOfRange: return "value out of range";
   case AssemblyResult::InvalidMnemonic: return "invalid mnemonic";
   case AssemblyResult::InvalidInstructionFormat: return "invalid instruction format";
+  case AssemblyResult::IncludeNotFound: return "include file not found";
+  case AssemblyResult::IncludeTooDeep: return "includes nested too deeply";
+  case AssemblyResult::SectionsOverlap: return "sections overlap";
+  case AssemblyResult::SizesNotSettled: return "instruction sizes do not settle";
+  case AssemblyResult::PageCrossed: return "code crosses a page";
+  case AssemblyResult::FileNotFound: return "file not found";
   }
   return nullptr;
 }
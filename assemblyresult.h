@@ -10,7 +10,13 @@ enum class AssemblyResult {
   CommandProcessingError,
   ValueOutOfRange,
   InvalidMnemonic,
-  InvalidInstructionFormat
+  InvalidInstructionFormat,
+  IncludeNotFound,
+  IncludeTooDeep,
+  SectionsOverlap,
+  SizesNotSettled,
+  PageCrossed,
+  FileNotFound
 };
 
 const char* formatAssemblyResult(AssemblyResult);
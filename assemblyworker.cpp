@@ -0,0 +1,74 @@
+#include "assemblyworker.h"
+#include <QFile>
+#include <QTextStream>
+#include <algorithm>
+
+AssemblyWorker::AssemblyWorker(QObject* parent) : QObject(parent), assembler(staging.image()) {
+}
+
+// the added lines are annotated by the next update
+void AssemblyWorker::replaceLines(int first, int removed, const QStringList& added) {
+  assembler.replaceLines(first, removed, {added.begin(), added.end()});
+
+  const auto count = static_cast<int>(annotations.size());
+  first = std::clamp(first, 0, count);
+  removed = std::clamp(removed, 0, count - first);
+  for (auto i = first; i < first + removed; i++) countAnnotation(annotations[i], -1);
+
+  QStringList spliced;
+  spliced.reserve(count - removed + static_cast<int>(added.size()));
+  spliced.append(annotations.mid(0, first));
+  for (auto i = 0; i < static_cast<int>(added.size()); i++) spliced.append(QString());
+  spliced.append(annotations.mid(first + removed));
+  annotations = spliced;
+}
+
+void AssemblyWorker::assemble(bool rewrite) {
+  if (rewrite) assembler.invalidateMemory();
+  assembler.update();
+  for (const auto range : assembler.writtenRanges()) staging.markWritten(range);
+
+  const auto& listing = assembler.listing();
+  for (const auto line : assembler.changedAnnotations()) setAnnotation(line, listing.annotation(line));
+
+  AssemblyReport report;
+  report.errors = assembler.errors();
+  if (report.errors.empty()) report.patch = staging.takePatch();
+  report.codeRange = assembler.codeRange();
+  report.symbols = assembler.symbols().size();
+  report.rewrite = rewrite;
+  if (rewrite) report.warnings = listing.warnings();
+  report.annotations = annotations;
+  report.longestAnnotation = annotationLengths.empty() ? 0 : annotationLengths.rbegin()->first;
+  report.sourceMap = assembler.sourceMap();
+  emit assembled(report);
+}
+
+void AssemblyWorker::saveListing(const QString& fileName) {
+  const auto& listing = assembler.listing();
+  QFile file(fileName);
+  if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+    QTextStream(&file) << listing.toText();
+    emit operationCompleted(tr("listing of %1 lines saved").arg(static_cast<int>(listing.lines().size())));
+  } else {
+    emit operationCompleted(tr("cannot write %1").arg(fileName), false);
+  }
+}
+
+// detaches the list from the last report only once per update
+void AssemblyWorker::setAnnotation(int line, const QString& text) {
+  auto& annotation = annotations[line];
+  if (annotation == text) return;
+
+  countAnnotation(annotation, -1);
+  countAnnotation(text, 1);
+  annotation = text;
+}
+
+void AssemblyWorker::countAnnotation(const QString& text, int delta) {
+  if (text.isEmpty()) return;
+
+  const auto it = annotationLengths.insert({text.size(), 0}).first;
+  it->second += delta;
+  if (!it->second) annotationLengths.erase(it);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "incrementalassembler.h"
+#include "memorypatch.h"
+#include <QObject>
+#include <QStringList>
+#include <map>
+#include <memory>
+
+struct AssemblyReport {
+  MemoryPatch patch; // empty while there are errors, the bytes are kept for the first update without them
+  std::vector<Assembler::DeferredError> errors;
+  AddressRange codeRange;
+  size_t symbols = 0;
+  bool rewrite = false; // all code was written again
+  std::vector<Listing::Warning> warnings; // of the listing, only for a rewrite
+  QStringList annotations; // of the listing, one per source line, shared with the worker until either changes
+  int longestAnnotation = 0; // in characters
+  std::shared_ptr<const SourceMap> sourceMap;
+};
+
+// Assembles on its own thread into a staging image, so neither the editor nor the emulator memory
+// ever sees a partial result
+class AssemblyWorker : public QObject {
+  Q_OBJECT
+
+public:
+  explicit AssemblyWorker(QObject* parent = nullptr);
+
+signals:
+  void assembled(const AssemblyReport&);
+  void operationCompleted(const QString& message, bool success = true);
+
+public slots:
+  void replaceLines(int first, int removed, const QStringList& added);
+  void assemble(bool rewrite);
+  // the listing as last assembled
+  void saveListing(const QString& fileName);
+
+private:
+  StagingArea staging;
+  IncrementalAssembler assembler;
+  QStringList annotations;
+  std::map<int, int> annotationLengths; // number of non-empty annotations of each length
+
+  void setAnnotation(int line, const QString&);
+  void countAnnotation(const QString&, int delta);
+};
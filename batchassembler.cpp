@@ -0,0 +1,149 @@
+#include "batchassembler.h"
+#include "commonformatters.h"
+#include "listing.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QtConcurrentMap>
+#include <algorithm>
+#include <map>
+#include <memory>
+
+// without the empty line after the final newline
+static QStringList splitLines(const QString& contents) {
+  auto lines = contents.split('\n');
+  if (lines.size() > 1 && lines.back().isEmpty()) lines.pop_back();
+  return lines;
+}
+
+BatchAssembler::BatchAssembler(Options options) : options(std::move(options)) {
+  if (!this->options.cacheDirectory.isEmpty()) cache = std::make_unique<BuildCache>(this->options.cacheDirectory);
+}
+
+bool BatchAssembler::assemble(const QStringList& fileNames) {
+  resultList.clear();
+  if (!options.project.isEmpty()) {
+    resultList.push_back({});
+    resultList.back().fileName = options.project;
+    build(projectBuilder, fileNames, resultList.back());
+    return resultList.back().ok();
+  }
+
+  for (const auto& fileName : fileNames) {
+    resultList.push_back({});
+    resultList.back().fileName = fileName;
+  }
+
+  findCollisions();
+  QtConcurrent::blockingMap(resultList, [this](Result& result) {
+    if (!result.collidesWith.isEmpty()) return;
+    ProjectBuilder builder;
+    build(builder, {result.fileName}, result);
+  });
+  return std::all_of(resultList.begin(), resultList.end(), [](const auto& result) { return result.ok(); });
+}
+
+// with an output directory, sources of the same name in different directories would write the same outputs
+// from two threads at once
+void BatchAssembler::findCollisions() {
+  std::map<QString, QString> sourceOfOutput;
+  for (auto& result : resultList) {
+    const auto output = QDir::cleanPath(QFileInfo(outputFileName(result.fileName, "bin")).absoluteFilePath());
+    const auto [it, first] = sourceOfOutput.insert({output, result.fileName});
+    if (!first) result.collidesWith = it->second;
+  }
+}
+
+// a file built on its own has a ProjectBuilder per job, which needs no locking; cache entries are keyed by
+// project and written in one go, so builds of different files share the cache safely
+void BatchAssembler::build(ProjectBuilder& builder, const QStringList& fileNames, Result& result) const {
+  builder.setCache(cache.get());
+  builder.setOptimize(options.optimize);
+  const auto built = builder.build(fileNames, options.origin);
+  result.errors = builder.errors();
+  result.rewrites = builder.rewrites();
+  result.assembled = builder.assembledCount();
+  if (!built) return;
+
+  // read again, as a build from the cache assembled nothing
+  const auto& output = builder.output();
+  std::vector<ModuleAssembler::SourceFile> sources;
+  result.files = output.files;
+  for (const auto& fileName : output.files) {
+    sources.push_back({fileName, {}});
+    ModuleAssembler::readSource(fileName, sources.back().contents);
+    result.lines += static_cast<int>(splitLines(sources.back().contents).size());
+  }
+
+  result.bytes = static_cast<int>(output.image.size());
+  write(result, "bin", binary(output.image));
+  if (options.listings) write(result, "lst", listing(sources, output).toUtf8());
+  if (options.symbols) write(result, "sym", symbolFile(output).toUtf8());
+}
+
+void BatchAssembler::write(Result& result, const QString& suffix, const QByteArray& contents) const {
+  const auto fileName = outputFileName(result.fileName, suffix);
+  QFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly) || file.write(contents) != contents.size()) result.unwritten.append(fileName);
+}
+
+QString BatchAssembler::outputFileName(const QString& fileName, const QString& suffix) const {
+  const QFileInfo source(fileName);
+  const auto directory = options.outputDirectory.isEmpty() ? source.dir() : QDir(options.outputDirectory);
+  return directory.filePath(source.completeBaseName() + "." + suffix);
+}
+
+QByteArray BatchAssembler::binary(const MemoryPatch& image) {
+  if (image.empty()) return {};
+
+  const auto range = image.range();
+  QByteArray bytes(static_cast<int>(range.size()), '\0');
+  for (const auto& chunk : image.chunks) {
+    std::copy(chunk.bytes.begin(), chunk.bytes.end(), bytes.data() + (chunk.first - range.first));
+  }
+  return bytes;
+}
+
+QString BatchAssembler::listing(const std::vector<ModuleAssembler::SourceFile>& sources, const BuildOutput& output) {
+  auto memory = std::make_unique<Memory>();
+  output.image.applyTo(*memory);
+
+  std::map<std::pair<int, int>, const SourceLine*> code; // by file and line number
+  for (const auto& line : output.lines) code.insert({{line.file, line.number}, &line});
+  std::map<QString, Address> labels;
+  for (const auto& label : output.labels) labels.insert({label.name, label.value});
+
+  QString text;
+  LineParser parser;
+  for (auto file = 0; file < static_cast<int>(sources.size()); file++) {
+    const auto lines = splitLines(sources[static_cast<size_t>(file)].contents);
+    std::vector<Listing::Source> listed;
+    listed.reserve(static_cast<size_t>(lines.size()));
+    for (auto number = 0; number < static_cast<int>(lines.size()); number++) {
+      ParsedLine parsed;
+      parser.parse(lines[number], parsed);
+      Listing::Source source{lines[number], parsed.label, 0, {}, parsed.kind == ParsedLine::Instruction};
+      if (const auto it = code.find({file, number}); it != code.end()) {
+        const auto first = memory->cbegin() + it->second->address;
+        source.address = it->second->address;
+        source.bytes.assign(first, first + it->second->size);
+      } else if (const auto label = labels.find(parsed.label); label != labels.end()) {
+        source.address = label->second;
+      }
+      listed.push_back(std::move(source));
+    }
+
+    if (sources.size() > 1) text += QString("%1; %2\n").arg(file ? "\n" : "", sources[static_cast<size_t>(file)].fileName);
+    text += Listing(std::move(listed)).toText();
+  }
+  return text;
+}
+
+QString BatchAssembler::symbolFile(const BuildOutput& output) {
+  auto labels = output.labels;
+  std::stable_sort(labels.begin(), labels.end(), [](const auto& a, const auto& b) { return a.value < b.value; });
+
+  QString text;
+  for (const auto& label : labels) text += QString("%1 = $%2\n").arg(label.name, formatHexWord(label.value).toUpper());
+  return text;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "buildcache.h"
+#include "commondefs.h"
+#include "linker.h"
+#include "moduleassembler.h"
+#include "projectbuilder.h"
+#include <QString>
+#include <QStringList>
+#include <memory>
+#include <vector>
+
+// Builds source files independently of each other on the global thread pool, each as a project of its own, or
+// links them all into one project, into a raw binary, a listing and a symbol file, for building without the GUI
+class BatchAssembler {
+public:
+  struct Options {
+    Address origin = 0;
+    QString outputDirectory; // empty for the directory of each source
+    bool listings = true;
+    bool symbols = true;
+    bool optimize = false;
+    QString cacheDirectory; // of a BuildCache, empty for none
+    QString project;        // name of the outputs of linking all files into one image, empty for one per file
+  };
+
+  struct Result {
+    QString fileName;  // the project when linking all files
+    QStringList files; // of the build, including the included ones
+    std::vector<ModuleAssembler::Error> errors; // line -1 for the errors of linking
+    std::vector<ModuleAssembler::Rewrite> rewrites;
+    QStringList unwritten; // outputs that could not be written
+    QString collidesWith;  // an earlier file with the same output names, this one is not built
+    int lines = 0;         // of the file and its includes, if it was built
+    int bytes = 0;         // of code
+    int assembled = 0;     // modules assembled, the others were up to date or the build came from the cache
+
+    bool ok() const { return errors.empty() && unwritten.empty() && collidesWith.isEmpty(); }
+  };
+
+  explicit BatchAssembler(Options);
+
+  // returns false if any file failed; the results are in the order of the files, or a single one for a project,
+  // which keeps its modules, so building it again assembles only the ones that changed
+  bool assemble(const QStringList& fileNames);
+
+  const std::vector<Result>& results() const { return resultList; }
+
+  // the source with its suffix replaced, e.g. "bin", "lst" or "sym"
+  QString outputFileName(const QString& fileName, const QString& suffix) const;
+
+  // from the first to the last byte of the image, gaps filled with zeros
+  static QByteArray binary(const MemoryPatch&);
+
+  // of every file of a build, each headed by its name when there are includes
+  static QString listing(const std::vector<ModuleAssembler::SourceFile>&, const BuildOutput&);
+
+  // every label as "name = $hhhh", by address
+  static QString symbolFile(const BuildOutput&);
+
+private:
+  Options options;
+  std::unique_ptr<BuildCache> cache;
+  std::vector<Result> resultList;
+  ProjectBuilder projectBuilder;
+
+  void findCollisions();
+
+  void build(ProjectBuilder&, const QStringList& fileNames, Result&) const;
+  void write(Result&, const QString& suffix, const QByteArray&) const;
+};
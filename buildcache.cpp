@@ -0,0 +1,147 @@
+#include "buildcache.h"
+#include "assembler.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+
+static void writeList(QDataStream& out, const QStringList& list) {
+  out << static_cast<quint32>(list.size());
+  for (const auto& str : list) out << str;
+}
+
+static QStringList readList(QDataStream& in) {
+  QStringList list;
+  quint32 count = 0;
+  in >> count;
+  for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++) {
+    QString str;
+    in >> str;
+    list.append(str);
+  }
+  return list;
+}
+
+BuildCache::BuildCache(const QString& directory) : directory(directory) {
+}
+
+std::optional<BuildOutput> BuildCache::load(const QStringList& fileNames, Address origin) const {
+  QFile file(entryFileName(fileNames, origin));
+  if (!file.open(QIODevice::ReadOnly)) return std::nullopt;
+  const auto buffer = file.readAll();
+  if (!buffer.startsWith(QByteArray(Magic, sizeof Magic))) return std::nullopt;
+
+  QDataStream in(buffer.mid(sizeof Magic));
+  quint32 format = 0;
+  qint32 version = 0;
+  quint16 storedOrigin = 0;
+  in >> format >> version >> storedOrigin;
+  if (format != FormatVersion || version != Assembler::Version || storedOrigin != origin) return std::nullopt;
+  if (readList(in) != fileNames) return std::nullopt;
+
+  BuildOutput output;
+  output.files = readList(in);
+  QByteArray key;
+  in >> key;
+  if (in.status() != QDataStream::Ok) return std::nullopt;
+
+  std::vector<ModuleAssembler::SourceFile> sources;
+  for (const auto& fileName : output.files) {
+    QString contents;
+    if (!ModuleAssembler::readSource(fileName, contents)) return std::nullopt;
+    sources.push_back({fileName, contents});
+  }
+  if (contentKey(sources) != key) return std::nullopt;
+
+  quint32 count = 0;
+  in >> count;
+  for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++) {
+    MemoryPatch::Chunk chunk;
+    QByteArray bytes;
+    in >> chunk.first >> bytes;
+    chunk.bytes.assign(bytes.begin(), bytes.end());
+    output.image.chunks.push_back(std::move(chunk));
+  }
+
+  in >> count;
+  for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++) {
+    QString name;
+    quint16 value = 0;
+    in >> name >> value;
+    output.symbols.put(name, value);
+  }
+
+  in >> count;
+  output.lines.reserve(count);
+  for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++) {
+    SourceLine line;
+    qint32 fileIndex = 0;
+    qint32 number = 0;
+    in >> line.address >> line.size >> fileIndex >> number;
+    line.file = fileIndex;
+    line.number = number;
+    output.lines.push_back(line);
+  }
+
+  in >> count;
+  for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++) {
+    LinkedSymbol label;
+    in >> label.name >> label.value;
+    output.labels.push_back(std::move(label));
+  }
+
+  if (in.status() != QDataStream::Ok) return std::nullopt;
+  return output;
+}
+
+bool BuildCache::store(const QStringList& fileNames, Address origin, const std::vector<ModuleAssembler::SourceFile>& sources,
+                       const BuildOutput& output) const {
+  QByteArray buffer(Magic, sizeof Magic);
+  QDataStream out(&buffer, QIODevice::WriteOnly | QIODevice::Append);
+  out << FormatVersion << static_cast<qint32>(Assembler::Version) << origin;
+  writeList(out, fileNames);
+  writeList(out, output.files);
+  out << contentKey(sources);
+
+  out << static_cast<quint32>(output.image.chunks.size());
+  for (const auto& chunk : output.image.chunks) {
+    out << chunk.first << QByteArray(reinterpret_cast<const char*>(chunk.bytes.data()), static_cast<int>(chunk.bytes.size()));
+  }
+
+  out << static_cast<quint32>(output.symbols.size());
+  for (const auto& [name, value] : output.symbols) out << name.toString() << value;
+
+  out << static_cast<quint32>(output.lines.size());
+  for (const auto& line : output.lines) {
+    out << line.address << line.size << static_cast<qint32>(line.file) << static_cast<qint32>(line.number);
+  }
+
+  out << static_cast<quint32>(output.labels.size());
+  for (const auto& label : output.labels) out << label.name << label.value;
+
+  // written in one go, so a build running at the same time never reads half of an entry
+  if (!QDir().mkpath(directory)) return false;
+  QSaveFile file(entryFileName(fileNames, origin));
+  if (!file.open(QIODevice::WriteOnly)) return false;
+  file.write(buffer);
+  return file.commit();
+}
+
+QString BuildCache::entryFileName(const QStringList& fileNames, Address origin) const {
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  hash.addData(fileNames.join('\n').toUtf8());
+  hash.addData(QByteArray::number(origin));
+  return QDir(directory).filePath(QString::fromLatin1(hash.result().toHex()) + ".build");
+}
+
+QByteArray BuildCache::contentKey(const std::vector<ModuleAssembler::SourceFile>& sources) {
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  for (const auto& source : sources) {
+    hash.addData(source.fileName.toUtf8());
+    hash.addData(QByteArray(1, '\0'));
+    hash.addData(QByteArray::number(source.contents.size()));
+    hash.addData(source.contents.toUtf8());
+  }
+  return hash.result();
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "linker.h"
+#include "moduleassembler.h"
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <optional>
+#include <vector>
+
+// Keeps the output of project builds on disk, keyed by the assembler version and the contents of every file
+// that went into a build, so building an unchanged project again only reads and hashes its sources
+class BuildCache {
+public:
+  static constexpr char Magic[8] = {'M', 'O', '6', '5', 'X', 'B', 'L', 'D'};
+  static constexpr quint32 FormatVersion = 2;
+
+  explicit BuildCache(const QString& directory);
+
+  // nullopt unless the project was stored and none of its sources changed since
+  std::optional<BuildOutput> load(const QStringList& fileNames, Address origin) const;
+
+  // sources with their includes, as assembled; returns false if the entry could not be written
+  bool store(const QStringList& fileNames, Address origin, const std::vector<ModuleAssembler::SourceFile>&,
+             const BuildOutput&) const;
+
+  // of the entry for a project
+  QString entryFileName(const QStringList& fileNames, Address origin) const;
+
+private:
+  QString directory;
+
+  static QByteArray contentKey(const std::vector<ModuleAssembler::SourceFile>&);
+};
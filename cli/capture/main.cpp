@@ -0,0 +1,111 @@
+#include "headlesscapture.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QTextStream>
+#include <algorithm>
+#include <memory>
+
+// loads a raw binary, runs it for a number of frames without the GUI and records them, e.g. to compare a build
+// against the hash log of a golden run in a pipeline
+int main(int argc, char* argv[]) {
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName("mo65x-capture");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Runs a 65xx binary headless and records the frames it renders.");
+  parser.addHelpOption();
+  const QCommandLineOption loadOption("load", "Loads the binary at <address>, 0x0600 by default.", "address", "0x0600");
+  const QCommandLineOption startOption("start", "Starts at <address>, the load address by default.", "address");
+  const QCommandLineOption framesOption({"n", "frames"}, "Runs for <count> frames.", "count");
+  const QCommandLineOption clockOption("clock", "Runs at <hz> cycles per second of emulated time, 1000000 by default.",
+                                       "hz", "1000000");
+  const QCommandLineOption frameRateOption("frame-rate", "Renders <fps> frames per second of emulated time, 60 by default.",
+                                           "fps", "60");
+  const QCommandLineOption vblankOption("vblank", "Raises <interrupt> after each frame: none, irq or nmi.", "interrupt",
+                                        "none");
+  const QCommandLineOption screenOption("screen", "Shows the default frame buffer at <address>, 0x0200 by default.",
+                                        "address", "0x0200");
+  const QCommandLineOption videoOption("video", "Writes the frames to <file>, *.y4m or compressed raw frames.", "file");
+  const QCommandLineOption hashesOption("hashes", "Writes a hash per frame to <file>.", "file");
+  const QCommandLineOption goldenOption("golden", "Compares the frames with the hash log <file> of an earlier run.", "file");
+  const QCommandLineOption mismatchesOption("only-mismatches", "Writes only frames differing from the golden run.");
+  parser.addOptions({loadOption, startOption, framesOption, clockOption, frameRateOption, vblankOption, screenOption,
+                     videoOption, hashesOption, goldenOption, mismatchesOption});
+  parser.addPositionalArgument("binary", "Raw binary to run.");
+  parser.process(app);
+
+  QTextStream out(stdout);
+  QTextStream err(stderr);
+  const auto arguments = parser.positionalArguments();
+  if (arguments.size() != 1 || !parser.isSet(framesOption)) parser.showHelp(1);
+
+  const auto number = [&](const QCommandLineOption& option, unsigned long long max, unsigned long long& value) {
+    bool valid = true;
+    value = parser.value(option).toULongLong(&valid, 0);
+    if (valid && value <= max) return true;
+    err << "invalid " << option.names().back() << ": " << parser.value(option) << "\n";
+    return false;
+  };
+  unsigned long long load, start, frames, clock, frameRate, screen;
+  if (!number(loadOption, 0xffff, load) || !number(framesOption, UINT64_MAX, frames) ||
+      !number(clockOption, UINT32_MAX, clock) || !number(frameRateOption, 1000, frameRate) ||
+      !number(screenOption, 0xffff, screen))
+    return 1;
+  start = load;
+  if (parser.isSet(startOption) && !number(startOption, 0xffff, start)) return 1;
+  if (!frameRate || clock < frameRate) {
+    err << "the clock must run at least one cycle per frame\n";
+    return 1;
+  }
+
+  HeadlessCapture::Options options;
+  options.start = static_cast<Address>(start);
+  options.frames = frames;
+  options.clock = static_cast<Frequency>(clock);
+  options.pacing.frameRate = static_cast<Frequency>(frameRate);
+  options.defaultFrameBuffer = static_cast<Address>(screen);
+  const auto vblank = parser.value(vblankOption);
+  if (vblank == "irq") {
+    options.pacing.interrupt = VBlankInterrupt::Irq;
+  } else if (vblank == "nmi") {
+    options.pacing.interrupt = VBlankInterrupt::Nmi;
+  } else if (vblank != "none") {
+    err << "invalid vblank: " << vblank << "\n";
+    return 1;
+  }
+  options.capture.videoFileName = parser.value(videoOption);
+  options.capture.hashLogFileName = parser.value(hashesOption);
+  options.capture.goldenFileName = parser.value(goldenOption);
+  options.capture.onlyMismatches = parser.isSet(mismatchesOption);
+
+  QFile file(arguments.front());
+  if (!file.open(QIODevice::ReadOnly)) {
+    err << "cannot read " << file.fileName() << "\n";
+    return 1;
+  }
+  const auto binary = file.readAll();
+  if (load + static_cast<unsigned long long>(binary.size()) > Memory::Size) {
+    err << file.fileName() << " does not fit at " << parser.value(loadOption) << "\n";
+    return 1;
+  }
+
+  auto memory = std::make_unique<Memory>();
+  std::fill(memory->begin(), memory->end(), 0);
+  std::copy(binary.begin(), binary.end(), memory->begin() + load);
+  const auto summary = HeadlessCapture(*memory).run(options);
+  if (!summary.ok()) {
+    err << summary.error << "\n";
+    return 1;
+  }
+
+  out << QString("%1 frames").arg(summary.frames);
+  if (summary.frames < frames) out << " (halted)";
+  if (!options.capture.goldenFileName.isEmpty()) {
+    out << QString(", %1 mismatches").arg(summary.mismatches);
+    if (summary.mismatches) out << QString(", the first in frame %1").arg(summary.firstMismatch);
+  }
+  if (summary.skippedFrames) out << QString(", %1 frames of another size not in the video").arg(summary.skippedFrames);
+  out << "\n";
+  return summary.mismatches || summary.frames < frames ? 1 : 0;
+}
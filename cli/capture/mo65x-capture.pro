@@ -0,0 +1,32 @@
+QT       += core
+QT       -= gui
+
+TEMPLATE = app
+TARGET = mo65x-capture
+CONFIG += c++17 console
+CONFIG -= app_bundle
+CONFIG += strict_c++
+CONFIG += sdk_no_version_check
+QMAKE_CXXFLAGS += -Wno-padded
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    main.cpp \
+    ../../addressrange.cpp \
+    ../../cpu.cpp \
+    ../../cpustate.cpp \
+    ../../executionstatistics.cpp \
+    ../../framerecorder.cpp \
+    ../../headlesscapture.cpp \
+    ../../videodevice.cpp
+
+HEADERS += \
+    ../../cpu.h \
+    ../../framepacing.h \
+    ../../framerecorder.h \
+    ../../headlesscapture.h \
+    ../../memory.h \
+    ../../videodevice.h
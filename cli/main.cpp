@@ -0,0 +1,144 @@
+#include "batchassembler.h"
+#include "peepholeoptimizer.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileSystemWatcher>
+#include <QTextStream>
+#include <QThreadPool>
+#include <QTimer>
+#include <algorithm>
+
+// assembles the files given on the command line, each on its own, e.g. for building test programs in a pipeline
+int main(int argc, char* argv[]) {
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName("mo65x-asm");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Assembles 65xx sources into raw binaries, listings and symbol files.");
+  parser.addHelpOption();
+  const QCommandLineOption outputOption({"o", "output"}, "Writes the outputs to <directory>.", "directory");
+  const QCommandLineOption originOption("origin", "Places relocatable code at <address>, 0 by default.", "address", "0");
+  const QCommandLineOption jobsOption({"j", "jobs"}, "Assembles up to <count> files at a time.", "count");
+  const QCommandLineOption noListingOption("no-listing", "Writes no listings.");
+  const QCommandLineOption noSymbolsOption("no-symbols", "Writes no symbol files.");
+  const QCommandLineOption optimizeOption("optimize", "Runs the peephole optimizer and reports its rewrites.");
+  const QCommandLineOption cacheOption("cache", "Keeps builds in <directory> to skip unchanged files next time.", "directory");
+  const QCommandLineOption linkOption("link", "Links all files into one image, with outputs named <name>.", "name");
+  const QCommandLineOption watchOption("watch", "Builds again whenever a source changes, until interrupted.");
+  parser.addOptions({outputOption, originOption, jobsOption, noListingOption, noSymbolsOption, optimizeOption, cacheOption,
+                     linkOption, watchOption});
+  parser.addPositionalArgument("files", "Sources to assemble.", "files...");
+  parser.process(app);
+
+  QTextStream out(stdout);
+  QTextStream err(stderr);
+  const auto fileNames = parser.positionalArguments();
+  if (fileNames.isEmpty()) parser.showHelp(1);
+
+  BatchAssembler::Options options;
+  bool valid = true;
+  const auto origin = parser.value(originOption).toUInt(&valid, 0);
+  if (!valid || origin > 0xffff) {
+    err << "invalid origin: " << parser.value(originOption) << "\n";
+    return 1;
+  }
+  options.origin = static_cast<Address>(origin);
+  options.outputDirectory = parser.value(outputOption);
+  if (!options.outputDirectory.isEmpty() && !QDir().mkpath(options.outputDirectory)) {
+    err << "cannot create " << options.outputDirectory << "\n";
+    return 1;
+  }
+  options.listings = !parser.isSet(noListingOption);
+  options.symbols = !parser.isSet(noSymbolsOption);
+  options.optimize = parser.isSet(optimizeOption);
+  options.cacheDirectory = parser.value(cacheOption);
+  options.project = parser.value(linkOption);
+  if (parser.isSet(jobsOption)) {
+    const auto jobs = parser.value(jobsOption).toInt(&valid);
+    if (!valid || jobs < 1) {
+      err << "invalid number of jobs: " << parser.value(jobsOption) << "\n";
+      return 1;
+    }
+    QThreadPool::globalInstance()->setMaxThreadCount(jobs);
+  }
+
+  BatchAssembler assembler(options);
+  const auto build = [&] {
+    QElapsedTimer timer;
+    timer.start();
+    const auto ok = assembler.assemble(fileNames);
+    const auto elapsed = timer.nsecsElapsed();
+
+    auto failed = 0;
+    auto lines = 0;
+    qint64 bytes = 0;
+    for (const auto& result : assembler.results()) {
+      for (const auto& error : result.errors) {
+        err << error.fileName << ":" << error.line + 1 << ":" << error.column + 1 << ": "
+            << formatAssemblyResult(error.result) << (error.symbol.isEmpty() ? "" : " ") << error.symbol << "\n";
+      }
+      if (!result.collidesWith.isEmpty()) err << result.fileName << ": same outputs as " << result.collidesWith << "\n";
+      for (const auto& fileName : result.unwritten) err << "cannot write " << fileName << "\n";
+      for (const auto& rewrite : result.rewrites) {
+        out << rewrite.fileName << ":" << rewrite.line + 1 << ": "
+            << PeepholeOptimizer::describe({rewrite.kind, rewrite.line, rewrite.bytesSaved, rewrite.cyclesSaved}) << "\n";
+      }
+      if (!result.ok()) failed++;
+      lines += result.lines;
+      bytes += result.bytes;
+    }
+
+    const auto seconds = std::max(elapsed, qint64(1)) / 1e9;
+    if (options.project.isEmpty()) {
+      out << QString("%1 files (%2 failed), %3 lines, %4 bytes in %5 ms: %6 lines/s, %7 files/s on %8 threads\n")
+                 .arg(fileNames.size())
+                 .arg(failed)
+                 .arg(lines)
+                 .arg(bytes)
+                 .arg(elapsed / 1e6, 0, 'f', 1)
+                 .arg(lines / seconds, 0, 'f', 0)
+                 .arg(fileNames.size() / seconds, 0, 'f', 1)
+                 .arg(QThreadPool::globalInstance()->maxThreadCount());
+    } else {
+      out << QString("%1: %2 modules (%3 assembled), %4 lines, %5 bytes in %6 ms%7\n")
+                 .arg(options.project)
+                 .arg(fileNames.size())
+                 .arg(assembler.results().front().assembled)
+                 .arg(lines)
+                 .arg(bytes)
+                 .arg(elapsed / 1e6, 0, 'f', 1)
+                 .arg(ok ? "" : ", failed");
+    }
+    out.flush();
+    err.flush();
+    return ok;
+  };
+
+  const auto ok = build();
+  if (!parser.isSet(watchOption)) return ok ? 0 : 1;
+
+  // a project keeps its modules between builds, so only the ones that changed are assembled again; editors
+  // often replace a file rather than write it, so the files are watched anew after each build
+  QFileSystemWatcher watcher;
+  const auto watch = [&] {
+    auto files = fileNames;
+    for (const auto& result : assembler.results()) files += result.files;
+    files.removeDuplicates();
+    if (!watcher.files().isEmpty()) watcher.removePaths(watcher.files());
+    watcher.addPaths(files);
+  };
+  watch();
+
+  // a save can touch several files at once
+  QTimer settle;
+  settle.setSingleShot(true);
+  settle.setInterval(100);
+  QObject::connect(&watcher, &QFileSystemWatcher::fileChanged, &settle, qOverload<>(&QTimer::start));
+  QObject::connect(&settle, &QTimer::timeout, [&] {
+    build();
+    watch();
+  });
+  return app.exec();
+}
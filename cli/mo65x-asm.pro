@@ -0,0 +1,47 @@
+QT       += core concurrent
+QT       -= gui
+
+TEMPLATE = app
+TARGET = mo65x-asm
+CONFIG += c++17 console
+CONFIG -= app_bundle
+CONFIG += strict_c++
+CONFIG += sdk_no_version_check
+QMAKE_CXXFLAGS += -Wno-padded
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    main.cpp \
+    ../addressrange.cpp \
+    ../assembler.cpp \
+    ../assemblyresult.cpp \
+    ../batchassembler.cpp \
+    ../buildcache.cpp \
+    ../lineparser.cpp \
+    ../linker.cpp \
+    ../listing.cpp \
+    ../memorypatch.cpp \
+    ../mnemonics.cpp \
+    ../moduleassembler.cpp \
+    ../objectmodule.cpp \
+    ../peepholeoptimizer.cpp \
+    ../projectbuilder.cpp \
+    ../symboltable.cpp
+
+HEADERS += \
+    ../assembler.h \
+    ../assemblyresult.h \
+    ../batchassembler.h \
+    ../buildcache.h \
+    ../lineparser.h \
+    ../linker.h \
+    ../listing.h \
+    ../memorypatch.h \
+    ../moduleassembler.h \
+    ../objectmodule.h \
+    ../peepholeoptimizer.h \
+    ../projectbuilder.h \
+    ../symboltable.h
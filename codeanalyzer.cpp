@@ -0,0 +1,211 @@
+#include "codeanalyzer.h"
+#include "cpudefs.h"
+#include "instructiontable.h"
+
+static Address wordAt(const Memory& memory, Address addr) {
+  return static_cast<Address>(memory[addr] | memory[static_cast<Address>(addr + 1)] << 8);
+}
+
+static bool endsBlock(const Instruction& ins) {
+  switch (ins.type) {
+  case JMP:
+  case JSR:
+  case RTS:
+  case RTI:
+  case BRK:
+  case KIL: return true;
+  default: return ins.mode == Branch;
+  }
+}
+
+CodeAnalyzer::CodeAnalyzer(const Memory& memory) : memory(memory) {
+}
+
+void CodeAnalyzer::addEntryPoint(Address addr) {
+  if (entryPoints[addr]) return;
+
+  entryPoints.set(addr);
+  // an entry point inside known code only splits a block, not worth a new pass until something else changes
+  if (kinds[addr] != OpcodeByte) dirty = true;
+}
+
+void CodeAnalyzer::clearEntryPoints() {
+  if (entryPoints.none()) return;
+
+  entryPoints.reset();
+  dirty = true;
+}
+
+void CodeAnalyzer::invalidate(AddressRange range) {
+  for (uint32_t addr = range.first; !dirty && addr <= range.last; addr++) {
+    if (watched[addr] && memory[static_cast<Address>(addr)] != shadow[addr]) dirty = true;
+  }
+}
+
+bool CodeAnalyzer::update() {
+  if (!dirty) return false;
+
+  analyze();
+  return true;
+}
+
+const CodeAnalyzer::BasicBlock* CodeAnalyzer::blockAt(Address addr) const {
+  auto it = std::upper_bound(basicBlocks.begin(), basicBlocks.end(), addr,
+                             [](Address a, const BasicBlock& block) { return a < block.first; });
+  if (it == basicBlocks.begin()) return nullptr;
+
+  --it;
+  const auto end = it->last + InstructionTable[shadow[it->last]].size;
+  return addr < end ? &*it : nullptr;
+}
+
+void CodeAnalyzer::analyze() {
+  const auto previousKinds = kinds;
+  kinds.fill(DataByte);
+  leaders.fill(false);
+  watched.fill(false);
+
+  std::vector<Address> pending;
+  for (auto addr = Memory::Size; addr-- > 0;) {
+    if (entryPoints[addr]) pending.push_back(static_cast<Address>(addr));
+  }
+  for (const Address vector : {IrqVector, NmiVector, ResetVector}) {
+    watch(vector);
+    watch(static_cast<Address>(vector + 1));
+    pending.push_back(wordAt(memory, vector));
+  }
+
+  while (!pending.empty()) {
+    const auto addr = pending.back();
+    pending.pop_back();
+    leaders[addr] = true;
+    trace(addr, pending);
+  }
+
+  changed = AddressRange::Invalid;
+  for (uint32_t addr = 0; addr < Memory::Size; addr++) {
+    const auto opcodeChanged = kinds[addr] == OpcodeByte && (shadow.empty() || shadow[addr] != memory[addr]);
+    if (kinds[addr] != previousKinds[addr] || opcodeChanged) changed.expand(static_cast<Address>(addr));
+  }
+
+  shadow.assign(memory.cbegin(), memory.cend());
+  buildBlocks();
+  analysisCount++;
+  dirty = false;
+}
+
+void CodeAnalyzer::trace(Address addr, std::vector<Address>& pending) {
+  for (;;) {
+    if (kinds[addr] != DataByte) {
+      // joined a path already traced
+      if (kinds[addr] == OpcodeByte) leaders[addr] = true;
+      return;
+    }
+
+    watch(addr);
+    const auto& ins = InstructionTable[memory[addr]];
+    if (ins.type == KIL) return;
+
+    for (Address i = 1; i < ins.size; i++) {
+      if (kinds[static_cast<Address>(addr + i)] != DataByte) return;
+    }
+
+    kinds[addr] = OpcodeByte;
+    for (Address i = 1; i < ins.size; i++) {
+      kinds[static_cast<Address>(addr + i)] = OperandByte;
+      watch(static_cast<Address>(addr + i));
+    }
+
+    const auto next = static_cast<Address>(addr + ins.size);
+    if (ins.mode == Branch) {
+      const auto target = static_cast<Address>(next + static_cast<int8_t>(memory[static_cast<Address>(addr + 1)]));
+      pending.push_back(target);
+      leaders[next] = true;
+    } else {
+      switch (ins.type) {
+      case JSR:
+        pending.push_back(wordAt(memory, static_cast<Address>(addr + 1)));
+        leaders[next] = true;
+        break;
+
+      case JMP:
+        if (ins.mode == Indirect) {
+          // the 6502 does not carry into the high byte of the pointer
+          const auto ptr = wordAt(memory, static_cast<Address>(addr + 1));
+          const auto ptrHi = static_cast<Address>((ptr & 0xff00) | ((ptr + 1) & 0xff));
+          watch(ptr);
+          watch(ptrHi);
+          pending.push_back(static_cast<Address>(memory[ptr] | memory[ptrHi] << 8));
+        } else {
+          pending.push_back(wordAt(memory, static_cast<Address>(addr + 1)));
+        }
+        return;
+
+      case RTS:
+      case RTI:
+      case BRK: return;
+
+      default: break;
+      }
+    }
+
+    if (next < addr) return;
+    addr = next;
+  }
+}
+
+void CodeAnalyzer::buildBlocks() {
+  basicBlocks.clear();
+
+  const auto addSuccessor = [this](BasicBlock& block, Address target) {
+    if (kinds[target] == OpcodeByte &&
+        std::find(block.successors.begin(), block.successors.end(), target) == block.successors.end()) {
+      block.successors.push_back(target);
+    }
+  };
+
+  uint32_t addr = 0;
+  while (addr < Memory::Size) {
+    if (kinds[addr] != OpcodeByte) {
+      addr++;
+      continue;
+    }
+
+    BasicBlock block{static_cast<Address>(addr), static_cast<Address>(addr), {}};
+    for (;;) {
+      const auto current = static_cast<Address>(addr);
+      const auto& ins = InstructionTable[memory[current]];
+      const auto operand = wordAt(memory, static_cast<Address>(current + 1));
+      const uint32_t next = addr + ins.size;
+      block.last = current;
+      addr = next;
+
+      if (endsBlock(ins)) {
+        if (ins.mode == Branch) {
+          addSuccessor(block, static_cast<Address>(next + static_cast<int8_t>(operand & 0xff)));
+          addSuccessor(block, static_cast<Address>(next));
+        } else if (ins.type == JSR) {
+          addSuccessor(block, operand);
+          addSuccessor(block, static_cast<Address>(next));
+        } else if (ins.type == JMP && ins.mode == Absolute) {
+          addSuccessor(block, operand);
+        } else if (ins.type == JMP) {
+          const auto ptrHi = static_cast<Address>((operand & 0xff00) | ((operand + 1) & 0xff));
+          addSuccessor(block, static_cast<Address>(memory[operand] | memory[ptrHi] << 8));
+        }
+        break;
+      }
+
+      if (next >= Memory::Size || kinds[next] != OpcodeByte) break;
+      if (leaders[next]) {
+        addSuccessor(block, static_cast<Address>(next));
+        break;
+      }
+    }
+    basicBlocks.push_back(std::move(block));
+  }
+}
+
+void CodeAnalyzer::watch(Address addr) {
+  watched[addr] = true;
+}
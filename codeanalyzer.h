@@ -0,0 +1,59 @@
+#pragma once
+
+#include "addressrange.h"
+#include "commondefs.h"
+#include "memory.h"
+#include <array>
+#include <bitset>
+#include <vector>
+
+// Recursive descent from the interrupt vectors and entry points, classifying every byte
+class CodeAnalyzer {
+public:
+  enum ByteKind : uint8_t { DataByte, OpcodeByte, OperandByte };
+
+  struct BasicBlock {
+    Address first;
+    Address last; // address of the last instruction
+    std::vector<Address> successors;
+  };
+
+  explicit CodeAnalyzer(const Memory&);
+
+  void addEntryPoint(Address);
+  // for new contents of memory, where the addresses executed before mean nothing
+  void clearEntryPoints();
+  void invalidate(AddressRange = AddressRange::Max);
+
+  // runs the analysis again if anything it relied on changed, returns true in that case
+  bool update();
+
+  ByteKind kind(Address addr) const { return kinds[addr]; }
+  bool isCode(Address addr) const { return kinds[addr] != DataByte; }
+  const std::vector<BasicBlock>& blocks() const { return basicBlocks; }
+  const BasicBlock* blockAt(Address) const;
+  uint32_t generation() const { return analysisCount; }
+
+  // of the addresses whose kind or opcode the last analysis changed, Invalid if none did
+  AddressRange changedRange() const { return changed; }
+
+private:
+  const Memory& memory;
+  std::bitset<Memory::Size> entryPoints;
+  std::array<ByteKind, Memory::Size> kinds{};
+  std::array<bool, Memory::Size> leaders{};
+
+  // bytes the result depends on: code, vectors, indirect jump pointers and opcodes that stopped the descent
+  std::array<bool, Memory::Size> watched{};
+  Data shadow;
+
+  std::vector<BasicBlock> basicBlocks;
+  uint32_t analysisCount = 0;
+  AddressRange changed = AddressRange::Invalid;
+  bool dirty = true;
+
+  void analyze();
+  void trace(Address, std::vector<Address>& pending);
+  void buildBlocks();
+  void watch(Address);
+};
@@ -1,6 +1,7 @@
 #include "cpu.h"
 #include "decodetable.h"
 #include <chrono>
+#include <thread>
 
 Cpu::Cpu(Memory& memory) : memory(memory) {
 }
@@ -389,36 +390,32 @@ void Cpu::execKIL() {
   state = CpuState::Halted;
 }
 
-void Cpu::execute(bool continuous, Duration period) {
-  state = CpuState::Running;
-  while (state == CpuState::Running) {
-    const auto t0 = PreciseClock::now();
-    pageBoundaryCrossed = false;
-    const auto pcPtr = &memory[regs.pc];
-    operandPtr.lo = &memory[regs.pc + 1];
-    operandPtr.hi = &memory[regs.pc + 2];
-    const auto& entry = DecodeTable[*pcPtr];
-    const auto ins = entry.instruction;
+// executes one instruction and services a pending interrupt, returns the base number of cycles
+inline uint8_t Cpu::step() {
+  pageBoundaryCrossed = false;
+  const auto pcPtr = &memory[regs.pc];
+  operandPtr.lo = &memory[regs.pc + 1];
+  operandPtr.hi = &memory[regs.pc + 2];
+  const auto& entry = DecodeTable[*pcPtr];
+  const auto ins = entry.instruction;
 
-    regs.pc += ins->size;
+  regs.pc += ins->size;
 
-    (this->*entry.prepareOperands)();
-    (this->*entry.executeInstruction)();
+  (this->*entry.prepareOperands)();
+  (this->*entry.executeInstruction)();
 
-    const auto dc = ins->cycles;
-    const auto t1 = t0 + period * dc;
-    while (PreciseClock::now() < t1) {}
-    cycles += dc;
-    duration += std::chrono::duration_cast<Duration>(PreciseClock::now() - t0);
+  cycles += ins->cycles;
 
-    switch (runLevel) {
-    case CpuRunLevel::Normal: break;
-    case CpuRunLevel::PendingReset: reset(); break;
-    case CpuRunLevel::PendingNmi: nmi(); break;
-    case CpuRunLevel::PendingIrq: irq(); break;
-    }
-    if (!continuous) break;
+  switch (runLevel) {
+  case CpuRunLevel::Normal: break;
+  case CpuRunLevel::PendingReset: reset(); break;
+  case CpuRunLevel::PendingNmi: nmi(); break;
+  case CpuRunLevel::PendingIrq: irq(); break;
   }
+  return ins->cycles;
+}
+
+void Cpu::leaveRunningState() {
   switch (state) {
   case CpuState::Running: state = CpuState::Idle; break;
   case CpuState::Stopping: state = CpuState::Stopped; break;
@@ -426,6 +423,57 @@ void Cpu::execute(bool continuous, Duration period) {
   }
 }
 
+void Cpu::execute(bool continuous, Duration period) {
+  state = CpuState::Running;
+  while (state == CpuState::Running) {
+    const auto t0 = PreciseClock::now();
+    const auto dc = step();
+    const auto t1 = t0 + period * dc;
+    while (PreciseClock::now() < t1) {}
+    duration += std::chrono::duration_cast<Duration>(PreciseClock::now() - t0);
+    if (!continuous) break;
+  }
+  leaveRunningState();
+}
+
+// runs a fixed number of cycles per frame as fast as possible, then waits for the frame period to elapse
+void Cpu::executeFrames(Frequency clock, FramePacing pacing, const std::function<void()>& frameCompleted) {
+  const auto cyclesPerFrame = pacing.cyclesPerFrame(clock);
+  const auto framePeriod = pacing.period();
+  long frameCycles = 0;
+  auto frameStart = PreciseClock::now();
+
+  state = CpuState::Running;
+  while (state == CpuState::Running) {
+    while (frameCycles < cyclesPerFrame && state == CpuState::Running) {
+      const auto c0 = cycles;
+      step();
+      // a reset clears the statistics
+      frameCycles += cycles >= c0 ? cycles - c0 : cycles;
+    }
+    if (state != CpuState::Running) break;
+
+    // instructions overlapping the frame boundary are accounted to the next frame
+    frameCycles -= cyclesPerFrame;
+    frameCompleted();
+    // raised like one from outside, so it neither preempts nor clears a reset or interrupt already pending
+    switch (pacing.interrupt) {
+    case VBlankInterrupt::None: break;
+    case VBlankInterrupt::Irq: triggerIrq(); break;
+    case VBlankInterrupt::Nmi: triggerNmi(); break;
+    }
+
+    const auto frameEnd = frameStart + framePeriod;
+    if (pacing.throttled) std::this_thread::sleep_until(frameEnd);
+    const auto now = PreciseClock::now();
+    duration += std::chrono::duration_cast<Duration>(now - frameStart);
+    // do not try to catch up after falling behind by more than a frame
+    frameStart = !pacing.throttled || now - frameEnd > framePeriod ? now : frameEnd;
+  }
+  duration += std::chrono::duration_cast<Duration>(PreciseClock::now() - frameStart);
+  leaveRunningState();
+}
+
 void Cpu::triggerReset() {
   if (runLevel < CpuRunLevel::PendingReset) {
     if (running()) {
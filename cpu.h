@@ -2,6 +2,7 @@
 
 #include "cpuinfo.h"
 #include "cpustate.h"
+#include "framepacing.h"
 #include "instruction.h"
 #include "memory.h"
 #include "operandptr.h"
@@ -29,6 +30,7 @@ public:
   void resetStatistics();
   void stopExecution();
   void execute(bool continuous, Duration period = Duration(1000));
+  void executeFrames(Frequency clock, FramePacing, const std::function<void()>& frameCompleted);
   void triggerReset();
   void triggerNmi();
   void triggerIrq();
@@ -84,6 +86,8 @@ private:
 
   void execCompare(uint8_t op1) { regs.p.computeNZC(op1 + (*effectiveOperandPtr.lo ^ 0xff) + uint8_t(1)); }
 
+  uint8_t step();
+  void leaveRunningState();
   void nmi();
   void irq();
   void execKIL();
@@ -10,21 +10,47 @@ static QString flagStr(bool flagStatus, const char* flagCode) {
   return flagStatus ? flagCode : QString("<span style='color:gray'>%1</span>").arg(flagCode);
 }
 
-CpuWidget::CpuWidget(QWidget* parent, const Memory& memory) : QDockWidget(parent), ui(new Ui::CpuWidget), memory(memory) {
+static void setValueSilently(QSpinBox* spinBox, int value) {
+  const QSignalBlocker blocker(spinBox);
+  spinBox->setValue(value);
+}
+
+CpuWidget::CpuWidget(QWidget* parent, const Memory& memory, CodeAnalyzer& analyzer)
+    : QDockWidget(parent), ui(new Ui::CpuWidget), memory(memory) {
   ui->setupUi(this);
 
-  disassemblerView = new DisassemblerView(this, memory);
+  disassemblerView = new DisassemblerView(this, memory, analyzer);
   QVBoxLayout* layout = static_cast<QVBoxLayout*>(ui->dockWidgetContents->layout());
   layout->insertWidget(layout->indexOf(ui->auxFrame), disassemblerView);
 
   connect(ui->reset, &QAbstractButton::clicked, this, &CpuWidget::resetRequested);
   connect(ui->nmi, &QAbstractButton::clicked, this, &CpuWidget::nmiRequested);
   connect(ui->irq, &QAbstractButton::clicked, this, &CpuWidget::irqRequested);
-  connect(ui->regPC, QOverload<int>::of(&QSpinBox::valueChanged), this, &CpuWidget::programCounterChanged);
-  connect(ui->regSP, QOverload<int>::of(&QSpinBox::valueChanged), this, &CpuWidget::stackPointerChanged);
-  connect(ui->regA, QOverload<int>::of(&QSpinBox::valueChanged), this, &CpuWidget::registerAChanged);
-  connect(ui->regX, QOverload<int>::of(&QSpinBox::valueChanged), this, &CpuWidget::registerXChanged);
-  connect(ui->regY, QOverload<int>::of(&QSpinBox::valueChanged), this, &CpuWidget::registerYChanged);
+  // edits are recorded in the shown state, so the state the emulator publishes in response is not applied again
+  connect(ui->regPC, QOverload<int>::of(&QSpinBox::valueChanged), [&](int value) {
+    shownState.regs.pc = static_cast<Address>(value);
+    disassemblerView->addEntryPoint(shownState.regs.pc);
+    disassemblerView->changeStart(shownState.regs.pc);
+    emit programCounterChanged(shownState.regs.pc);
+  });
+  connect(ui->regSP, QOverload<int>::of(&QSpinBox::valueChanged), [&](int value) {
+    shownState.regs.sp.offset = static_cast<uint8_t>(value);
+    emit stackPointerChanged(static_cast<uint16_t>(value));
+  });
+  connect(ui->regA, QOverload<int>::of(&QSpinBox::valueChanged), [&](int value) {
+    shownState.regs.a = static_cast<uint8_t>(value);
+    emit registerAChanged(shownState.regs.a);
+  });
+  connect(ui->regX, QOverload<int>::of(&QSpinBox::valueChanged), [&](int value) {
+    shownState.regs.x = static_cast<uint8_t>(value);
+    emit registerXChanged(shownState.regs.x);
+  });
+  connect(ui->regY, QOverload<int>::of(&QSpinBox::valueChanged), [&](int value) {
+    shownState.regs.y = static_cast<uint8_t>(value);
+    emit registerYChanged(shownState.regs.y);
+  });
+  connect(ui->frameRate, QOverload<int>::of(&QSpinBox::valueChanged),
+          [&](int value) { emit frameRateChanged(static_cast<Frequency>(value)); });
   connect(ui->clearStatistics, &QAbstractButton::clicked, this, &CpuWidget::clearStatisticsRequested);
   connect(ui->skipInstruction, &QAbstractButton::clicked, this, &CpuWidget::skipInstruction);
   connect(ui->continuousExecution, &QAbstractButton::clicked, [&] { emitExecutionRequest(true); });
@@ -48,40 +74,46 @@ void CpuWidget::updateOnChange(AddressRange range) {
 
 void CpuWidget::updateState(EmulatorState es) {
   const auto& regs = es.regs;
-
-  setWindowTitle(tr("%1 @ %2").arg(formatCpuState(es.state), formatRunLevel(es.runLevel)));
-
-  ui->regA->setValue(regs.a);
-  ui->regX->setValue(regs.x);
-  ui->regY->setValue(regs.y);
-  ui->regSP->setValue(regs.sp.address());
-  ui->regPC->setValue(regs.pc);
-
-  updateSpecialCpuAddresses();
-
-  QString str;
-  str.append(flagStr(regs.p.negative, "N"));
-  str.append(flagStr(regs.p.overflow, "V"));
-  str.append(flagStr(false, "."));
-  str.append(flagStr(false, "B"));
-  str.append(flagStr(regs.p.decimal, "D"));
-  str.append(flagStr(regs.p.interrupt, "I"));
-  str.append(flagStr(regs.p.zero, "Z"));
-  str.append(flagStr(regs.p.carry, "C"));
-  ui->flags->setText(str);
-
-  ui->lastExecStats->setText(formatExecutionStatistics(es.lastExecutionStatistics));
-  ui->avgExecStats->setText(formatExecutionStatistics(es.avgExecutionStatistics));
-
-  ui->regPC->setValue(regs.pc);
-  disassemblerView->changeStart(regs.pc);
-  updateUI(es.state);
+  const auto& shown = shownState.regs;
+  const auto all = !stateShown;
+
+  if (all || es.state != shownState.state || es.runLevel != shownState.runLevel) showCpuState(es.state, es.runLevel);
+
+  if (all || regs.a != shown.a) setValueSilently(ui->regA, regs.a);
+  if (all || regs.x != shown.x) setValueSilently(ui->regX, regs.x);
+  if (all || regs.y != shown.y) setValueSilently(ui->regY, regs.y);
+  if (all || regs.sp.offset != shown.sp.offset) setValueSilently(ui->regSP, regs.sp.address());
+  if (all || regs.p.toByte() != shown.p.toByte()) updateFlags(regs.p);
+
+  if (all || es.lastExecutionStatistics != shownState.lastExecutionStatistics) {
+    ui->lastExecStats->setText(formatExecutionStatistics(es.lastExecutionStatistics));
+  }
+  if (all || es.avgExecutionStatistics != shownState.avgExecutionStatistics) {
+    ui->avgExecStats->setText(formatExecutionStatistics(es.avgExecutionStatistics));
+  }
+
+  if (all || regs.pc != shown.pc) {
+    setValueSilently(ui->regPC, regs.pc);
+    disassemblerView->addEntryPoint(regs.pc);
+    disassemblerView->changeStart(regs.pc);
+  }
+
+  shownState = es;
+  stateShown = true;
 }
 
 void CpuWidget::changeProgramCounter(uint16_t addr) {
   ui->regPC->setValue(addr);
 }
 
+Frequency CpuWidget::frameRate() const {
+  return static_cast<Frequency>(ui->frameRate->value());
+}
+
+void CpuWidget::clearEntryPoints() {
+  disassemblerView->clearEntryPoints();
+}
+
 void CpuWidget::updateSpecialCpuAddresses() {
   ui->resetVector->setValue(memory.word(CpuAddress::ResetVector));
   ui->nmiVector->setValue(memory.word(CpuAddress::NmiVector));
@@ -90,6 +122,24 @@ void CpuWidget::updateSpecialCpuAddresses() {
   ui->ioPortConfig->setValue(memory[CpuAddress::IoPortConfig]);
 }
 
+void CpuWidget::updateFlags(ProcessorStatus p) {
+  QString str;
+  str.append(flagStr(p.negative, "N"));
+  str.append(flagStr(p.overflow, "V"));
+  str.append(flagStr(false, "."));
+  str.append(flagStr(false, "B"));
+  str.append(flagStr(p.decimal, "D"));
+  str.append(flagStr(p.interrupt, "I"));
+  str.append(flagStr(p.zero, "Z"));
+  str.append(flagStr(p.carry, "C"));
+  ui->flags->setText(str);
+}
+
+void CpuWidget::showCpuState(CpuState state, CpuRunLevel runLevel) {
+  setWindowTitle(tr("%1 @ %2").arg(formatCpuState(state), formatRunLevel(runLevel)));
+  updateUI(state);
+}
+
 void CpuWidget::updateUI(CpuState state) {
   const auto processing = state == CpuState::Running || state == CpuState::Stopping;
   ui->cpuFrame->setDisabled(processing);
@@ -103,6 +153,8 @@ void CpuWidget::updateUI(CpuState state) {
   ui->ioPortData->setDisabled(processing);
   ui->ioPortConfig->setDisabled(processing);
   ui->clockFrequency->setDisabled(processing);
+  ui->frameRate->setDisabled(processing);
+  ui->vblankInterrupt->setDisabled(processing);
 }
 
 void CpuWidget::skipInstruction() {
@@ -111,6 +163,9 @@ void CpuWidget::skipInstruction() {
 }
 
 void CpuWidget::emitExecutionRequest(bool continuous) {
-  updateUI(CpuState::Running);
-  emit executionRequested(continuous, static_cast<Frequency>(ui->clockFrequency->value() * 1e6));
+  shownState.state = CpuState::Running;
+  showCpuState(shownState.state, shownState.runLevel);
+  const FramePacing pacing{frameRate(),
+                           static_cast<VBlankInterrupt>(ui->vblankInterrupt->currentIndex())};
+  emit executionRequested(continuous, static_cast<Frequency>(ui->clockFrequency->value() * 1e6), pacing);
 }
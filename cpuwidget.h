@@ -4,6 +4,7 @@
 #include "commondefs.h"
 #include "disassemblerview.h"
 #include "emulatorstate.h"
+#include "framepacing.h"
 #include <QDockWidget>
 
 namespace Ui {
@@ -14,11 +15,14 @@ class CpuWidget : public QDockWidget {
   Q_OBJECT
 
 public:
-  explicit CpuWidget(QWidget* parent, const Memory&);
+  CpuWidget(QWidget* parent, const Memory&, CodeAnalyzer&);
   ~CpuWidget() override;
 
+  // of frame paced execution, 0 when off
+  Frequency frameRate() const;
+
 signals:
-  void executionRequested(bool continuous, Frequency clock);
+  void executionRequested(bool continuous, Frequency clock, FramePacing);
   void stopExecutionRequested();
   void clearStatisticsRequested();
   void resetRequested();
@@ -29,11 +33,13 @@ signals:
   void registerAChanged(uint8_t);
   void registerXChanged(uint8_t);
   void registerYChanged(uint8_t);
+  void frameRateChanged(Frequency);
 
 public slots:
   void updateOnChange(AddressRange);
   void updateState(EmulatorState);
   void changeProgramCounter(uint16_t);
+  void clearEntryPoints();
 
 private:
   Ui::CpuWidget* ui;
@@ -41,8 +47,14 @@ private:
   DisassemblerView* disassemblerView;
   const Memory& memory;
 
+  // what the widgets show, compared with every published state to touch only the fields that changed
+  EmulatorState shownState{};
+  bool stateShown = false;
+
   int rowsInView() const;
   void updateSpecialCpuAddresses();
+  void updateFlags(ProcessorStatus);
+  void showCpuState(CpuState, CpuRunLevel);
   void updateUI(CpuState);
   void emitExecutionRequest(bool continuous);
 
@@ -5,7 +5,92 @@
 #include "instructiontable.h"
 #include "mnemonics.h"
 #include <QStringList>
-#include <map>
+#include <array>
+#include <cstring>
+
+namespace {
+
+enum class OperandKind : uint8_t { None, Byte, Word, Displacement };
+
+// mnemonic and everything around the operand, precomputed for each opcode
+struct LineTemplate {
+  char head[8] = {};
+  uint8_t headLength = 0;
+  char tail[4] = {};
+  uint8_t tailLength = 0;
+  OperandKind operand = OperandKind::None;
+  uint8_t operandHiLength = 0;
+  uint8_t operandLoLength = 0;
+
+  constexpr void appendHead(const char* str) {
+    while (*str) head[headLength++] = *str++;
+  }
+
+  constexpr void appendTail(const char* str) {
+    while (*str) tail[tailLength++] = *str++;
+  }
+};
+
+constexpr std::array<LineTemplate, Instruction::NumberOfOpCodes> LineTemplates = [] {
+  std::array<LineTemplate, Instruction::NumberOfOpCodes> arr{};
+  for (size_t i = 0; i < arr.size(); i++) {
+    auto& t = arr[i];
+    const auto& ins = InstructionTable[i];
+    t.appendHead(Mnemonics[ins.type]);
+    t.appendHead(" ");
+    switch (ins.mode) {
+    case ImpliedOrAccumulator: break;
+    case Immediate: t.appendHead("#$"); t.operand = OperandKind::Byte; break;
+    case Absolute: t.appendHead("$"); t.operand = OperandKind::Word; break;
+    case AbsoluteX: t.appendHead("$"); t.appendTail(",X"); t.operand = OperandKind::Word; break;
+    case AbsoluteY: t.appendHead("$"); t.appendTail(",Y"); t.operand = OperandKind::Word; break;
+    case ZeroPage: t.appendHead("$"); t.operand = OperandKind::Byte; break;
+    case ZeroPageX: t.appendHead("$"); t.appendTail(",X"); t.operand = OperandKind::Byte; break;
+    case ZeroPageY: t.appendHead("$"); t.appendTail(",Y"); t.operand = OperandKind::Byte; break;
+    case IndexedIndirectX: t.appendHead("($"); t.appendTail(",X)"); t.operand = OperandKind::Byte; break;
+    case IndirectIndexedY: t.appendHead("($"); t.appendTail("),Y"); t.operand = OperandKind::Byte; break;
+    case Indirect: t.appendHead("($"); t.appendTail(")"); t.operand = OperandKind::Word; break;
+    case Branch: t.operand = OperandKind::Displacement; break;
+    }
+    t.operandHiLength = t.operand == OperandKind::Word ? 2 : 0;
+    t.operandLoLength = t.operand == OperandKind::Word || t.operand == OperandKind::Byte ? 2 : 0;
+  }
+  return arr;
+}();
+
+constexpr std::array<std::array<char, 2>, 256> HexBytes = [] {
+  constexpr char digits[] = "0123456789ABCDEF";
+  std::array<std::array<char, 2>, 256> arr{};
+  for (size_t i = 0; i < arr.size(); i++) arr[i] = {digits[i >> 4], digits[i & 0x0f]};
+  return arr;
+}();
+
+inline char* writeHexByte(char* p, uint8_t b) {
+  std::memcpy(p, HexBytes[b].data(), 2);
+  return p + 2;
+}
+
+inline char* writeDisplacement(char* p, int8_t displacement) {
+  int val = displacement;
+  if (val > 0) *p++ = '+';
+  if (val < 0) {
+    *p++ = '-';
+    val = -val;
+  }
+  if (val >= 100) *p++ = static_cast<char>('0' + val / 100);
+  if (val >= 10) *p++ = static_cast<char>('0' + val / 10 % 10);
+  *p++ = static_cast<char>('0' + val % 10);
+  return p;
+}
+
+// copies the whole fixed size array and advances by the meaningful part only
+template <size_t N>
+inline char* writeChars(char* p, const char (&str)[N], size_t n) {
+  std::memcpy(p, str, N);
+  return p + n;
+}
+
+} // namespace
 
 QString Disassembler::formatOperand8() const {
   return "$" + formatHexByte(memory[address + 1]);
@@ -42,28 +127,46 @@ QString Disassembler::dumpWords(uint16_t n) const {
 }
 
 QString Disassembler::disassemble() const {
-  QString str;
-  for (uint8_t i = 0; i < 3; i++) { str.append(i < instruction.size ? formatHexByte(memory[address + i]).append(" ") : "   "); }
-  str.append(" ");
-  str.append(MnemonicTable.at(instruction.type)).append(" ");
-
-  switch (instruction.mode) {
-  case ImpliedOrAccumulator: break;
-  case Immediate: str.append("#").append(formatOperand8()); break;
-  case Absolute: str.append(formatOperand16()); break;
-  case AbsoluteX: str.append(formatOperand16()).append(",X"); break;
-  case AbsoluteY: str.append(formatOperand16()).append(",Y"); break;
-  case ZeroPage: str.append(formatOperand8()); break;
-  case ZeroPageX: str.append(formatOperand8()).append(",X"); break;
-  case ZeroPageY: str.append(formatOperand8()).append(",Y"); break;
-  case IndexedIndirectX: str.append("(").append(formatOperand8()).append(",X)"); break;
-  case IndirectIndexedY: str.append("(").append(formatOperand8()).append("),Y"); break;
-  case Indirect: str.append("(").append(formatOperand16()).append(")"); break;
-  case Branch:
-    const auto displacement = static_cast<int8_t>(memory[address + 1]);
-    if (displacement > 0) str.append("+");
-    str.append(QString::number(displacement));
-    break;
+  char buf[MaxLineLength];
+  return QString::fromLatin1(buf, static_cast<int>(disassemble(buf)));
+}
+
+size_t Disassembler::disassemble(char* buf) const {
+  const auto& t = LineTemplates[opcode];
+  const uint8_t lo = memory[static_cast<Address>(address + 1)];
+  const uint8_t hi = memory[static_cast<Address>(address + 2)];
+
+  // all three bytes are written and the unused ones blanked, avoiding branches on instruction size
+  writeHexByte(buf, opcode);
+  writeHexByte(buf + 3, lo);
+  writeHexByte(buf + 6, hi);
+  buf[2] = buf[5] = ' ';
+  std::memcpy(buf + 3 * instruction.size - 1, "        ", 8);
+
+  char* p = writeChars(buf + 10, t.head, t.headLength);
+  if (t.operand == OperandKind::Displacement) {
+    p = writeDisplacement(p, static_cast<int8_t>(lo));
+  } else {
+    writeHexByte(p, hi);
+    p += t.operandHiLength;
+    writeHexByte(p, lo);
+    p += t.operandLoLength;
+  }
+  p = writeChars(p, t.tail, t.tailLength);
+  *p = 0;
+  return static_cast<size_t>(p - buf);
+}
+
+size_t Disassembler::disassembleData(char* buf, uint8_t count) const {
+  std::memcpy(buf, "          .BYTE ", 16);
+  char* p = buf + 16;
+  for (uint8_t i = 0; i < count; i++) {
+    const auto b = memory[static_cast<Address>(address + i)];
+    writeHexByte(buf + 3 * i, b);
+    if (i) *p++ = ',';
+    *p++ = '$';
+    p = writeHexByte(p, b);
   }
-  return str.toUpper();
+  *p = 0;
+  return static_cast<size_t>(p - buf);
 }
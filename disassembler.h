@@ -1,11 +1,15 @@
 #pragma once
 
+#include "addressrange.h"
 #include "instruction.h"
 #include "memory.h"
 #include <QString>
 
 class Disassembler {
 public:
+  // enough for the longest line, e.g. "6C 34 12  JMP ($1234)", including terminating NUL
+  static constexpr size_t MaxLineLength = 32;
+
   Disassembler(const Memory&, Address addr = 0);
 
   void setOrigin(Address);
@@ -15,6 +19,15 @@ public:
   QString dumpBytes(uint16_t n = 1) const;
   QString dumpWords(uint16_t n = 1) const;
   QString disassemble() const;
+  size_t disassemble(char* buf) const;
+
+  // formats 1 to MaxDataBytes bytes at the current address as a .BYTE line
+  static constexpr uint8_t MaxDataBytes = 3;
+  size_t disassembleData(char* buf, uint8_t count) const;
+
+  // calls sink(Address, const char* line, size_t length) for every instruction starting within range
+  template <typename Sink>
+  void disassembleRange(AddressRange range, Sink&& sink);
 
 private:
   const Memory& memory;
@@ -25,3 +38,12 @@ private:
   QString formatOperand8() const;
   QString formatOperand16() const;
 };
+
+template <typename Sink>
+void Disassembler::disassembleRange(AddressRange range, Sink&& sink) {
+  char buf[MaxLineLength];
+  for (uint32_t addr = range.first; addr <= range.last; addr += instruction.size) {
+    setOrigin(static_cast<Address>(addr));
+    sink(address, static_cast<const char*>(buf), disassemble(buf));
+  }
+}
@@ -1,17 +1,15 @@
 #include "disassemblerview.h"
 #include "commonformatters.h"
-#include "ui_disassemblerview.h"
 #include "uitools.h"
+#include <QPainter>
 #include <QResizeEvent>
+#include <QWheelEvent>
 
-DisassemblerView::DisassemblerView(QWidget* parent, const Memory& memory, HighlightMode highlight)
-    : QWidget(parent), ui(new Ui::DisassemblerView), disassembler(memory), highlightMode(highlight) {
-  ui->setupUi(this);
-  setMonospaceFont(ui->view);
-}
-
-DisassemblerView::~DisassemblerView() {
-  delete ui;
+DisassemblerView::DisassemblerView(QWidget* parent, const Memory& memory, CodeAnalyzer& analyzer, HighlightMode highlight)
+    : QWidget(parent), cache(memory, analyzer), highlightMode(highlight) {
+  setFont(QFont("Courier"));
+  setMonospaceFont(this);
+  setAttribute(Qt::WA_OpaquePaintEvent);
 }
 
 Address DisassemblerView::last() const {
@@ -26,14 +24,26 @@ uint16_t DisassemblerView::first() const {
   return addressRange.first;
 }
 
+void DisassemblerView::addEntryPoint(Address addr) {
+  cache.addEntryPoint(addr);
+}
+
+void DisassemblerView::clearEntryPoints() {
+  cache.clearEntryPoints();
+  if (cache.refresh()) updateView();
+}
+
 void DisassemblerView::updateMemoryView(AddressRange range) {
-  if (range.overlapsWith(range)) updateView();
+  cache.invalidate(range);
+  // a write far from the visible rows may still turn them from code into data or back
+  if (cache.refresh() || addressRange.overlapsWith(range)) updateView();
 }
 
 void DisassemblerView::changeStart(Address addr) {
   if (addressRange.first != addr) {
     addressRange.first = addr;
     updateView();
+    emit startChanged(addr);
   }
 }
 
@@ -45,42 +55,93 @@ void DisassemblerView::changeSelected(Address addr) {
 }
 
 void DisassemblerView::updateView() {
-  disassembler.setOrigin(addressRange.first);
-  QString html("<div style='white-space:pre; display:inline-block'>");
-  int rows = rowsInView();
-  while (rows--) {
-    auto hl = shouldHighlightCurrentAddress();
-    html.append(hl ? "<div style='color:black; background-color: lightgreen'>" : "<div style='color:darkseagreen'>");
-    html.append(hl ? "<span style='color:black'>" : "<span style='color:gray'>");
-    html.append(formatHexWord(disassembler.currentAddress()).toUpper());
-    html.append("</span> ");
-    html.append(disassembler.disassemble());
-    html.append("</div>");
-    disassembler.nextInstruction();
+  cache.refresh();
+  const auto numRows = static_cast<size_t>(rowsInView());
+  if (rows.size() != numRows) {
+    rows.resize(numRows);
+    update();
   }
-  html.append("</div>");
-  ui->view->setHtml(html);
-  addressRange.last = disassembler.currentAddress();
+
+  auto addr = addressRange.first;
+  for (size_t i = 0; i < rows.size(); i++) {
+    const Row row{addr, cache.line(addr), shouldHighlight(addr)};
+    if (rows[i] != row) {
+      rows[i] = row;
+      update(rowRect(static_cast<int>(i)));
+    }
+    addr = cache.nextAddress(addr);
+  }
+  addressRange.last = addr < addressRange.first ? 0xffff : addr;
 }
 
 void DisassemblerView::nextInstruction() {
-  disassembler.setOrigin(addressRange.first);
-  disassembler.nextInstruction();
-  changeStart(disassembler.currentAddress());
+  changeStart(cache.nextAddress(addressRange.first));
+}
+
+void DisassemblerView::previousInstruction() {
+  changeStart(cache.previousAddress(addressRange.first));
+}
+
+void DisassemblerView::scrollBy(int numRows) {
+  const auto& index = cache.index();
+  auto addr = addressRange.first;
+  if (numRows < 0 && !index.isRowStart(addr)) {
+    addr = cache.previousAddress(addr);
+    numRows++;
+  }
+  const auto row = std::clamp(index.rowOf(addr) + numRows, 0, index.rows() - 1);
+  changeStart(index.rowAddress(row));
+}
+
+void DisassemblerView::paintEvent(QPaintEvent* event) {
+  QPainter painter(this);
+  painter.fillRect(event->rect(), palette().color(backgroundRole()));
+  painter.setFont(font());
+  for (size_t i = 0; i < rows.size(); i++) {
+    if (event->region().intersects(rowRect(static_cast<int>(i)))) drawRow(painter, static_cast<int>(i));
+  }
 }
 
 void DisassemblerView::resizeEvent(QResizeEvent* event) {
   if (event->size().height() != event->oldSize().height()) { updateView(); }
 }
 
+void DisassemblerView::wheelEvent(QWheelEvent* event) {
+  // the first row follows the program counter in that mode, so it is not scrolled away from it
+  if (highlightMode == HighlightMode::First) return QWidget::wheelEvent(event);
+
+  const auto steps = event->angleDelta().y() / 40;
+  if (steps) scrollBy(-steps);
+  event->accept();
+}
+
 int DisassemblerView::rowsInView() const {
-  return 6 + ui->view->height() / ui->view->fontMetrics().height();
+  return 1 + height() / rowHeight();
 }
 
-bool DisassemblerView::shouldHighlightCurrentAddress() const {
-  if (highlightMode == HighlightMode::None) return false;
+int DisassemblerView::rowHeight() const {
+  return fontMetrics().height();
+}
+
+QRect DisassemblerView::rowRect(int row) const {
+  return {0, row * rowHeight(), width(), rowHeight()};
+}
 
-  const auto addr = disassembler.currentAddress();
+bool DisassemblerView::shouldHighlight(Address addr) const {
   return (highlightMode == HighlightMode::First && addr == addressRange.first) ||
          (highlightMode == HighlightMode::Selected && addr == selectedAddress);
 }
+
+void DisassemblerView::drawRow(QPainter& painter, int index) const {
+  const auto& row = rows[static_cast<size_t>(index)];
+  const auto rect = rowRect(index);
+  const auto baseline = rect.top() + fontMetrics().ascent();
+  const auto addressStr = formatHexWord(row.address).toUpper() + " ";
+  const auto textX = fontMetrics().horizontalAdvance(addressStr);
+
+  if (row.highlighted) painter.fillRect(rect, QColor("lightgreen"));
+  painter.setPen(row.highlighted ? QColor(Qt::black) : QColor(Qt::gray));
+  painter.drawText(0, baseline, addressStr);
+  painter.setPen(row.highlighted ? QColor(Qt::black) : QColor("darkseagreen"));
+  painter.drawText(textX, baseline, row.text);
+}
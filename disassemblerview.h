@@ -3,13 +3,10 @@
 
 #include "addressrange.h"
 #include "commondefs.h"
-#include "disassembler.h"
+#include "disassemblycache.h"
 #include "memory.h"
 #include <QWidget>
-
-namespace Ui {
-class DisassemblerView;
-}
+#include <vector>
 
 class DisassemblerView : public QWidget
 {
@@ -18,11 +15,15 @@ class DisassemblerView : public QWidget
 public:
   enum class HighlightMode { None, First, Selected };
 
-  explicit DisassemblerView(QWidget* parent, const Memory& memory, HighlightMode highligt = HighlightMode::First);
-  ~DisassemblerView() override;
+  DisassemblerView(QWidget* parent, const Memory& memory, CodeAnalyzer&, HighlightMode highligt = HighlightMode::First);
   Address first() const;
   Address last() const;
   Address selected() const;
+  void addEntryPoint(Address);
+  void clearEntryPoints();
+
+signals:
+  void startChanged(Address);
 
 public slots:
   void updateMemoryView(AddressRange);
@@ -30,20 +31,35 @@ public slots:
   void changeSelected(Address);
   void updateView();
   void nextInstruction();
+  void previousInstruction();
+  void scrollBy(int rows);
 
 protected:
+  void paintEvent(QPaintEvent*) override;
   void resizeEvent(QResizeEvent*) override;
+  void wheelEvent(QWheelEvent*) override;
 
 private:
-  Ui::DisassemblerView* ui;
+  struct Row {
+    Address address;
+    QString text;
+    bool highlighted;
+
+    bool operator==(const Row& r) const { return address == r.address && highlighted == r.highlighted && text == r.text; }
+    bool operator!=(const Row& r) const { return !(*this == r); }
+  };
 
-  Disassembler disassembler;
+  DisassemblyCache cache;
   AddressRange addressRange = AddressRange::Invalid;
   Address selectedAddress;
   HighlightMode highlightMode;
+  std::vector<Row> rows;
 
   int rowsInView() const;
-  bool shouldHighlightCurrentAddress() const;
+  int rowHeight() const;
+  QRect rowRect(int row) const;
+  bool shouldHighlight(Address) const;
+  void drawRow(QPainter&, int row) const;
 };
 
 #endif // DISASSEMBLERVIEW_H
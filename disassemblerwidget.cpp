@@ -3,12 +3,14 @@
 #include "uitools.h"
 #include <QVBoxLayout>
 
-DisassemblerWidget::DisassemblerWidget(QWidget* parent, const Memory& memory) : QWidget(parent), ui(new Ui::DisassemblerWidget) {
+DisassemblerWidget::DisassemblerWidget(QWidget* parent, const Memory& memory, CodeAnalyzer& analyzer)
+    : QWidget(parent), ui(new Ui::DisassemblerWidget) {
   ui->setupUi(this);
 
-  view = new DisassemblerView(this, memory, DisassemblerView::HighlightMode::Selected);
+  view = new DisassemblerView(this, memory, analyzer, DisassemblerView::HighlightMode::Selected);
   layout()->addWidget(view);
   connect(ui->startAddress, QOverload<int>::of(&QSpinBox::valueChanged), view, &DisassemblerView::changeStart);
+  connect(view, &DisassemblerView::startChanged, ui->startAddress, &QSpinBox::setValue);
   connect(ui->goToStart, &QAbstractButton::clicked, [&] { emit goToStartClicked(view->first()); });
   connect(ui->goToSelection, &QAbstractButton::clicked, [&] { ui->startAddress->setValue(view->selected()); });
   view->changeStart(static_cast<Address>(ui->startAddress->value()));
@@ -19,9 +21,14 @@ DisassemblerWidget::~DisassemblerWidget() {
 }
 
 void DisassemblerWidget::updateState(EmulatorState state) {
+  view->addEntryPoint(state.regs.pc);
   view->changeSelected(state.regs.pc);
 }
 
 void DisassemblerWidget::updateOnChange(AddressRange range) {
   view->updateMemoryView(range);
 }
+
+void DisassemblerWidget::clearEntryPoints() {
+  view->clearEntryPoints();
+}
@@ -16,7 +16,7 @@ class DisassemblerWidget : public QWidget
   Q_OBJECT
 
 public:
-  explicit DisassemblerWidget(QWidget* parent, const Memory&);
+  DisassemblerWidget(QWidget* parent, const Memory&, CodeAnalyzer&);
   ~DisassemblerWidget();
 
 signals:
@@ -25,6 +25,7 @@ signals:
 public slots:
   void updateState(EmulatorState);
   void updateOnChange(AddressRange);
+  void clearEntryPoints();
 
 private:
   Ui::DisassemblerWidget* ui;
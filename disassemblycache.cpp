@@ -0,0 +1,65 @@
+#include "disassemblycache.h"
+#include "instructiontable.h"
+
+DisassemblyCache::DisassemblyCache(const Memory& memory, CodeAnalyzer& analyzer)
+    : memory(memory), disassembler(memory), analyzer(analyzer), listingIndex(memory, analyzer),
+      indexedGeneration(analyzer.generation()) {
+  refresh();
+}
+
+const QString& DisassemblyCache::line(Address addr) {
+  const auto bytes = bytesAt(addr);
+  const auto dataBytes = dataBytesAt(addr);
+  auto& entry = entries[addr];
+  if (entry.text.isEmpty() || entry.bytes != bytes || entry.dataBytes != dataBytes) {
+    char buf[Disassembler::MaxLineLength];
+    disassembler.setOrigin(addr);
+    entry.bytes = bytes;
+    entry.dataBytes = dataBytes;
+    const auto length = dataBytes ? disassembler.disassembleData(buf, dataBytes) : disassembler.disassemble(buf);
+    entry.text = QString::fromLatin1(buf, static_cast<int>(length));
+  }
+  return entry.text;
+}
+
+// lines not starting at a row of the index (e.g. a start address chosen by the user) are decoded linearly
+// until they meet one
+Address DisassemblyCache::nextAddress(Address addr) const {
+  if (!listingIndex.isRowStart(addr)) return static_cast<Address>(addr + InstructionTable[memory[addr]].size);
+
+  const auto row = listingIndex.rowOf(addr) + 1;
+  return row < listingIndex.rows() ? listingIndex.rowAddress(row) : 0;
+}
+
+Address DisassemblyCache::previousAddress(Address addr) const {
+  const auto row = listingIndex.rowOf(addr);
+  if (!listingIndex.isRowStart(addr)) return listingIndex.rowAddress(row);
+
+  return listingIndex.rowAddress(row ? row - 1 : listingIndex.rows() - 1);
+}
+
+// the analysis may have been run for another view, which may also have run one this view has not seen
+bool DisassemblyCache::refresh() {
+  analyzer.update();
+  const auto generation = analyzer.generation();
+  if (generation == indexedGeneration) return false;
+
+  if (generation == indexedGeneration + 1)
+    listingIndex.update(analyzer.changedRange());
+  else
+    listingIndex.rebuild();
+  indexedGeneration = generation;
+  return true;
+}
+
+std::array<uint8_t, 3> DisassemblyCache::bytesAt(Address addr) const {
+  return {memory[addr], memory[static_cast<Address>(addr + 1)], memory[static_cast<Address>(addr + 2)]};
+}
+
+// number of bytes shown as a data line at addr, or 0 if an instruction is shown there
+uint8_t DisassemblyCache::dataBytesAt(Address addr) const {
+  if (!listingIndex.isRowStart(addr)) return 0;
+
+  const auto row = listingIndex.rowOf(addr);
+  return listingIndex.isDataRow(row) ? listingIndex.rowLength(row) : 0;
+}
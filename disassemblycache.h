@@ -0,0 +1,44 @@
+#pragma once
+
+#include "codeanalyzer.h"
+#include "disassembler.h"
+#include "listingindex.h"
+#include "memory.h"
+#include <QString>
+#include <array>
+#include <unordered_map>
+
+// The rows of one view, over the code analysis shared by all views of the memory
+class DisassemblyCache {
+public:
+  DisassemblyCache(const Memory&, CodeAnalyzer&);
+
+  const QString& line(Address);
+  Address nextAddress(Address) const;
+  Address previousAddress(Address) const;
+  const ListingIndex& index() const { return listingIndex; }
+
+  void addEntryPoint(Address addr) { analyzer.addEntryPoint(addr); }
+  void clearEntryPoints() { analyzer.clearEntryPoints(); }
+  void invalidate(AddressRange range) { analyzer.invalidate(range); }
+
+  // returns true if the listing rows have been redone, as the classification changed since the last refresh
+  bool refresh();
+
+private:
+  struct Entry {
+    std::array<uint8_t, 3> bytes;
+    uint8_t dataBytes;
+    QString text;
+  };
+
+  const Memory& memory;
+  Disassembler disassembler;
+  CodeAnalyzer& analyzer;
+  ListingIndex listingIndex;
+  uint32_t indexedGeneration; // of the analysis
+  std::unordered_map<Address, Entry> entries;
+
+  std::array<uint8_t, 3> bytesAt(Address) const;
+  uint8_t dataBytesAt(Address) const;
+};
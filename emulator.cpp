@@ -69,10 +69,58 @@ void Emulator::stopExecution() {
   emit stateChanged(state());
 }
 
-void Emulator::execute(bool continuous, Frequency clock) {
+void Emulator::setDefaultFrameBuffer(Address addr) {
+  defaultFrameBuffer = addr;
+}
+
+void Emulator::commitPatch(const MemoryPatch& patch) {
+  {
+    std::lock_guard<std::mutex> lock(patchMutex);
+    pendingPatches.push_back(patch);
+  }
+  QMetaObject::invokeMethod(this, [this] { applyPendingPatches(); }, Qt::QueuedConnection);
+}
+
+void Emulator::setPatchWhileRunning(bool allowed) {
+  patchWhileRunning = allowed;
+}
+
+// runs between instructions, so the CPU never executes partially patched code
+void Emulator::applyPendingPatches() {
+  std::vector<MemoryPatch> patches;
+  {
+    std::lock_guard<std::mutex> lock(patchMutex);
+    patches.swap(pendingPatches);
+  }
+
+  AddressRange range;
+  for (const auto& patch : patches) {
+    patch.applyTo(memory);
+    if (const auto r = patch.range(); r.valid()) {
+      range.expand(r.first);
+      range.expand(r.last);
+    }
+  }
+  if (range.valid()) emit memoryContentChanged(range);
+}
+
+void Emulator::execute(bool continuous, Frequency clock, FramePacing pacing) {
   QSignalBlocker sb(this);
   const auto exs0 = cpu.info().executionStatistics;
-  cpu.execute(continuous, std::chrono::duration_cast<Duration>(std::chrono::duration<double>(1.0 / clock)));
+  if (continuous && pacing.enabled()) {
+    // a frame is rendered once per frame period, between instructions, so views never see it half drawn
+    cpu.executeFrames(clock, pacing, [&] {
+      // unblocked first, so the views hear of the patched range while the run goes on
+      sb.unblock();
+      if (patchWhileRunning) applyPendingPatches();
+      videoDevice.setDefaultFrameBuffer(defaultFrameBuffer);
+      const auto& pixels = videoDevice.render(memory);
+      emit frameReady(pixels, videoDevice.width(), videoDevice.height());
+      sb.reblock();
+    });
+  } else {
+    cpu.execute(continuous, std::chrono::duration_cast<Duration>(std::chrono::duration<double>(1.0 / clock)));
+  }
   const auto exs1 = cpu.info().executionStatistics;
   sb.unblock();
   emit stateChanged(state(exs1 - exs0));
@@ -4,8 +4,13 @@
 #include "commondefs.h"
 #include "cpu.h"
 #include "emulatorstate.h"
+#include "framepacing.h"
 #include "memory.h"
+#include "memorypatch.h"
+#include "videodevice.h"
 #include <QObject>
+#include <atomic>
+#include <mutex>
 
 class Emulator : public QObject {
   Q_OBJECT
@@ -13,16 +18,16 @@ class Emulator : public QObject {
 public:
   explicit Emulator(QObject* parent = nullptr);
   const Memory& memoryView() const { return memory; }
-  Memory& memoryRef() { return memory; }
   const EmulatorState state(ExecutionStatistics = {});
 
 signals:
   void stateChanged(EmulatorState);
   void memoryContentChanged(AddressRange);
   void operationCompleted(const QString& message, bool success);
+  void frameReady(const Data& pixels, int width, int height);
 
 public slots:
-  void execute(bool continuous, Frequency clock);
+  void execute(bool continuous, Frequency clock, FramePacing = {});
   void changeProgramCounter(Address);
   void changeStackPointer(Address);
   void changeAccumulator(uint8_t);
@@ -40,8 +45,20 @@ public slots:
   void triggerReset();
   void stopExecution();
   void clearStatistics();
+  void setDefaultFrameBuffer(Address);
+
+  // applied on the emulator thread once the CPU is parked, or between frames if allowed
+  void commitPatch(const MemoryPatch&);
+  void setPatchWhileRunning(bool);
 
 private:
   Memory memory;
   Cpu cpu;
+  std::atomic<Address> defaultFrameBuffer{0x200};
+  VideoDevice videoDevice;
+  std::atomic<bool> patchWhileRunning{false};
+  std::mutex patchMutex;
+  std::vector<MemoryPatch> pendingPatches;
+
+  void applyPendingPatches();
 };
@@ -14,6 +14,8 @@ struct ExecutionStatistics {
   double clockMHz() const { return cycles / microSec(); }
 
   ExecutionStatistics operator-(const ExecutionStatistics& e) const { return {cycles - e.cycles, duration - e.duration}; }
+  bool operator==(const ExecutionStatistics& e) const { return cycles == e.cycles && duration == e.duration; }
+  bool operator!=(const ExecutionStatistics& e) const { return !(*this == e); }
 };
 
 QString formatExecutionStatistics(ExecutionStatistics es);
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "commondefs.h"
+
+enum class VBlankInterrupt : uint8_t { None, Irq, Nmi };
+
+struct FramePacing {
+  Frequency frameRate = 0; // no frames, execution throttled per instruction
+  VBlankInterrupt interrupt = VBlankInterrupt::None;
+  bool throttled = true; // false runs the frames back to back, e.g. for a headless capture
+
+  bool enabled() const { return frameRate > 0; }
+  long cyclesPerFrame(Frequency clock) const { return std::max(1L, static_cast<long>(clock / frameRate)); }
+  Duration period() const { return std::chrono::duration_cast<Duration>(std::chrono::duration<double>(1.0 / frameRate)); }
+};
@@ -0,0 +1,174 @@
+#include "framerecorder.h"
+#include <cstdio>
+#include <cstring>
+
+FrameRecorder::~FrameRecorder() {
+  stop();
+}
+
+uint64_t FrameRecorder::hash(const uint8_t* pixels, int width, int height) {
+  const auto size = static_cast<size_t>(width * height);
+  uint64_t h = 0x9e3779b97f4a7c15 ^ (static_cast<uint64_t>(width) << 32 | static_cast<uint64_t>(height));
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    uint64_t word;
+    std::memcpy(&word, pixels + i, sizeof word);
+    h = (h ^ word) * 0xff51afd7ed558ccd;
+    h ^= h >> 32;
+  }
+  uint64_t tail = 0;
+  std::memcpy(&tail, pixels + i, size - i);
+  h = (h ^ tail) * 0xc4ceb9fe1a85ec53;
+  return h ^ (h >> 29);
+}
+
+std::vector<uint64_t> FrameRecorder::readHashLog(const QString& fileName) {
+  std::vector<uint64_t> hashes;
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return hashes;
+
+  while (!file.atEnd()) {
+    const auto line = file.readLine();
+    unsigned long long frame, h;
+    if (std::sscanf(line.constData(), "%llu %llx", &frame, &h) != 2) continue;
+    if (frame >= hashes.size()) hashes.resize(frame + 1);
+    hashes[frame] = h;
+  }
+  return hashes;
+}
+
+bool FrameRecorder::start(const CaptureOptions& opts) {
+  stop();
+  options = opts;
+  result = {};
+  videoWidth = videoHeight = 0;
+  finishing = false;
+  framesAdded = 0;
+  golden = options.goldenFileName.isEmpty() ? std::vector<uint64_t>() : readHashLog(options.goldenFileName);
+  if (!options.goldenFileName.isEmpty() && golden.empty()) {
+    result.error = "unable to read " + options.goldenFileName;
+    return false;
+  }
+
+  if (!options.videoFileName.isEmpty()) {
+    y4m = options.videoFileName.endsWith(".y4m", Qt::CaseInsensitive);
+    videoFile.setFileName(options.videoFileName);
+    if (!videoFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+      result.error = "unable to create " + options.videoFileName;
+      return false;
+    }
+    if (!y4m) videoFile.write(RawFileMagic, sizeof RawFileMagic);
+  }
+
+  if (!options.hashLogFileName.isEmpty()) {
+    hashLogFile.setFileName(options.hashLogFileName);
+    if (!hashLogFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+      videoFile.close();
+      result.error = "unable to create " + options.hashLogFileName;
+      return false;
+    }
+  }
+
+  writer = std::thread(&FrameRecorder::run, this);
+  return true;
+}
+
+void FrameRecorder::addFrame(const Data& pixels, int width, int height) {
+  if (!recording() || pixels.size() != static_cast<size_t>(width * height)) return;
+
+  std::unique_lock<std::mutex> lock(mutex);
+  const auto number = framesAdded++;
+  if (options.waitWhenBehind) {
+    queueChanged.wait(lock, [&] { return queue.size() < options.maxQueuedFrames; });
+  } else if (queue.size() >= options.maxQueuedFrames) {
+    // a slow disk must not stall the GUI thread that presents the frames
+    result.droppedFrames++;
+    return;
+  }
+  queue.push_back({number, pixels, width, height});
+  queueChanged.notify_all();
+}
+
+CaptureSummary FrameRecorder::stop() {
+  if (!recording()) return result;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    finishing = true;
+  }
+  queueChanged.notify_all();
+  writer.join();
+  videoFile.close();
+  hashLogFile.close();
+  return result;
+}
+
+void FrameRecorder::run() {
+  for (;;) {
+    Frame frame;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      queueChanged.wait(lock, [&] { return !queue.empty() || finishing; });
+      if (queue.empty()) return;
+
+      frame = std::move(queue.front());
+      queue.pop_front();
+    }
+    queueChanged.notify_all();
+    write(frame);
+  }
+}
+
+void FrameRecorder::write(const Frame& frame) {
+  const auto number = frame.number;
+  result.frames++;
+  const auto h = hash(frame.pixels.data(), frame.width, frame.height);
+
+  if (hashLogFile.isOpen()) {
+    char line[48];
+    const auto length = std::snprintf(line, sizeof line, "%llu %016llx\n", static_cast<unsigned long long>(number),
+                                      static_cast<unsigned long long>(h));
+    hashLogFile.write(line, length);
+  }
+
+  bool mismatch = false;
+  if (!golden.empty()) {
+    mismatch = number >= golden.size() || golden[number] != h;
+    if (mismatch) {
+      if (!result.mismatches++) result.firstMismatch = static_cast<int64_t>(number);
+    }
+  }
+
+  if (videoFile.isOpen() && (mismatch || !options.onlyMismatches)) writeVideoFrame(frame);
+}
+
+void FrameRecorder::writeVideoFrame(const Frame& frame) {
+  if (y4m) {
+    if (!videoWidth) {
+      videoWidth = frame.width;
+      videoHeight = frame.height;
+      char header[80];
+      const auto length = std::snprintf(header, sizeof header, "YUV4MPEG2 W%d H%d F%u:1 Ip A1:1 Cmono\n", videoWidth,
+                                        videoHeight, options.frameRate);
+      videoFile.write(header, length);
+    }
+    if (frame.width != videoWidth || frame.height != videoHeight) {
+      result.skippedFrames++;
+      return;
+    }
+    videoFile.write("FRAME\n", 6);
+    videoFile.write(reinterpret_cast<const char*>(frame.pixels.data()), static_cast<qint64>(frame.pixels.size()));
+    return;
+  }
+
+  // frame number, width, height and compressed size as little endian 32 bit words, then compressed indices
+  const auto compressed = qCompress(frame.pixels.data(), static_cast<int>(frame.pixels.size()));
+  const uint32_t fields[] = {static_cast<uint32_t>(frame.number), static_cast<uint32_t>(frame.width),
+                             static_cast<uint32_t>(frame.height), static_cast<uint32_t>(compressed.size())};
+  for (const auto field : fields) {
+    const char bytes[] = {static_cast<char>(field), static_cast<char>(field >> 8), static_cast<char>(field >> 16),
+                          static_cast<char>(field >> 24)};
+    videoFile.write(bytes, sizeof bytes);
+  }
+  videoFile.write(compressed);
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "commondefs.h"
+#include <QFile>
+#include <QString>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+struct CaptureOptions {
+  QString videoFileName; // *.y4m for a greyscale stream of palette indices, otherwise compressed raw frames
+  QString hashLogFileName;
+  QString goldenFileName; // hash log of an earlier run to compare with
+  bool onlyMismatches = false; // write only video frames differing from the golden run
+  Frequency frameRate = 60;
+  size_t maxQueuedFrames = 120; // frames waiting for the disk, beyond that they are dropped
+  bool waitWhenBehind = false; // block the producer instead of dropping, for runs off the GUI thread that compare every frame
+};
+
+struct CaptureSummary {
+  uint64_t frames = 0;
+  uint64_t mismatches = 0;
+  int64_t firstMismatch = -1;
+  uint64_t skippedFrames = 0; // frames of a size other than the first one, Y4M only
+  uint64_t droppedFrames = 0; // frames that came while the queue was full, their numbers are missing from the outputs
+  QString error;
+
+  bool ok() const { return error.isEmpty(); }
+};
+
+// Streams frames of palette indices to disk on a background thread, logging a hash per frame
+class FrameRecorder {
+public:
+  static constexpr char RawFileMagic[8] = {'M', 'O', '6', '5', 'X', 'R', 'A', 'W'};
+
+  static uint64_t hash(const uint8_t* pixels, int width, int height);
+  static std::vector<uint64_t> readHashLog(const QString& fileName);
+
+  FrameRecorder() = default;
+  ~FrameRecorder();
+
+  bool start(const CaptureOptions&);
+  bool recording() const { return writer.joinable(); }
+  void addFrame(const Data& pixels, int width, int height);
+  CaptureSummary stop();
+  const CaptureSummary& summary() const { return result; }
+
+private:
+  struct Frame {
+    uint64_t number;
+    Data pixels;
+    int width;
+    int height;
+  };
+
+  CaptureOptions options;
+  CaptureSummary result;
+  QFile videoFile;
+  QFile hashLogFile;
+  std::vector<uint64_t> golden;
+  bool y4m = false;
+  int videoWidth = 0;
+  int videoHeight = 0;
+
+  std::thread writer;
+  std::mutex mutex;
+  std::condition_variable queueChanged;
+  std::deque<Frame> queue;
+  uint64_t framesAdded = 0;
+  bool finishing = false;
+
+  void run();
+  void write(const Frame&);
+  void writeVideoFrame(const Frame&);
+};
@@ -0,0 +1,31 @@
+#include "headlesscapture.h"
+#include "cpu.h"
+#include "videodevice.h"
+
+HeadlessCapture::HeadlessCapture(Memory& memory) : memory(memory) {
+}
+
+CaptureSummary HeadlessCapture::run(const Options& options) {
+  auto capture = options.capture;
+  capture.frameRate = options.pacing.frameRate;
+  // nothing presents the frames, so the run waits for the disk rather than lose any
+  capture.waitWhenBehind = true;
+  FrameRecorder recorder;
+  if (!options.frames || !options.pacing.enabled() || !recorder.start(capture)) return recorder.summary();
+
+  Cpu cpu(memory);
+  cpu.reset();
+  cpu.regs.pc = options.start;
+  VideoDevice videoDevice;
+  videoDevice.setDefaultFrameBuffer(options.defaultFrameBuffer);
+
+  auto pacing = options.pacing;
+  pacing.throttled = false;
+  uint64_t frames = 0;
+  cpu.executeFrames(options.clock, pacing, [&] {
+    const auto& pixels = videoDevice.render(memory);
+    recorder.addFrame(pixels, videoDevice.width(), videoDevice.height());
+    if (++frames == options.frames) cpu.stopExecution();
+  });
+  return recorder.stop();
+}
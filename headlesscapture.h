@@ -0,0 +1,27 @@
+#pragma once
+
+#include "framepacing.h"
+#include "framerecorder.h"
+#include "memory.h"
+
+// Runs a program without the GUI for a number of frames, back to back, recording every frame rendered in between,
+// e.g. to compare a run against the hash log of a golden one in a regression pipeline
+class HeadlessCapture {
+public:
+  struct Options {
+    Address start = 0;
+    uint64_t frames = 0;
+    Frequency clock = 1000000;
+    FramePacing pacing{60, VBlankInterrupt::None};
+    Address defaultFrameBuffer = 0x200;
+    CaptureOptions capture; // the frame rate is the one of the pacing
+  };
+
+  explicit HeadlessCapture(Memory&);
+
+  // stops early when the program halts, the summary then has fewer frames than asked for
+  CaptureSummary run(const Options&);
+
+private:
+  Memory& memory;
+};
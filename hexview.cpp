@@ -0,0 +1,158 @@
+#include "hexview.h"
+#include "uitools.h"
+#include <QFont>
+#include <QPainter>
+#include <QResizeEvent>
+
+static constexpr auto AddressGlyphs = 4;
+static constexpr auto AddressColumnGlyphs = AddressGlyphs + 2;
+static constexpr auto ByteColumnGlyphs = 3;
+static constexpr char HexDigits[] = "0123456789ABCDEF";
+
+HexView::HexView(QWidget* parent, const Memory& memory) : QWidget(parent), memory(memory) {
+  setFont(QFont("Courier"));
+  setMonospaceFont(this);
+  setAttribute(Qt::WA_OpaquePaintEvent);
+  setSizePolicy(QSizePolicy::MinimumExpanding, QSizePolicy::MinimumExpanding);
+  renderGlyphAtlas();
+  decayTimer.setInterval(TickInterval);
+  connect(&decayTimer, &QTimer::timeout, this, &HexView::decay);
+}
+
+Address HexView::last() const {
+  return static_cast<Address>(firstAddress + std::max(bytesInView(), 1) - 1);
+}
+
+bool HexView::shows(AddressRange range) const {
+  const auto parts = AddressRange::wrapping(firstAddress, static_cast<size_t>(std::max(bytesInView(), 1)));
+  return std::any_of(parts.begin(), parts.end(), [&](auto part) { return part.overlapsWith(range); });
+}
+
+void HexView::changeStart(Address addr) {
+  if (firstAddress != addr) {
+    firstAddress = addr;
+    snapshot();
+    update();
+    emit visibleRangeChanged(first(), last());
+  }
+}
+
+void HexView::refresh() {
+  int firstDirtyRow = rows;
+  int lastDirtyRow = -1;
+  for (int i = 0; i < bytesInView(); i++) {
+    const auto b = memory[static_cast<Address>(firstAddress + i)];
+    if (shadow[i] == b) continue;
+
+    shadow[i] = b;
+    if (!heat[i]) hotBytes++;
+    heat[i] = HighlightTicks;
+    firstDirtyRow = std::min(firstDirtyRow, i / cols);
+    lastDirtyRow = i / cols;
+  }
+  if (hotBytes && !decayTimer.isActive()) decayTimer.start();
+  updateRows(firstDirtyRow, lastDirtyRow);
+}
+
+void HexView::decay() {
+  int firstDirtyRow = rows;
+  int lastDirtyRow = -1;
+  for (int i = 0; i < bytesInView(); i++) {
+    if (!heat[i] || --heat[i]) continue;
+
+    hotBytes--;
+    firstDirtyRow = std::min(firstDirtyRow, i / cols);
+    lastDirtyRow = i / cols;
+  }
+  if (!hotBytes) decayTimer.stop();
+  updateRows(firstDirtyRow, lastDirtyRow);
+}
+
+void HexView::updateRows(int firstRow, int lastRow) {
+  for (int row = firstRow; row <= lastRow; row++) update(rowRect(row));
+}
+
+void HexView::paintEvent(QPaintEvent* event) {
+  QPainter painter(this);
+  painter.fillRect(event->rect(), palette().color(backgroundRole()));
+  for (int row = 0; row < rows; row++) {
+    if (event->region().intersects(rowRect(row))) drawRow(painter, row);
+  }
+}
+
+void HexView::resizeEvent(QResizeEvent* event) {
+  if (event->size() != event->oldSize()) {
+    relayout();
+    emit visibleRangeChanged(first(), last());
+  }
+}
+
+void HexView::changeEvent(QEvent* event) {
+  const auto type = event->type();
+  if (type == QEvent::FontChange || type == QEvent::PaletteChange || type == QEvent::StyleChange) {
+    renderGlyphAtlas();
+    relayout();
+  }
+  QWidget::changeEvent(event);
+}
+
+void HexView::renderGlyphAtlas() {
+  const QFontMetrics fm = fontMetrics();
+  glyphWidth = fm.horizontalAdvance('0');
+  glyphHeight = fm.height();
+  glyphAtlas = QPixmap(glyphWidth * 16, glyphHeight * NumberOfGlyphStyles);
+
+  const QColor background = palette().color(backgroundRole());
+  const std::pair<QColor, QColor> styles[NumberOfGlyphStyles] = {
+      {Qt::gray, background}, {QColor("lightgreen"), background}, {Qt::black, QColor("orange")}};
+
+  QPainter painter(&glyphAtlas);
+  painter.setFont(font());
+  for (int style = 0; style < NumberOfGlyphStyles; style++) {
+    const auto [foreground, fill] = styles[style];
+    painter.fillRect(0, style * glyphHeight, glyphAtlas.width(), glyphHeight, fill);
+    painter.setPen(foreground);
+    for (int nibble = 0; nibble < 16; nibble++) {
+      painter.drawText(nibble * glyphWidth, style * glyphHeight + fm.ascent(), QString(HexDigits[nibble]));
+    }
+  }
+}
+
+void HexView::relayout() {
+  rows = height() / glyphHeight;
+  cols = std::max(1, (width() / glyphWidth - AddressColumnGlyphs) / ByteColumnGlyphs);
+  snapshot();
+  update();
+}
+
+void HexView::snapshot() {
+  shadow.resize(static_cast<size_t>(bytesInView()));
+  heat.assign(shadow.size(), 0);
+  hotBytes = 0;
+  decayTimer.stop();
+  for (size_t i = 0; i < shadow.size(); i++) shadow[i] = memory[static_cast<Address>(firstAddress + i)];
+}
+
+void HexView::drawGlyph(QPainter& painter, int x, int y, uint8_t nibble, GlyphStyle style) const {
+  painter.drawPixmap(x, y, glyphAtlas, nibble * glyphWidth, style * glyphHeight, glyphWidth, glyphHeight);
+}
+
+void HexView::drawRow(QPainter& painter, int row) const {
+  const int y = row * glyphHeight;
+  const auto addr = static_cast<Address>(firstAddress + row * cols);
+  for (int i = 0; i < AddressGlyphs; i++) {
+    drawGlyph(painter, i * glyphWidth, y, (addr >> ((AddressGlyphs - 1 - i) * 4)) & 0x0f, AddressGlyph);
+  }
+
+  int x = AddressColumnGlyphs * glyphWidth;
+  for (int col = 0, i = row * cols; col < cols; col++, i++, x += ByteColumnGlyphs * glyphWidth) {
+    const auto b = shadow[static_cast<size_t>(i)];
+    const auto style = heat[static_cast<size_t>(i)] ? HighlightedByteGlyph : ByteGlyph;
+    drawGlyph(painter, x, y, b >> 4, style);
+    drawGlyph(painter, x + glyphWidth, y, b & 0x0f, style);
+  }
+}
+
+QRect HexView::rowRect(int row) const {
+  return {0, row * glyphHeight, width(), glyphHeight};
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "addressrange.h"
+#include "commondefs.h"
+#include "memory.h"
+#include <QPixmap>
+#include <QTimer>
+#include <QWidget>
+
+class HexView : public QWidget {
+  Q_OBJECT
+
+public:
+  // a changed byte stays highlighted for this many ticks, whether or not memory keeps changing
+  static constexpr uint8_t HighlightTicks = 25;
+  static constexpr int TickInterval = 20; // ms
+
+  explicit HexView(QWidget* parent, const Memory&);
+
+  Address first() const { return firstAddress; }
+  // before the first one when the view wraps past $FFFF
+  Address last() const;
+  bool shows(AddressRange) const;
+
+signals:
+  void visibleRangeChanged(Address first, Address last);
+
+public slots:
+  void changeStart(Address);
+  void refresh();
+
+protected:
+  void paintEvent(QPaintEvent*) override;
+  void resizeEvent(QResizeEvent*) override;
+  void changeEvent(QEvent*) override;
+
+private:
+  enum GlyphStyle { AddressGlyph, ByteGlyph, HighlightedByteGlyph, NumberOfGlyphStyles };
+
+  const Memory& memory;
+  Address firstAddress = 0;
+  int rows = 0;
+  int cols = 0;
+  int glyphWidth;
+  int glyphHeight;
+  QPixmap glyphAtlas;
+
+  // bytes shown in the last frame and the number of ticks each one stays highlighted
+  Data shadow;
+  Data heat;
+  int hotBytes = 0;
+  QTimer decayTimer;
+
+  void renderGlyphAtlas();
+  void relayout();
+  void snapshot();
+  void decay();
+  void updateRows(int firstRow, int lastRow);
+  void drawGlyph(QPainter&, int x, int y, uint8_t nibble, GlyphStyle) const;
+  void drawRow(QPainter&, int row) const;
+  QRect rowRect(int row) const;
+  int bytesInView() const { return rows * cols; }
+};
@@ -0,0 +1,320 @@
+#include "incrementalassembler.h"
+#include "moduleassembler.h"
+#include <algorithm>
+#include <atomic>
+
+static bool hasSymbolicOrigin(const ParsedLine& line) {
+  return line.kind == ParsedLine::SetLocationCounter && !line.operands.front().isLiteral();
+}
+
+IncrementalAssembler::IncrementalAssembler(Memory& memory)
+    : memory(memory), assembler(scratch), map(std::make_shared<SourceMap>()) {
+}
+
+void IncrementalAssembler::replaceLines(int first, int removed, const std::vector<QString>& added) {
+  first = std::clamp(first, 0, lineCount());
+  removed = std::clamp(removed, 0, lineCount() - first);
+  const auto addedCount = static_cast<int>(added.size());
+  const auto replaced = std::min(removed, addedCount);
+
+  for (auto i = first; i < first + removed; i++) releaseLine(*lines[static_cast<size_t>(i)]);
+  // a replaced line keeps what was written for it, so an edit that does not change the bytes writes nothing
+  for (auto i = 0; i < replaced; i++) {
+    auto& slot = lines[static_cast<size_t>(first + i)];
+    auto line = parseLine(added[static_cast<size_t>(i)]);
+    line->bytes = std::move(slot->bytes);
+    line->writtenAt = slot->writtenAt;
+    line->mappedLine = slot->mappedLine;
+    line->mappedAt = slot->mappedAt;
+    line->mappedSize = slot->mappedSize;
+    slot = std::move(line);
+  }
+
+  const auto at = lines.begin() + first + replaced;
+  if (removed > replaced) {
+    for (auto it = at; it != at + (removed - replaced); ++it) {
+      if ((*it)->mappedLine >= 0) releasedMappings.push_back({false, (*it)->mappedAt, (*it)->mappedSize, (*it)->mappedLine});
+    }
+    lines.erase(at, at + (removed - replaced));
+  } else if (addedCount > replaced) {
+    std::vector<std::unique_ptr<Line>> inserted;
+    inserted.reserve(static_cast<size_t>(addedCount - replaced));
+    for (auto i = replaced; i < addedCount; i++) inserted.push_back(parseLine(added[static_cast<size_t>(i)]));
+    lines.insert(at, std::make_move_iterator(inserted.begin()), std::make_move_iterator(inserted.end()));
+  }
+
+  if (lastToLayout >= first + removed) lastToLayout += addedCount - removed;
+  lastToLayout = std::max(lastToLayout, first + addedCount - 1);
+  firstToLayout = std::min(firstToLayout, first);
+  listingEdits.push_back({first, removed, addedCount});
+}
+
+AddressRange IncrementalAssembler::update() {
+  written = 0;
+  ranges.clear();
+  // sizes can keep flipping when addresses wrap past $FFFF, emitLine reports what is left unsettled
+  for (auto passes = 1;; passes++) {
+    layout();
+    claimReleasedLabels();
+    if (passes == ModuleAssembler::MaxScanPasses || !resizeReferences()) break;
+  }
+  markReferences();
+
+  for (const auto& [first, removed, added] : listingEdits) listed.replaceLines(first, removed, added);
+  listingEdits.clear();
+  for (auto i = 0; i < lineCount(); i++) {
+    auto& line = *lines[static_cast<size_t>(i)];
+    if (line.pending) {
+      emitLine(line);
+      listed.setSource(i, listedSource(line));
+    } else if (rewriteAll) {
+      writeBytes(line);
+    }
+  }
+  rewriteAll = false;
+  annotationChanges = listed.update();
+  updateSourceMap();
+
+  AddressRange range;
+  for (const auto r : ranges) {
+    range.expand(r.first);
+    range.expand(r.last);
+  }
+  return range;
+}
+
+AddressRange IncrementalAssembler::codeRange() const {
+  AddressRange range;
+  for (const auto& line : lines) {
+    if (line->bytes.empty()) continue;
+    range.expand(line->writtenAt);
+    range.expand(static_cast<Address>(line->writtenAt + line->bytes.size() - 1));
+  }
+  return range;
+}
+
+std::vector<Assembler::DeferredError> IncrementalAssembler::errors() const {
+  std::vector<Assembler::DeferredError> list;
+  for (auto i = 0; i < lineCount(); i++) {
+    const auto& line = *lines[static_cast<size_t>(i)];
+    if (line.result == AssemblyResult::Ok) continue;
+
+    QString symbol;
+    for (const auto& op : line.parsed.operands) {
+      if (op.column == line.column) symbol = op.symbol;
+    }
+    list.push_back({line.result, i, line.column, symbol});
+  }
+  return list;
+}
+
+std::unique_ptr<IncrementalAssembler::Line> IncrementalAssembler::parseLine(const QString& text) {
+  auto line = std::make_unique<Line>();
+  line->text = text;
+  line->parseResult = parser.parse(text, line->parsed);
+  line->parseColumn = parser.errorColumn();
+  // a line with an error neither emits code nor defines its label
+  if (line->parseResult != AssemblyResult::Ok) line->parsed = {};
+  if (hasSymbolicOrigin(line->parsed)) symbolicOrigins++;
+  return line;
+}
+
+void IncrementalAssembler::releaseLine(const Line& line) {
+  if (hasSymbolicOrigin(line.parsed)) symbolicOrigins--;
+  if (line.definesLabel) {
+    assembler.symbolTable.erase(line.parsed.label);
+    changedSymbols.insert(line.parsed.label);
+    releasedLabels.insert(line.parsed.label);
+  }
+}
+
+// stops at the first line past the new ones that starts where it did before, unless an origin refers to a symbol
+void IncrementalAssembler::layout() {
+  auto addr = firstToLayout > 0 ? lines[static_cast<size_t>(firstToLayout - 1)]->next : Assembler::DefaultOrigin;
+  for (auto i = firstToLayout; i < lineCount(); i++) {
+    auto& line = *lines[static_cast<size_t>(i)];
+    if (i > lastToLayout && line.laidOut && line.address == addr && !symbolicOrigins) break;
+
+    // a forward reference takes the value from before, resizeReferences fixes the size if it moved
+    const auto size = assembler.emittedSize(line.parsed);
+    if (!line.laidOut || line.address != addr || line.size != size) line.pending = true;
+    line.address = addr;
+    line.size = size;
+    line.laidOut = true;
+    layoutLabel(line);
+    addr = line.next = nextAddress(line);
+  }
+  firstToLayout = lineCount();
+  lastToLayout = -1;
+}
+
+// the first line to define a label owns it, later ones report it as already defined
+void IncrementalAssembler::layoutLabel(Line& line) {
+  const auto& label = line.parsed.label;
+  if (label.isEmpty()) return;
+
+  auto& table = assembler.symbolTable;
+  if (line.definesLabel) {
+    if (table.get(label) == line.address) return;
+    table.set(label, line.address);
+  } else {
+    if (!table.put(label, line.address)) return;
+    line.definesLabel = true;
+  }
+  changedSymbols.insert(label);
+}
+
+Address IncrementalAssembler::nextAddress(const Line& line) {
+  const auto kind = line.parsed.kind;
+  if (kind != ParsedLine::SetLocationCounter && kind != ParsedLine::Align && kind != ParsedLine::KeepOnPage)
+    return static_cast<Address>(line.address + line.size);
+
+  assembler.locationCounter = line.address;
+  return assembler.processLine(line.parsed) == AssemblyResult::Ok ? assembler.locationCounter : line.address;
+}
+
+void IncrementalAssembler::claimReleasedLabels() {
+  if (releasedLabels.isEmpty()) return;
+
+  for (const auto& line : lines) {
+    if (!line->definesLabel && releasedLabels.contains(line->parsed.label)) {
+      layoutLabel(*line);
+      line->pending = true;
+    }
+  }
+  releasedLabels.clear();
+}
+
+static bool refersTo(const ParsedLine& line, const QSet<QString>& symbols) {
+  for (const auto& op : line.operands) {
+    if (!op.isLiteral() && symbols.contains(op.symbol)) return true;
+  }
+  return false;
+}
+
+// a symbol moving in or out of zero page changes the size of the instructions referring to it, which are then
+// laid out again along with what follows them; returns false once all sizes agree with the symbols
+bool IncrementalAssembler::resizeReferences() {
+  if (changedSymbols.isEmpty()) return false;
+
+  auto resized = false;
+  for (auto i = 0; i < lineCount(); i++) {
+    auto& line = *lines[static_cast<size_t>(i)];
+    if (line.parsed.kind != ParsedLine::Instruction || !refersTo(line.parsed, changedSymbols)) continue;
+
+    const auto size = assembler.emittedSize(line.parsed);
+    if (size == line.size) continue;
+    line.size = size;
+    line.pending = true;
+    firstToLayout = std::min(firstToLayout, i);
+    lastToLayout = std::max(lastToLayout, i);
+    resized = true;
+  }
+  return resized;
+}
+
+void IncrementalAssembler::markReferences() {
+  if (changedSymbols.isEmpty()) return;
+
+  for (const auto& line : lines) {
+    if (!line->pending && refersTo(line->parsed, changedSymbols)) line->pending = true;
+  }
+  changedSymbols.clear();
+}
+
+void IncrementalAssembler::emitLine(Line& line) {
+  line.pending = false;
+
+  if (line.parseResult != AssemblyResult::Ok) {
+    line.result = line.parseResult;
+    line.column = line.parseColumn;
+  } else if (!line.parsed.label.isEmpty() && !line.definesLabel) {
+    line.result = AssemblyResult::SymbolAlreadyDefined;
+    line.column = line.parsed.labelColumn;
+  } else {
+    assembler.locationCounter = line.address;
+    line.result = assembler.processLine(line.parsed);
+    line.column = assembler.errorColumn();
+    if (line.result == AssemblyResult::Ok && line.parsed.kind == ParsedLine::Instruction &&
+        assembler.locationCounter != static_cast<Address>(line.address + line.size)) {
+      line.result = AssemblyResult::SizesNotSettled;
+      line.column = 0;
+    }
+  }
+  // the memory keeps what was written for a line in error
+  if (line.result != AssemblyResult::Ok) return;
+
+  Data bytes;
+  for (auto i = 0; i < line.size; i++) bytes.push_back(scratch[static_cast<Address>(line.address + i)]);
+  if (!rewriteAll && line.writtenAt == line.address && bytes == line.bytes) return;
+
+  line.bytes = std::move(bytes);
+  line.writtenAt = line.address;
+  writeBytes(line);
+}
+
+void IncrementalAssembler::writeBytes(const Line& line) {
+  auto addr = line.writtenAt;
+  for (const auto b : line.bytes) {
+    memory[addr] = b;
+    if (!ranges.empty() && addr && ranges.back().last == addr - 1)
+      ranges.back().last = addr;
+    else
+      ranges.emplace_back(addr);
+    addr++;
+    written++;
+  }
+}
+
+Listing::Source IncrementalAssembler::listedSource(const Line& line) {
+  const auto ok = line.result == AssemblyResult::Ok;
+  return {line.text, line.parsed.label, line.address, ok ? line.bytes : Data(),
+          line.parsed.kind == ParsedLine::Instruction};
+}
+
+// remaps the lines that moved in the source or in memory; the map last handed out may still be read on another
+// thread, so the changes go to the spare one, brought up to date by the changes of the previous update
+void IncrementalAssembler::updateSourceMap() {
+  std::vector<MapChange> removed;
+  std::vector<MapChange> added;
+  for (auto i = 0; i < lineCount(); i++) {
+    auto& line = *lines[static_cast<size_t>(i)];
+    const auto ok = line.result == AssemblyResult::Ok && !line.bytes.empty();
+    const auto mappedLine = ok ? i : -1;
+    const auto mappedAt = ok ? line.writtenAt : Address(0);
+    const auto mappedSize = ok ? line.bytes.size() : 0;
+    if (line.mappedLine == mappedLine && line.mappedAt == mappedAt && line.mappedSize == mappedSize) continue;
+
+    if (line.mappedLine >= 0) removed.push_back({false, line.mappedAt, line.mappedSize, line.mappedLine});
+    if (ok) added.push_back({true, mappedAt, mappedSize, mappedLine});
+    line.mappedLine = mappedLine;
+    line.mappedAt = mappedAt;
+    line.mappedSize = mappedSize;
+  }
+  // lines removed from the source are no longer in the list
+  for (const auto& line : releasedMappings) removed.push_back(line);
+  releasedMappings.clear();
+  if (removed.empty() && added.empty()) return;
+
+  auto changes = std::move(removed);
+  changes.insert(changes.end(), added.begin(), added.end());
+  // the reference dropped by the other thread is released before the map is written
+  if (spareMap && spareMap.use_count() == 1) {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    apply(*spareMap, lastMapChanges);
+  } else {
+    spareMap = std::make_shared<SourceMap>(*map);
+  }
+  apply(*spareMap, changes);
+  std::swap(map, spareMap);
+  lastMapChanges = std::move(changes);
+}
+
+void IncrementalAssembler::apply(SourceMap& sourceMap, const std::vector<MapChange>& changes) {
+  for (const auto& change : changes) {
+    if (change.add)
+      sourceMap.add(change.address, change.size, 0, change.line);
+    else
+      sourceMap.remove(change.address, change.size, 0, change.line);
+  }
+}
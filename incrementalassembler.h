@@ -0,0 +1,112 @@
+#pragma once
+
+#include "assembler.h"
+#include "listing.h"
+#include "sourcemap.h"
+#include <QSet>
+#include <array>
+#include <memory>
+
+// Keeps the parse result, address and emitted bytes of every source line, so that an edit only lays out
+// the lines from the edit until addresses line up again and re-emits the lines whose inputs changed
+class IncrementalAssembler {
+public:
+  explicit IncrementalAssembler(Memory&);
+
+  // mirrors a change of the source: lines [first, first + removed) are replaced with the given ones
+  void replaceLines(int first, int removed, const std::vector<QString>& added);
+
+  // writes the bytes that differ from the previous update, returns their range, Invalid if nothing changed
+  AddressRange update();
+
+  // of the last update, in the order written
+  const std::vector<AddressRange>& writtenRanges() const { return ranges; }
+
+  // the next update writes all emitted bytes again, e.g. when the program could have overwritten its code
+  void invalidateMemory() { rewriteAll = true; }
+
+  int lineCount() const { return static_cast<int>(lines.size()); }
+  int bytesWritten() const { return written; }
+  const SymbolTable& symbols() const { return assembler.symbols(); }
+
+  // union of the bytes emitted by all lines
+  AddressRange codeRange() const;
+
+  // of all lines, in source order
+  std::vector<Assembler::DeferredError> errors() const;
+
+  // of all lines as last updated, a line in error has no bytes
+  const Listing& listing() const { return listed; }
+
+  // lines whose annotation in the listing may differ from the one before the last update
+  const std::vector<int>& changedAnnotations() const { return annotationChanges; }
+
+  // of the bytes emitted as last updated, all in file 0; where code of two lines overlaps, the line written last
+  // keeps the address. The map is not changed while it is held, an update that moves no code keeps it.
+  std::shared_ptr<const SourceMap> sourceMap() const { return map; }
+
+private:
+  friend class IncrementalAssemblerTest;
+
+  struct Line {
+    QString text;
+    ParsedLine parsed;
+    AssemblyResult parseResult;
+    int parseColumn;
+    int size = 0; // bytes, not counting a location counter change
+    Address address = 0;
+    Address next = 0;
+    bool laidOut = false;
+    bool definesLabel = false;
+    bool pending = true;
+    AssemblyResult result = AssemblyResult::Ok;
+    int column = 0;
+    Data bytes; // as last written
+    Address writtenAt = 0;
+    int mappedLine = -1; // as in the source map, -1 for none
+    Address mappedAt = 0;
+    size_t mappedSize = 0;
+  };
+
+  struct MapChange {
+    bool add; // or remove
+    Address address;
+    size_t size;
+    int line;
+  };
+
+  Memory& memory;
+  Memory scratch;
+  Assembler assembler;
+  LineParser parser;
+  std::vector<std::unique_ptr<Line>> lines;
+  QSet<QString> changedSymbols;
+  QSet<QString> releasedLabels;
+  int firstToLayout = 0;
+  int lastToLayout = -1; // the last new line
+  int symbolicOrigins = 0;
+  int written = 0;
+  std::vector<AddressRange> ranges;
+  bool rewriteAll = false;
+  Listing listed;
+  std::vector<std::array<int, 3>> listingEdits; // first, removed and added lines, applied by the next update
+  std::vector<int> annotationChanges;
+  std::shared_ptr<SourceMap> map;
+  std::shared_ptr<SourceMap> spareMap; // as before the last changes to the map, unless it is still held
+  std::vector<MapChange> lastMapChanges;
+  std::vector<MapChange> releasedMappings; // of lines removed since the last update
+
+  std::unique_ptr<Line> parseLine(const QString&);
+  void releaseLine(const Line&);
+  void layout();
+  void layoutLabel(Line&);
+  Address nextAddress(const Line&);
+  void claimReleasedLabels();
+  bool resizeReferences();
+  void markReferences();
+  void emitLine(Line&);
+  void writeBytes(const Line&);
+  static Listing::Source listedSource(const Line&);
+  void updateSourceMap();
+  static void apply(SourceMap&, const std::vector<MapChange>&);
+};
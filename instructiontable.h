@@ -175,3 +175,20 @@ constexpr std::array<Instruction, 256> InstructionTable = [] {
 
   return arr;
 }();
+
+constexpr auto NumberOfOperandsFormats = AbsoluteY + 1;
+
+// opcode by instruction type and addressing mode, -1 if there is none
+constexpr std::array<std::array<int16_t, NumberOfOperandsFormats>, KIL + 1> OpcodeTable = [] {
+  std::array<std::array<int16_t, NumberOfOperandsFormats>, KIL + 1> table{};
+  for (auto& row : table) {
+    for (auto& opcode : row) opcode = -1;
+  }
+  for (int16_t opcode = 0; opcode < Instruction::NumberOfOpCodes; opcode++) {
+    const auto& ins = InstructionTable[static_cast<size_t>(opcode)];
+    if (table[ins.type][ins.mode] < 0) table[ins.type][ins.mode] = opcode;
+  }
+  return table;
+}();
+
+static_assert(OpcodeTable[LDA][Immediate] == 0xa9 && OpcodeTable[JMP][Indirect] == 0x6c && OpcodeTable[STA][Immediate] < 0);
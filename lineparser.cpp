@@ -0,0 +1,301 @@
+#include "lineparser.h"
+#include "mnemonics.h"
+
+static constexpr char16_t CommentStart = ';';
+static constexpr char16_t LoBytePrefix = '<';
+static constexpr char16_t HiBytePrefix = '>';
+static constexpr char16_t HexPrefix = '$';
+static constexpr char16_t BinPrefix = '%';
+static constexpr char16_t Quote = '"';
+
+static constexpr char16_t toUpper(char16_t c) {
+  return c >= 'a' && c <= 'z' ? static_cast<char16_t>(c - 'a' + 'A') : c;
+}
+
+static constexpr int digitValue(char16_t c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return 16;
+}
+
+static bool equalsIgnoreCase(const QChar* text, int length, const char* word) {
+  for (int i = 0; i < length; i++, word++) {
+    if (!*word || toUpper(text[i].unicode()) != *word) return false;
+  }
+  return !*word;
+}
+
+static bool isBranch(InstructionType type) {
+  return type >= BCC && type <= BVS;
+}
+
+AssemblyResult LineParser::parse(const QString& str, ParsedLine& line) {
+  text = str.constData();
+  length = str.length();
+  pos = 0;
+  line.label.clear();
+  line.labelColumn = 0;
+  line.kind = ParsedLine::NoOperation;
+  line.type = None;
+  line.format = ImpliedOrAccumulator;
+  line.operands.clear();
+  line.includePath.clear();
+
+  try {
+    skipSpaces();
+    if (isAsciiLetter(peek())) {
+      const auto start = pos;
+      const auto end = scanIdentifier();
+      if (peek() == ':') {
+        line.label = QString(text + start, end - start);
+        line.labelColumn = start;
+        pos++;
+        skipSpaces();
+      } else {
+        pos = start;
+      }
+    }
+
+    if (atEndOfStatement()) return AssemblyResult::Ok;
+
+    line.operationColumn = pos;
+    const auto c = peek();
+    if (c == '.') {
+      parseDirective(line);
+    } else if (c == '*') {
+      pos++;
+      skipSpaces();
+      expect('=');
+      line.kind = ParsedLine::SetLocationCounter;
+      parseOperand(line);
+    } else if (isAsciiLetter(c)) {
+      parseInstruction(line, scanIdentifier() - line.operationColumn);
+    } else {
+      throw error(AssemblyResult::SyntaxError, pos);
+    }
+
+    expectEndOfStatement();
+    return AssemblyResult::Ok;
+  } catch (AssemblyResult result) { return result; }
+}
+
+bool LineParser::isIdentifierChar(int at) const {
+  if (at >= length) return false;
+  const auto c = text[at];
+  return c.unicode() == '_' || c.isLetterOrNumber();
+}
+
+AssemblyResult LineParser::error(AssemblyResult result, int column) {
+  errorPosition = column;
+  return result;
+}
+
+void LineParser::skipSpaces() {
+  while (pos < length && text[pos].isSpace()) pos++;
+}
+
+bool LineParser::atEndOfStatement() {
+  skipSpaces();
+  return pos == length || text[pos].unicode() == CommentStart;
+}
+
+void LineParser::expectEndOfStatement() {
+  if (!atEndOfStatement()) throw error(AssemblyResult::SyntaxError, pos);
+}
+
+void LineParser::expect(char16_t c) {
+  skipSpaces();
+  if (peek() != c) throw error(AssemblyResult::SyntaxError, pos);
+  pos++;
+  skipSpaces();
+}
+
+void LineParser::expectIndexRegister(char16_t reg) {
+  skipSpaces();
+  if (toUpper(peek()) != reg || isIdentifierChar(pos + 1)) throw error(AssemblyResult::SyntaxError, pos);
+  pos++;
+  skipSpaces();
+}
+
+// returns the position past the identifier
+int LineParser::scanIdentifier() {
+  while (isIdentifierChar(pos)) pos++;
+  return pos;
+}
+
+int LineParser::scanDigits(int base, int maxDigits) {
+  const auto start = pos;
+  int value = 0;
+  for (int digit; pos < length && (digit = digitValue(peek())) < base; pos++) {
+    if (pos - start == maxDigits) throw error(AssemblyResult::SyntaxError, pos);
+    value = value * base + digit;
+  }
+  if (pos == start || isIdentifierChar(pos)) throw error(AssemblyResult::SyntaxError, pos);
+  return value;
+}
+
+void LineParser::parseDirective(ParsedLine& line) {
+  const auto start = pos++;
+  const auto end = scanIdentifier();
+  const auto name = text + start + 1;
+  const auto nameLength = end - start - 1;
+
+  if (equalsIgnoreCase(name, nameLength, "ORG")) {
+    line.kind = ParsedLine::SetLocationCounter;
+    skipSpaces();
+    parseOperand(line);
+  } else if (equalsIgnoreCase(name, nameLength, "ALIGN")) {
+    line.kind = ParsedLine::Align;
+    parseCount(line);
+  } else if (equalsIgnoreCase(name, nameLength, "PAGE")) {
+    line.kind = ParsedLine::KeepOnPage;
+    parseCount(line);
+  } else if (equalsIgnoreCase(name, nameLength, "SAMEPAGE")) {
+    line.kind = ParsedLine::SamePage;
+    parseSymbolList(line);
+    if (line.operands.size() > 1) throw error(AssemblyResult::SyntaxError, line.operands[1].column);
+  } else if (equalsIgnoreCase(name, nameLength, "BYTE")) {
+    line.kind = ParsedLine::EmitBytes;
+    parseOperandList(line);
+  } else if (equalsIgnoreCase(name, nameLength, "WORD")) {
+    line.kind = ParsedLine::EmitWords;
+    parseOperandList(line);
+  } else if (equalsIgnoreCase(name, nameLength, "INCLUDE")) {
+    line.kind = ParsedLine::Include;
+    skipSpaces();
+    parseQuotedPath(line);
+  } else if (equalsIgnoreCase(name, nameLength, "EXPORT")) {
+    line.kind = ParsedLine::Export;
+    parseSymbolList(line);
+  } else {
+    throw error(AssemblyResult::SyntaxError, start);
+  }
+}
+
+void LineParser::parseInstruction(ParsedLine& line, int wordLength) {
+  const auto word = text + line.operationColumn;
+  if (wordLength == 3 && equalsIgnoreCase(word, 3, "DCB")) {
+    line.kind = ParsedLine::EmitBytes;
+    parseOperandList(line);
+    return;
+  }
+
+  line.kind = ParsedLine::Instruction;
+  line.type = wordLength == 3 ? findMnemonic(word[0].unicode(), word[1].unicode(), word[2].unicode()) : None;
+  if (line.type == None) throw error(AssemblyResult::InvalidMnemonic, line.operationColumn);
+
+  if (atEndOfStatement()) {
+    line.format = ImpliedOrAccumulator;
+  } else if (peek() == '#') {
+    pos++;
+    skipSpaces();
+    line.format = Immediate;
+    parseOperand(line);
+  } else if (peek() == '(') {
+    pos++;
+    skipSpaces();
+    parseOperand(line);
+    skipSpaces();
+    if (peek() == ',') {
+      pos++;
+      expectIndexRegister('X');
+      expect(')');
+      line.format = IndexedIndirectX;
+    } else {
+      expect(')');
+      if (peek() == ',') {
+        pos++;
+        expectIndexRegister('Y');
+        line.format = IndirectIndexedY;
+      } else {
+        line.format = Indirect;
+      }
+    }
+  } else if (isBranch(line.type)) {
+    line.format = Branch;
+    parseOperand(line, true);
+  } else {
+    parseOperand(line);
+    skipSpaces();
+    if (peek() == ',') {
+      pos++;
+      skipSpaces();
+      const auto reg = toUpper(peek());
+      expectIndexRegister(reg == 'Y' ? 'Y' : 'X');
+      line.format = reg == 'Y' ? AbsoluteY : AbsoluteX;
+    } else {
+      line.format = Absolute;
+    }
+  }
+}
+
+// a displacement may be a signed decimal number, e.g. +8 or -1, but no $ or % number, which would read as an address
+void LineParser::parseOperand(ParsedLine& line, bool displacement) {
+  ParsedOperand& op = line.operands.emplace_back();
+  op.column = pos;
+
+  if (peek() == LoBytePrefix || peek() == HiBytePrefix) {
+    op.selector = peek() == LoBytePrefix ? ParsedOperand::LoByte : ParsedOperand::HiByte;
+    pos++;
+  }
+
+  const auto c = peek();
+  if (displacement && (c == HexPrefix || c == BinPrefix)) throw error(AssemblyResult::SyntaxError, pos);
+  if (c == HexPrefix) {
+    pos++;
+    op.literal = scanDigits(16, 4);
+  } else if (c == BinPrefix) {
+    pos++;
+    op.literal = scanDigits(2, 16);
+  } else if (c >= '0' && c <= '9') {
+    op.literal = scanDigits(10, 5);
+  } else if (displacement && (c == '+' || c == '-') && op.selector == ParsedOperand::WholeValue) {
+    pos++;
+    op.literal = c == '-' ? -scanDigits(10, 3) : scanDigits(10, 3);
+  } else if (isAsciiLetter(c)) {
+    const auto start = pos;
+    op.symbol = QString(text + start, scanIdentifier() - start);
+  } else {
+    throw error(AssemblyResult::SyntaxError, pos);
+  }
+}
+
+// operands separated with commas or spaces, a trailing comma is accepted
+void LineParser::parseOperandList(ParsedLine& line) {
+  skipSpaces();
+  do {
+    parseOperand(line);
+    skipSpaces();
+    if (peek() == ',') {
+      pos++;
+      skipSpaces();
+    }
+  } while (!atEndOfStatement());
+}
+
+void LineParser::parseSymbolList(ParsedLine& line) {
+  parseOperandList(line);
+  for (const auto& op : line.operands) {
+    if (op.isLiteral() || op.selector != ParsedOperand::WholeValue) throw error(AssemblyResult::SyntaxError, op.column);
+  }
+}
+
+// no escapes, the path ends at the next quote
+void LineParser::parseQuotedPath(ParsedLine& line) {
+  if (peek() != Quote) throw error(AssemblyResult::SyntaxError, pos);
+  const auto start = ++pos;
+  while (pos < length && peek() != Quote) pos++;
+  if (pos == length || pos == start) throw error(AssemblyResult::SyntaxError, pos);
+  line.includePath = QString(text + start, pos - start);
+  pos++;
+}
+
+// a number of bytes, known without symbols so that it moves the code the same way in every pass
+void LineParser::parseCount(ParsedLine& line) {
+  skipSpaces();
+  parseOperand(line);
+  const auto& op = line.operands.front();
+  if (!op.isLiteral() || op.selector != ParsedOperand::WholeValue)
+    throw error(AssemblyResult::NumericOperandRequired, op.column);
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "assemblyresult.h"
+#include "instructiontype.h"
+#include "operandsformat.h"
+#include <QString>
+#include <vector>
+
+struct ParsedOperand {
+  enum ByteSelector : uint8_t { WholeValue, LoByte, HiByte };
+
+  QString symbol; // empty for a literal
+  int literal = 0;
+  ByteSelector selector = WholeValue;
+  int column = 0;
+
+  bool isLiteral() const { return symbol.isEmpty(); }
+};
+
+inline int applyByteSelector(ParsedOperand::ByteSelector selector, int num) {
+  switch (selector) {
+  case ParsedOperand::WholeValue: return num;
+  case ParsedOperand::LoByte: return num & 0xff;
+  case ParsedOperand::HiByte: return num >> 8;
+  }
+  return num;
+}
+
+struct ParsedLine {
+  enum Kind { NoOperation, SetLocationCounter, Align, KeepOnPage, EmitBytes, EmitWords, Instruction, Include, Export, SamePage };
+
+  QString label;
+  int labelColumn = 0;
+  Kind kind = NoOperation;
+  InstructionType type = None;
+  OperandsFormat format = ImpliedOrAccumulator;
+  int operationColumn = 0;
+  std::vector<ParsedOperand> operands;
+  QString includePath;
+};
+
+// Tokenizes and parses a single source line in one pass over its characters
+class LineParser {
+public:
+  AssemblyResult parse(const QString&, ParsedLine&);
+
+  // of the last error, counted from 0
+  int errorColumn() const { return errorPosition; }
+
+private:
+  const QChar* text = nullptr;
+  int length = 0;
+  int pos = 0;
+  int errorPosition = 0;
+
+  char16_t peek() const { return pos < length ? text[pos].unicode() : 0; }
+  bool isIdentifierChar(int at) const;
+  AssemblyResult error(AssemblyResult, int column);
+  void skipSpaces();
+  bool atEndOfStatement();
+  void expectEndOfStatement();
+  void expect(char16_t);
+  void expectIndexRegister(char16_t);
+  int scanIdentifier();
+  int scanDigits(int base, int maxDigits);
+
+  void parseDirective(ParsedLine&);
+  void parseInstruction(ParsedLine&, int wordLength);
+  void parseOperand(ParsedLine&, bool displacement = false);
+  void parseOperandList(ParsedLine&);
+  void parseSymbolList(ParsedLine&);
+  void parseQuotedPath(ParsedLine&);
+  void parseCount(ParsedLine&);
+};
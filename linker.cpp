@@ -0,0 +1,131 @@
+#include "linker.h"
+#include "lineparser.h"
+#include <algorithm>
+#include <map>
+
+bool Linker::link(const std::vector<const ObjectModule*>& modules, Address origin) {
+  result = {};
+  errorList.clear();
+
+  place(modules, origin);
+  if (!errorList.empty()) return false;
+
+  defineExports(modules);
+  placeLabels(modules);
+  relocate(modules);
+  mapLines(modules);
+  return errorList.empty();
+}
+
+void Linker::place(const std::vector<const ObjectModule*>& modules, Address origin) {
+  bases.clear();
+  placements.clear();
+
+  auto next = static_cast<int>(origin);
+  for (auto m = 0; m < static_cast<int>(modules.size()); m++) {
+    const auto& sections = modules[static_cast<size_t>(m)]->sections;
+    bases.push_back(static_cast<Address>(next));
+    for (auto s = 0; s < static_cast<int>(sections.size()); s++) {
+      const auto& section = sections[static_cast<size_t>(s)];
+      if (section.bytes.empty()) continue;
+
+      const auto first = section.relocatable ? next : section.origin;
+      if (first + static_cast<int>(section.bytes.size()) > static_cast<int>(Memory::Size)) {
+        errorList.push_back({AssemblyResult::ValueOutOfRange, m, {}});
+        continue;
+      }
+      if (section.relocatable) next += static_cast<int>(section.bytes.size());
+      placements.push_back({static_cast<Address>(first), m, s});
+    }
+  }
+
+  std::stable_sort(placements.begin(), placements.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+  auto end = 0;
+  for (const auto& p : placements) {
+    const auto& bytes = modules[static_cast<size_t>(p.module)]->sections[static_cast<size_t>(p.section)].bytes;
+    if (p.first < end) errorList.push_back({AssemblyResult::SectionsOverlap, p.module, {}});
+    end = std::max(end, p.first + static_cast<int>(bytes.size()));
+    result.image.chunks.push_back({p.first, bytes});
+  }
+}
+
+void Linker::defineExports(const std::vector<const ObjectModule*>& modules) {
+  for (auto m = 0; m < static_cast<int>(modules.size()); m++) {
+    for (const auto& symbol : modules[static_cast<size_t>(m)]->exports) {
+      const auto value = symbol.relocatable ? bases[static_cast<size_t>(m)] + symbol.value : symbol.value;
+      if (!result.symbols.put(symbol.name, static_cast<uint16_t>(value)))
+        errorList.push_back({AssemblyResult::SymbolAlreadyDefined, m, symbol.name});
+    }
+  }
+}
+
+void Linker::placeLabels(const std::vector<const ObjectModule*>& modules) {
+  for (auto m = 0; m < static_cast<int>(modules.size()); m++) {
+    for (const auto& symbol : modules[static_cast<size_t>(m)]->labels) {
+      const auto value = symbol.relocatable ? bases[static_cast<size_t>(m)] + symbol.value : symbol.value;
+      result.labels.push_back({symbol.name, static_cast<Address>(value)});
+    }
+  }
+}
+
+void Linker::relocate(const std::vector<const ObjectModule*>& modules) {
+  std::map<std::pair<int, int>, size_t> chunks;
+  for (size_t i = 0; i < placements.size(); i++) chunks[{placements[i].module, placements[i].section}] = i;
+
+  for (auto m = 0; m < static_cast<int>(modules.size()); m++) {
+    for (const auto& r : modules[static_cast<size_t>(m)]->relocations) {
+      // a field in an empty section cannot exist, so its chunk is always there
+      auto& chunk = result.image.chunks[chunks.at({m, r.section})];
+      relocate(r, m, chunk.bytes, chunk.first);
+    }
+  }
+}
+
+void Linker::relocate(const ObjectModule::Relocation& r, int module, Data& bytes, Address first) {
+  auto value = static_cast<int>(r.addend);
+  if (!r.symbol.isEmpty()) {
+    const auto symbol = result.symbols.get(r.symbol);
+    if (!symbol) {
+      errorList.push_back({AssemblyResult::SymbolNotDefined, module, r.symbol});
+      return;
+    }
+    value += *symbol;
+  } else if (r.relocatable) {
+    value += bases[static_cast<size_t>(module)];
+  }
+  value = applyByteSelector(r.selector, value & 0xffff);
+
+  const auto at = r.offset;
+  switch (r.kind) {
+  case ObjectModule::Relocation::DataByte:
+  case ObjectModule::Relocation::OperandByte:
+    // an operand byte is checked too, the symbol of another module need not be on the zero page
+    if (value > 0xff) break;
+    bytes[at] = static_cast<uint8_t>(value);
+    return;
+  case ObjectModule::Relocation::Word:
+    bytes[at] = static_cast<uint8_t>(value);
+    bytes[at + 1u] = static_cast<uint8_t>(value >> 8);
+    return;
+  case ObjectModule::Relocation::Displacement: {
+    const auto displacement = value - (first + at + 1);
+    if (displacement < -128 || displacement > 127) break;
+    bytes[at] = static_cast<uint8_t>(displacement);
+    return;
+  }
+  }
+  errorList.push_back({AssemblyResult::ValueOutOfRange, module, r.symbol});
+}
+
+void Linker::mapLines(const std::vector<const ObjectModule*>& modules) {
+  for (auto m = 0; m < static_cast<int>(modules.size()); m++) {
+    const auto& module = *modules[static_cast<size_t>(m)];
+    const auto firstFile = static_cast<int>(result.files.size());
+    result.files.append(module.files);
+    for (const auto& line : module.lines) {
+      const auto& section = module.sections[static_cast<size_t>(line.section)];
+      const auto first = section.relocatable ? bases[static_cast<size_t>(m)] : section.origin;
+      result.lines.push_back({static_cast<Address>(first + line.offset), line.size, firstFile + line.file, line.number});
+    }
+  }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "assemblyresult.h"
+#include "memorypatch.h"
+#include "objectmodule.h"
+#include "symboltable.h"
+#include <QStringList>
+#include <vector>
+
+// where the code of a source line was placed
+struct SourceLine {
+  Address address;
+  Address size;
+  int file; // index in BuildOutput::files
+  int number; // counted from 0
+};
+
+// a symbol of a module where the linker placed it
+struct LinkedSymbol {
+  QString name;
+  Address value;
+};
+
+struct BuildOutput {
+  MemoryPatch image; // sections in address order
+  SymbolTable symbols; // exported
+  QStringList files;
+  std::vector<SourceLine> lines;
+  std::vector<LinkedSymbol> labels; // of every module, also the ones not exported, in module order
+};
+
+// Places the relocatable sections of object modules one after another, resolves the symbols they export
+// to each other and fills in the relocated fields
+class Linker {
+public:
+  struct Error {
+    AssemblyResult result;
+    int module; // index in the linked list
+    QString symbol;
+  };
+
+  // returns false if there were errors
+  bool link(const std::vector<const ObjectModule*>&, Address origin);
+
+  const BuildOutput& output() const { return result; }
+  const MemoryPatch& image() const { return result.image; }
+  const SymbolTable& symbols() const { return result.symbols; }
+  const std::vector<Error>& errors() const { return errorList; }
+
+private:
+  struct Placement {
+    Address first;
+    int module;
+    int section;
+  };
+
+  BuildOutput result;
+  std::vector<Error> errorList;
+  std::vector<Address> bases; // of the relocatable section of each module
+  std::vector<Placement> placements;
+
+  void place(const std::vector<const ObjectModule*>&, Address origin);
+  void defineExports(const std::vector<const ObjectModule*>&);
+  void placeLabels(const std::vector<const ObjectModule*>&);
+  void relocate(const std::vector<const ObjectModule*>&);
+  void relocate(const ObjectModule::Relocation&, int module, Data& bytes, Address first);
+  void mapLines(const std::vector<const ObjectModule*>&);
+};
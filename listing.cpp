@@ -0,0 +1,262 @@
+#include "listing.h"
+#include "commonformatters.h"
+#include "instructiontable.h"
+#include <map>
+#include <set>
+#include <utility>
+
+static constexpr int BytesPerRow = 3;
+
+// as in the Cpu, only these take a cycle more when the indexed address lands on another page
+static bool readsAcrossPages(const Instruction& ins) {
+  switch (ins.type) {
+  case LDA:
+  case LDX:
+  case LDY:
+  case ADC:
+  case SBC:
+  case AND:
+  case ORA:
+  case EOR:
+  case CMP: return ins.mode == AbsoluteX || ins.mode == AbsoluteY || ins.mode == IndirectIndexedY;
+  default: return false;
+  }
+}
+
+static Listing::Cycles lineCycles(const Listing::Line& line) {
+  return {line.cycles, line.cycles + line.penalty};
+}
+
+Listing::Listing(std::vector<Source> sources) {
+  lineList.reserve(sources.size());
+  for (auto& source : sources) {
+    Line line;
+    line.source = std::move(source);
+    time(line);
+    lineList.push_back(std::move(line));
+  }
+  sourceChanged.assign(lineList.size(), false);
+  sumBlocks();
+  findPageCrossings();
+}
+
+void Listing::replaceLines(int first, int removed, int added) {
+  const auto splice = [&](auto& list, auto value) {
+    const auto at = list.erase(list.begin() + first, list.begin() + first + removed);
+    list.insert(at, static_cast<size_t>(added), value);
+  };
+  splice(lineList, Line());
+  splice(blockOfLine, -1);
+  splice(warningOfLine, -1);
+  splice(sourceChanged, true);
+}
+
+void Listing::setSource(int index, Source source) {
+  Line line;
+  line.source = std::move(source);
+  time(line);
+  lineList[static_cast<size_t>(index)] = std::move(line);
+  sourceChanged[static_cast<size_t>(index)] = true;
+}
+
+static bool sameCycles(Listing::Cycles a, Listing::Cycles b) {
+  return a.min == b.min && a.max == b.max;
+}
+
+// a block moves with its first line and keeps its label, only the totals can change
+static bool sameTotals(const Listing::Block& a, const Listing::Block& b) {
+  return sameCycles(a.cycles, b.cycles) && a.loopEnd == b.loopEnd && sameCycles(a.loop, b.loop);
+}
+
+static bool sameWarning(const Listing::Warning& a, const Listing::Warning& b) {
+  return a.kind == b.kind && a.address == b.address;
+}
+
+// whether the entries of a line, -1 for none, are the same in two lists
+template <typename T, typename Same>
+static bool sameEntry(const std::vector<T>& list, int index, const std::vector<T>& previous, int previousIndex,
+                      Same same) {
+  if (index < 0 || previousIndex < 0) return index == previousIndex;
+  return same(list[static_cast<size_t>(index)], previous[static_cast<size_t>(previousIndex)]);
+}
+
+std::vector<int> Listing::update() {
+  const auto previousBlocks = std::exchange(blockList, {});
+  const auto previousBlockOfLine = blockOfLine;
+  const auto previousWarnings = std::exchange(warningList, {});
+  const auto previousWarningOfLine = warningOfLine;
+  sumBlocks();
+  findPageCrossings();
+
+  std::vector<int> changed;
+  for (size_t i = 0; i < lineList.size(); i++) {
+    if (sourceChanged[i] ||
+        !sameEntry(blockList, blockOfLine[i], previousBlocks, previousBlockOfLine[i], sameTotals) ||
+        !sameEntry(warningList, warningOfLine[i], previousWarnings, previousWarningOfLine[i], sameWarning))
+      changed.push_back(static_cast<int>(i));
+  }
+  sourceChanged.assign(lineList.size(), false);
+  return changed;
+}
+
+void Listing::time(Line& line) {
+  const auto& bytes = line.source.bytes;
+  if (!line.source.instruction || bytes.empty()) return;
+
+  const auto& ins = InstructionTable[bytes[0]];
+  if (bytes.size() != ins.size) return;
+
+  line.cycles = ins.cycles;
+  if (ins.mode == Branch) {
+    const auto next = static_cast<Address>(line.source.address + 2);
+    const auto target = static_cast<Address>(next + static_cast<int8_t>(bytes[1]));
+    line.branch = true;
+    line.penalty = (next ^ target) & 0xff00 ? 2 : 1;
+    line.target = target;
+  } else if (readsAcrossPages(ins)) {
+    // an 8-bit index cannot leave a table that starts a page
+    if (ins.mode == IndirectIndexedY || bytes[1]) line.penalty = 1;
+  } else if (ins.type == JMP && ins.mode == Absolute) {
+    line.target = bytes[1] | bytes[2] << 8;
+  }
+}
+
+void Listing::sumBlocks() {
+  const auto count = static_cast<int>(lineList.size());
+  std::vector<Cycles> sums(lineList.size() + 1);
+  std::map<int, int> lastJumpTo;
+  for (auto i = 0; i < count; i++) {
+    const auto& line = lineList[static_cast<size_t>(i)];
+    const auto cycles = lineCycles(line);
+    const auto& before = sums[static_cast<size_t>(i)];
+    sums[static_cast<size_t>(i + 1)] = {before.min + cycles.min, before.max + cycles.max};
+    if (line.target >= 0) lastJumpTo[line.target] = i;
+  }
+  const auto sum = [&](int first, int last) {
+    const auto& a = sums[static_cast<size_t>(first)];
+    const auto& b = sums[static_cast<size_t>(last + 1)];
+    return Cycles{b.min - a.min, b.max - a.max};
+  };
+
+  blockOfLine.assign(lineList.size(), -1);
+  for (auto i = 0; i < count; i++) {
+    const auto& source = lineList[static_cast<size_t>(i)].source;
+    if (source.label.isEmpty()) continue;
+
+    if (!blockList.empty()) blockList.back().last = i - 1;
+    blockOfLine[static_cast<size_t>(i)] = static_cast<int>(blockList.size());
+    blockList.push_back({source.label, i, count - 1, {}, -1, {}});
+  }
+
+  for (auto& block : blockList) {
+    block.cycles = sum(block.first, block.last);
+    const auto it = lastJumpTo.find(lineList[static_cast<size_t>(block.first)].source.address);
+    if (it == lastJumpTo.end() || it->second < block.first) continue;
+
+    const auto& jump = lineList[static_cast<size_t>(it->second)];
+    block.loopEnd = it->second;
+    block.loop = sum(block.first, block.loopEnd);
+    if (jump.branch) block.loop.min += jump.penalty;
+  }
+}
+
+// a table is what the lines under its label emit, an indexed read of it may cross a page only if the table does
+void Listing::findPageCrossings() {
+  std::set<int> tables;
+  for (const auto& block : blockList) {
+    auto first = -1;
+    auto last = -1;
+    for (auto i = block.first; i <= block.last; i++) {
+      const auto& source = lineList[static_cast<size_t>(i)].source;
+      if (source.bytes.empty()) continue;
+      if (first < 0) first = source.address;
+      last = source.address + static_cast<int>(source.bytes.size()) - 1;
+    }
+    const auto start = lineList[static_cast<size_t>(block.first)].source.address;
+    if (first == start && (first ^ last) & 0xff00) tables.insert(start);
+  }
+
+  warningOfLine.assign(lineList.size(), -1);
+  const auto warn = [this](Warning::Kind kind, int line, int address) {
+    warningOfLine[static_cast<size_t>(line)] = static_cast<int>(warningList.size());
+    warningList.push_back({kind, line, static_cast<Address>(address)});
+  };
+  for (auto i = 0; i < static_cast<int>(lineList.size()); i++) {
+    const auto& line = lineList[static_cast<size_t>(i)];
+    if (line.branch && line.penalty > 1) {
+      warn(Warning::BranchCrossesPage, i, line.target);
+    } else if (!line.branch && line.penalty && InstructionTable[line.source.bytes[0]].mode != IndirectIndexedY) {
+      const auto base = line.source.bytes[1] | line.source.bytes[2] << 8;
+      if (tables.count(base)) warn(Warning::TableCrossesPage, i, base);
+    }
+  }
+}
+
+QString Listing::formatWarning(const Warning& warning) {
+  const auto address = "$" + formatHexWord(warning.address);
+  switch (warning.kind) {
+  case Warning::BranchCrossesPage: return QString("branch to %1 crosses a page").arg(address);
+  case Warning::TableCrossesPage: return QString("table at %1 crosses a page").arg(address);
+  }
+  return {};
+}
+
+QString Listing::formatCycles(Cycles cycles) {
+  return cycles.min == cycles.max ? QString::number(cycles.min) : QString("%1..%2").arg(cycles.min).arg(cycles.max);
+}
+
+QString Listing::formatBlock(const Block& block) const {
+  auto text = QString("block %1").arg(formatCycles(block.cycles));
+  if (block.loopEnd >= 0) text += QString(", loop %1 to line %2").arg(formatCycles(block.loop)).arg(block.loopEnd + 1);
+  return text;
+}
+
+QString Listing::formatLine(const Line& line) {
+  if (line.branch) return QString("%1/%2").arg(line.cycles).arg(line.cycles + line.penalty);
+  if (line.penalty) return QString("%1+%2").arg(line.cycles).arg(line.penalty);
+  return line.cycles ? QString::number(line.cycles) : QString();
+}
+
+QString Listing::annotation(int index) const {
+  auto text = formatLine(lineList[static_cast<size_t>(index)]);
+  if (const auto block = blockOfLine[static_cast<size_t>(index)]; block >= 0) {
+    if (!text.isEmpty()) text += "  ";
+    text += "[" + formatBlock(blockList[static_cast<size_t>(block)]) + "]";
+  }
+  if (const auto warning = warningOfLine[static_cast<size_t>(index)]; warning >= 0)
+    text += "  ! " + formatWarning(warningList[static_cast<size_t>(warning)]);
+  return text;
+}
+
+QString Listing::toText() const {
+  QString text = "; cycles: a+1 when an indexed read crosses a page, a/b for a branch not taken/taken\n";
+  for (auto i = 0; i < static_cast<int>(lineList.size()); i++) {
+    const auto& line = lineList[static_cast<size_t>(i)];
+    const auto& bytes = line.source.bytes;
+    for (size_t part = 0; part == 0 || part * BytesPerRow < bytes.size(); part++) {
+      QString hex;
+      for (auto b = part * BytesPerRow; b < bytes.size() && b < (part + 1) * BytesPerRow; b++) {
+        hex += formatHexByte(bytes[b]).toUpper() + " ";
+      }
+      const auto address = static_cast<Address>(line.source.address + part * BytesPerRow);
+      const auto shown = !bytes.empty() || !line.source.label.isEmpty();
+      auto row = QString("%1  %2 %3  %4")
+                     .arg(shown ? formatHexWord(address).toUpper() : QString(), -4)
+                     .arg(hex, -BytesPerRow * 3)
+                     .arg(part ? QString() : formatLine(line), -5)
+                     .arg(part ? QString() : line.source.text);
+      while (row.endsWith(' ')) row.chop(1);
+      text += row + "\n";
+    }
+  }
+
+  if (!blockList.empty()) text += "\n";
+  for (const auto& block : blockList) {
+    text += QString("; %1 %2\n").arg(block.label, -16).arg(formatBlock(block));
+  }
+  if (!warningList.empty()) text += "\n";
+  for (const auto& warning : warningList) {
+    text += QString("; warning at line %1: %2\n").arg(warning.line + 1).arg(formatWarning(warning));
+  }
+  return text;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "commondefs.h"
+#include <QString>
+#include <vector>
+
+// Static cycle counts of assembled code as the Cpu charges them: every source line with its address, bytes and
+// cycles, and the totals of the code under each label, so routines can be tuned without running them
+class Listing {
+public:
+  struct Source {
+    QString text;
+    QString label;
+    Address address = 0;
+    Data bytes;
+    bool instruction = false;
+  };
+
+  // from the fastest to the slowest way through
+  struct Cycles {
+    int min = 0;
+    int max = 0;
+  };
+
+  struct Line {
+    Source source;
+    int cycles = 0;   // base, 0 for data
+    int penalty = 0;  // extra cycles of a taken branch, or of an indexed read that may cross a page
+    bool branch = false;
+    int target = -1;  // of a branch or an absolute JMP
+  };
+
+  // the lines from a label to the next one; a loop runs from the label to the last jump back to it
+  struct Block {
+    QString label;
+    int first;
+    int last;
+    Cycles cycles;
+    int loopEnd = -1;
+    Cycles loop; // per iteration, with the jump back taken
+  };
+
+  // of code that costs a cycle more than it would if laid out differently
+  struct Warning {
+    enum Kind { BranchCrossesPage, TableCrossesPage };
+
+    Kind kind;
+    int line;
+    Address address; // the branch target or the start of the table
+  };
+
+  explicit Listing(std::vector<Source> = {});
+
+  // follows an edit: lines [first, first + removed) are replaced with as many empty ones as added, to be given
+  // their sources before the next update
+  void replaceLines(int first, int removed, int added);
+  void setSource(int line, Source);
+
+  // sums the blocks again, returns the lines whose annotation may have changed since the previous update
+  std::vector<int> update();
+
+  const std::vector<Line>& lines() const { return lineList; }
+  const std::vector<Block>& blocks() const { return blockList; }
+  const std::vector<Warning>& warnings() const { return warningList; }
+  static QString formatWarning(const Warning&);
+
+  // of a line, e.g. "4", "4+1" for an indexed read that may cross a page, "2/3" for a branch not taken/taken;
+  // a line with a label adds the totals of its block, a line with a warning says so
+  QString annotation(int line) const;
+
+  // columns of address, bytes, cycles and source, followed by the totals of all labels and the warnings
+  QString toText() const;
+
+private:
+  std::vector<Line> lineList;
+  std::vector<Block> blockList;
+  std::vector<int> blockOfLine; // -1 where no label starts
+  std::vector<Warning> warningList;
+  std::vector<int> warningOfLine; // -1 for none
+  std::vector<bool> sourceChanged;
+
+  void time(Line&);
+  void sumBlocks();
+  void findPageCrossings();
+  static QString formatCycles(Cycles);
+  static QString formatLine(const Line&);
+  QString formatBlock(const Block&) const;
+};
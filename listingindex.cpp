@@ -0,0 +1,64 @@
+#include "listingindex.h"
+#include "disassembler.h"
+#include "instructiontable.h"
+
+ListingIndex::ListingIndex(const Memory& memory, const CodeAnalyzer& analyzer) : memory(memory), analyzer(analyzer) {
+  rebuild();
+}
+
+void ListingIndex::rebuild() {
+  rowAddresses.clear();
+  rowLengths.clear();
+  for (uint32_t addr = 0; addr < Memory::Size;) {
+    const auto row = static_cast<uint16_t>(rowAddresses.size());
+    const auto length = lineLength(addr);
+    rowAddresses.push_back(static_cast<Address>(addr));
+    rowLengths.push_back(length);
+    for (uint32_t end = addr + length; addr < end; addr++) rowOfAddress[addr] = row;
+  }
+}
+
+// from the row before the range, as a data row ends at the next opcode, until rows start where they did before
+void ListingIndex::update(AddressRange changed) {
+  if (!changed.valid()) return;
+
+  const auto firstRow = rowOf(static_cast<Address>(changed.first ? changed.first - 1 : 0));
+  std::vector<Address> addresses;
+  std::vector<uint8_t> lengths;
+  uint32_t addr = rowAddress(firstRow);
+  while (addr < Memory::Size && (addr <= changed.last || !isRowStart(static_cast<Address>(addr)))) {
+    addresses.push_back(static_cast<Address>(addr));
+    lengths.push_back(lineLength(addr));
+    addr += lengths.back();
+  }
+
+  const auto lastRow = addr < Memory::Size ? rowOf(static_cast<Address>(addr)) : rows();
+  rowAddresses.erase(rowAddresses.begin() + firstRow, rowAddresses.begin() + lastRow);
+  rowAddresses.insert(rowAddresses.begin() + firstRow, addresses.begin(), addresses.end());
+  rowLengths.erase(rowLengths.begin() + firstRow, rowLengths.begin() + lastRow);
+  rowLengths.insert(rowLengths.begin() + firstRow, lengths.begin(), lengths.end());
+  for (size_t i = 0; i < addresses.size(); i++) {
+    for (uint32_t a = addresses[i]; a < addresses[i] + lengths[i]; a++)
+      rowOfAddress[a] = static_cast<uint16_t>(firstRow + static_cast<int>(i));
+  }
+
+  // the rows after keep their addresses, only their numbers move
+  if (const auto moved = static_cast<int>(addresses.size()) - (lastRow - firstRow)) {
+    for (; addr < Memory::Size; addr++) rowOfAddress[addr] = static_cast<uint16_t>(rowOfAddress[addr] + moved);
+  }
+}
+
+uint8_t ListingIndex::lineLength(uint32_t addr) const {
+  const auto remaining = Memory::Size - addr;
+  if (analyzer.kind(static_cast<Address>(addr)) == CodeAnalyzer::OpcodeByte) {
+    return static_cast<uint8_t>(std::min<size_t>(InstructionTable[memory[static_cast<Address>(addr)]].size, remaining));
+  }
+
+  // operand bytes not preceded by their opcode (wrapped around the end of memory) count as data too
+  uint8_t n = 1;
+  while (n < Disassembler::MaxDataBytes && n < remaining &&
+         analyzer.kind(static_cast<Address>(addr + n)) != CodeAnalyzer::OpcodeByte) {
+    n++;
+  }
+  return n;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "codeanalyzer.h"
+#include "commondefs.h"
+#include "memory.h"
+#include <array>
+#include <vector>
+
+// Splits memory into listing lines (instructions and groups of data bytes) with constant time lookups in both directions
+class ListingIndex {
+public:
+  ListingIndex(const Memory&, const CodeAnalyzer&);
+
+  void rebuild();
+  // after the kinds or opcodes of the range changed
+  void update(AddressRange);
+
+  int rows() const { return static_cast<int>(rowAddresses.size()); }
+  int rowOf(Address addr) const { return rowOfAddress[addr]; }
+  Address rowAddress(int row) const { return rowAddresses[static_cast<size_t>(row)]; }
+  uint8_t rowLength(int row) const { return rowLengths[static_cast<size_t>(row)]; }
+  bool isRowStart(Address addr) const { return rowAddress(rowOf(addr)) == addr; }
+  bool isDataRow(int row) const { return analyzer.kind(rowAddress(row)) != CodeAnalyzer::OpcodeByte; }
+
+private:
+  const Memory& memory;
+  const CodeAnalyzer& analyzer;
+  std::vector<Address> rowAddresses;
+  std::vector<uint8_t> rowLengths;
+  std::array<uint16_t, Memory::Size> rowOfAddress{};
+
+  uint8_t lineLength(uint32_t addr) const;
+};
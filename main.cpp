@@ -1,7 +1,9 @@
+#include "assemblyworker.h"
 #include "commondefs.h"
 #include "config.h"
 #include "emulatorstate.h"
 #include "filedatastorage.h"
+#include "framepacing.h"
 #include "mainwindow.h"
 #include <QApplication>
 #include <QDir>
@@ -16,6 +18,8 @@ Q_DECLARE_METATYPE(Address)
 Q_DECLARE_METATYPE(AddressRange)
 Q_DECLARE_METATYPE(FileOperationCallBack)
 Q_DECLARE_METATYPE(Frequency)
+Q_DECLARE_METATYPE(FramePacing)
+Q_DECLARE_METATYPE(AssemblyReport)
 
 int main(int argc, char* argv[]) {
 
@@ -30,6 +34,8 @@ int main(int argc, char* argv[]) {
   qRegisterMetaType<Data>();
   qRegisterMetaType<AddressRange>();
   qRegisterMetaType<FileOperationCallBack>();
+  qRegisterMetaType<FramePacing>();
+  qRegisterMetaType<AssemblyReport>();
 
   QApplication app(argc, argv);
   QApplication::setStyle(QStyleFactory::create("Fusion"));
@@ -11,16 +11,17 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent), ui(new Ui::MainWi
   ui->setupUi(this);
   initConfigStorage();
   startEmulator();
+  codeAnalyzer = std::make_unique<CodeAnalyzer>(emulator->memoryView());
 
-  cpuWidget = new CpuWidget(this, emulator->memoryView());
+  cpuWidget = new CpuWidget(this, emulator->memoryView(), *codeAnalyzer);
   this->addDockWidget(Qt::RightDockWidgetArea, cpuWidget);
 
   videoWidget = new VideoWidget(this, emulator->memoryView());
   this->addDockWidget(Qt::LeftDockWidgetArea, videoWidget);
 
-  assemblerWidget = new AssemblerWidget(this, emulator->memoryRef());
+  assemblerWidget = new AssemblerWidget(this);
   memoryWidget = new MemoryWidget(this, emulator->memoryView());
-  disassemblerWidget = new DisassemblerWidget(this, emulator->memoryView());
+  disassemblerWidget = new DisassemblerWidget(this, emulator->memoryView(), *codeAnalyzer);
   viewWidget = new CentralWidget(this, assemblerWidget, memoryWidget, disassemblerWidget);
   setCentralWidget(viewWidget);
 
@@ -41,21 +42,39 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent), ui(new Ui::MainWi
   connect(cpuWidget, &CpuWidget::nmiRequested, emulator, &Emulator::triggerNmi, Qt::DirectConnection);
   connect(cpuWidget, &CpuWidget::irqRequested, emulator, &Emulator::triggerIrq, Qt::DirectConnection);
 
-  connect(emulator, &Emulator::stateChanged, cpuWidget, &CpuWidget::updateState);
-  connect(emulator, &Emulator::stateChanged, disassemblerWidget, &DisassemblerWidget::updateState);
-  connect(emulator, &Emulator::memoryContentChanged, cpuWidget, &CpuWidget::updateOnChange);
-  connect(emulator, &Emulator::memoryContentChanged, memoryWidget, &MemoryWidget::updateOnChange);
-  connect(emulator, &Emulator::memoryContentChanged, disassemblerWidget, &DisassemblerWidget::updateOnChange);
-  connect(emulator, &Emulator::memoryContentChanged, videoWidget, &VideoWidget::updateOnChange);
+  refreshScheduler = new RefreshScheduler(this);
+  refreshScheduler->addView(
+      cpuWidget, [this](AddressRange range) { cpuWidget->updateOnChange(range); },
+      [this](const EmulatorState& es) { cpuWidget->updateState(es); });
+  refreshScheduler->addView(memoryWidget, [this](AddressRange range) { memoryWidget->updateOnChange(range); });
+  refreshScheduler->addView(
+      disassemblerWidget, [this](AddressRange range) { disassemblerWidget->updateOnChange(range); },
+      [this](const EmulatorState& es) { disassemblerWidget->updateState(es); });
+  refreshScheduler->addView(
+      videoWidget, [this](AddressRange range) { videoWidget->updateOnChange(range); },
+      [this](const EmulatorState& es) { videoWidget->updateState(es); });
+  refreshScheduler->addView(assemblerWidget, {}, [this](const EmulatorState& es) { assemblerWidget->updateState(es); });
+
+  connect(emulator, &Emulator::stateChanged, refreshScheduler, &RefreshScheduler::publishState);
+  connect(emulator, &Emulator::memoryContentChanged, refreshScheduler, &RefreshScheduler::publishMemoryChange);
   connect(emulator, &Emulator::operationCompleted, this, &MainWindow::showMessage);
+  connect(emulator, &Emulator::frameReady, videoWidget, &VideoWidget::presentFrame);
+  connect(cpuWidget, &CpuWidget::frameRateChanged, videoWidget, &VideoWidget::changeFrameRate);
+  videoWidget->changeFrameRate(cpuWidget->frameRate());
+  connect(videoWidget, &VideoWidget::operationCompleted, this, &MainWindow::showMessage);
+  connect(videoWidget, &VideoWidget::defaultFrameBufferChanged, emulator, &Emulator::setDefaultFrameBuffer, Qt::DirectConnection);
 
   connect(assemblerWidget, &AssemblerWidget::newFileCreated, [&] { changeAsmFileName(""); });
   connect(assemblerWidget, &AssemblerWidget::fileLoaded, this, &MainWindow::changeAsmFileName);
   connect(assemblerWidget, &AssemblerWidget::fileSaved, this, &MainWindow::changeAsmFileName);
   connect(assemblerWidget, &AssemblerWidget::operationCompleted, this, &MainWindow::showMessage);
-  connect(assemblerWidget, &AssemblerWidget::codeWritten, emulator, &Emulator::memoryContentChanged);
+  connect(assemblerWidget, &AssemblerWidget::codeAssembled, this, &MainWindow::clearEntryPoints);
+  connect(assemblerWidget, &AssemblerWidget::codeAssembled, emulator, &Emulator::commitPatch, Qt::DirectConnection);
+  connect(assemblerWidget, &AssemblerWidget::patchWhileRunningChanged, emulator, &Emulator::setPatchWhileRunning,
+          Qt::DirectConnection);
   connect(assemblerWidget, &AssemblerWidget::programCounterChanged, emulator, &Emulator::changeProgramCounter);
 
+  connect(memoryWidget, &MemoryWidget::loadFromFileRequested, this, &MainWindow::clearEntryPoints);
   connect(memoryWidget, &MemoryWidget::loadFromFileRequested, emulator, &Emulator::loadMemoryFromFile);
   connect(memoryWidget, &MemoryWidget::saveToFileRequested, emulator, &Emulator::saveMemoryToFile);
 
@@ -63,7 +82,7 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent), ui(new Ui::MainWi
 
   if (!config.asmFileName.isEmpty()) assemblerWidget->loadFile(config.asmFileName);
   videoWidget->setFrameBufferAddress(0x200);
-  propagateState(emulator->state());
+  refreshScheduler->publishState(emulator->state());
 }
 
 MainWindow::~MainWindow() {
@@ -111,26 +130,16 @@ void MainWindow::startEmulator() {
   emulatorThread.setObjectName("emulator");
 }
 
-void MainWindow::propagateState(EmulatorState es) {
-
-  if (viewWidget->isVisible(memoryWidget)) {
-    const QSignalBlocker memoryBlocker(this->memoryWidget);
-    memoryWidget->updateOnChange(AddressRange::Max);
-  }
-
-  if (viewWidget->isVisible(disassemblerWidget)) {
-    const QSignalBlocker disassemblerBlocker(this->disassemblerWidget);
-    disassemblerWidget->updateState(es);
-    disassemblerWidget->updateOnChange(AddressRange::Max);
+void MainWindow::polling() {
+  // memory is not tracked while running, so everything may have changed
+  if (const auto es = emulator->state(); es.running()) {
+    refreshScheduler->publishState(es);
+    refreshScheduler->publishMemoryChange(AddressRange::Max);
   }
-
-  const QSignalBlocker cpuBlocker(this->cpuWidget);
-  cpuWidget->updateState(es);
-
-  const QSignalBlocker videoBlocker(this->videoWidget);
-  videoWidget->updateView();
 }
 
-void MainWindow::polling() {
-  if (const auto es = emulator->state(); es.running()) propagateState(es);
+// the program counters seen so far belong to the code being replaced
+void MainWindow::clearEntryPoints() {
+  cpuWidget->clearEntryPoints();
+  disassemblerWidget->clearEntryPoints();
 }
@@ -9,10 +9,12 @@
 #include "emulator.h"
 #include "filedatastorage.h"
 #include "memorywidget.h"
+#include "refreshscheduler.h"
 #include "videowidget.h"
 #include <QMainWindow>
 #include <QThread>
 #include <QTimer>
+#include <memory>
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -42,17 +44,19 @@ private:
   CpuWidget* cpuWidget;
   VideoWidget* videoWidget;
   Emulator* emulator;
+  std::unique_ptr<CodeAnalyzer> codeAnalyzer; // shared by the disassembler views
   FileDataStorage<Config>* configStorage;
   Config config;
   QTimer* pollTimer;
+  RefreshScheduler* refreshScheduler;
   QThread emulatorThread;
 
   void initConfigStorage();
   void startEmulator();
-  void propagateState(EmulatorState);
 
 private slots:
   void polling();
+  void clearEntryPoints();
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,46 @@
+#include "memorypatch.h"
+
+size_t MemoryPatch::size() const {
+  size_t total = 0;
+  for (const auto& chunk : chunks) total += chunk.bytes.size();
+  return total;
+}
+
+AddressRange MemoryPatch::range() const {
+  AddressRange range;
+  for (const auto& chunk : chunks) {
+    range.expand(chunk.first);
+    range.expand(static_cast<Address>(chunk.first + chunk.bytes.size() - 1));
+  }
+  return range;
+}
+
+void MemoryPatch::applyTo(Memory& memory) const {
+  for (const auto& chunk : chunks) std::copy(chunk.bytes.begin(), chunk.bytes.end(), memory.begin() + chunk.first);
+}
+
+void StagingArea::markWritten(AddressRange range) {
+  if (!range.valid()) return;
+
+  std::fill(written.begin() + range.first, written.begin() + range.last + 1, true);
+  writtenRange.expand(range.first);
+  writtenRange.expand(range.last);
+}
+
+MemoryPatch StagingArea::takePatch() {
+  MemoryPatch patch;
+  if (!writtenRange.valid()) return patch;
+
+  for (uint32_t addr = writtenRange.first; addr <= writtenRange.last; addr++) {
+    if (!written[addr]) continue;
+
+    auto& chunk = patch.chunks.emplace_back();
+    chunk.first = static_cast<Address>(addr);
+    for (; addr <= writtenRange.last && written[addr]; addr++) {
+      chunk.bytes.push_back(memory[static_cast<Address>(addr)]);
+      written[addr] = false;
+    }
+  }
+  writtenRange = AddressRange::Invalid;
+  return patch;
+}
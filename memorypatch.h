@@ -0,0 +1,35 @@
+#pragma once
+
+#include "addressrange.h"
+#include "commondefs.h"
+#include "memory.h"
+#include <array>
+#include <vector>
+
+// Disjoint runs of bytes to be written to memory in one go
+struct MemoryPatch {
+  struct Chunk {
+    Address first;
+    Data bytes;
+  };
+
+  std::vector<Chunk> chunks;
+
+  bool empty() const { return chunks.empty(); }
+  size_t size() const;
+  AddressRange range() const;
+  void applyTo(Memory&) const;
+};
+
+// A private memory image that remembers which bytes were written since the last patch was taken
+class StagingArea {
+public:
+  Memory& image() { return memory; }
+  void markWritten(AddressRange);
+  MemoryPatch takePatch();
+
+private:
+  Memory memory;
+  std::array<bool, Memory::Size> written{};
+  AddressRange writtenRange;
+};
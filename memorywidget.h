@@ -4,6 +4,7 @@
 #include "addressrange.h"
 #include "commondefs.h"
 #include "emulatorstate.h"
+#include "hexview.h"
 #include "memory.h"
 #include <QWidget>
 
@@ -27,23 +28,16 @@ signals:
 public slots:
   void updateOnChange(AddressRange);
 
-protected:
-  void resizeEvent(QResizeEvent*) override;
-
 private:
   Ui::MemoryWidget* ui;
-  const Memory& memory;
-  AddressRange addressRange = AddressRange::Invalid;
-
-  void updateView();
-  int rowsInView() const;
-  int colsInView() const;
+  HexView* view;
 
 private slots:
   void loadFromFile();
   void saveToFile();
   void changeStartAddress(Address);
   void changeEndAddress(Address);
+  void updateVisibleRange(Address first, Address last);
 };
 
 #endif // MEMORYWIDGET_H
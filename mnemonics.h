@@ -3,8 +3,63 @@
 #include "instructiontype.h"
 #include <QString>
 #include <algorithm>
+#include <array>
 #include <map>
 
 using MnemonicTableType = std::map<InstructionType, const char*>;
 
+// indexed by InstructionType
+constexpr std::array<const char*, KIL + 1> Mnemonics{
+    "???", "ADC", "SBC", "AND", "ORA", "ASL", "LSR", "EOR", "ROL", "ROR", "BIT", "CMP", "CPX", "CPY", "INC", "INX", "INY", "DEC", "DEX",
+    "DEY", "BCC", "BCS", "BEQ", "BMI", "BNE", "BPL", "BVC", "BVS", "CLC", "CLD", "CLI", "CLV", "SEC", "SED", "SEI", "JMP", "JSR", "BRK",
+    "RTI", "RTS", "LDA", "LDX", "LDY", "STA", "STX", "STY", "TAX", "TAY", "TSX", "TXA", "TYA", "TXS", "PHA", "PHP", "PLA", "PLP", "NOP",
+    "KIL"};
+
+static_assert(Mnemonics[BVS][2] == 'S' && Mnemonics[JSR][1] == 'S' && Mnemonics[PLP][2] == 'P' && Mnemonics[KIL][0] == 'K');
+
+// perfect hash of the mnemonics packed into 5 bits per letter, which also makes it case insensitive
+constexpr uint32_t MnemonicHashMultiplier = 0x0987412d;
+constexpr int MnemonicHashBits = 7;
+
+constexpr uint32_t packMnemonic(char16_t a, char16_t b, char16_t c) {
+  return static_cast<uint32_t>((a & 0x1f) << 10 | (b & 0x1f) << 5 | (c & 0x1f));
+}
+
+constexpr size_t mnemonicHash(uint32_t packed) {
+  return (packed * MnemonicHashMultiplier) >> (32 - MnemonicHashBits);
+}
+
+constexpr std::array<InstructionType, 1 << MnemonicHashBits> MnemonicHashTable = [] {
+  std::array<InstructionType, 1 << MnemonicHashBits> table{};
+  for (size_t type = ADC; type <= KIL; type++) {
+    const auto m = Mnemonics[type];
+    table[mnemonicHash(packMnemonic(m[0], m[1], m[2]))] = static_cast<InstructionType>(type);
+  }
+  return table;
+}();
+
+static_assert(
+    [] {
+      size_t used = 0;
+      for (const auto type : MnemonicHashTable) used += type != None;
+      return used == KIL;
+    }(),
+    "mnemonic hash collision, find another multiplier");
+
+constexpr bool isAsciiLetter(char16_t c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+// None if the letters are not a mnemonic
+constexpr InstructionType findMnemonic(char16_t a, char16_t b, char16_t c) {
+  if (!isAsciiLetter(a) || !isAsciiLetter(b) || !isAsciiLetter(c)) return None;
+
+  const auto packed = packMnemonic(a, b, c);
+  const auto type = MnemonicHashTable[mnemonicHash(packed)];
+  const auto m = Mnemonics[type];
+  return packMnemonic(m[0], m[1], m[2]) == packed ? type : None;
+}
+
+static_assert(findMnemonic('l', 'd', 'a') == LDA && findMnemonic('K', 'I', 'L') == KIL && findMnemonic('L', 'D', 'B') == None);
+
 extern const MnemonicTableType MnemonicTable;
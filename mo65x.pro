@@ -1,4 +1,4 @@
-QT       += core gui widgets testlib
+QT       += core gui widgets testlib concurrent
 
 TEMPLATE = app
 CONFIG += c++17
@@ -17,9 +17,13 @@ SOURCES += \
     addressrange.cpp \
     assembler.cpp \
     assemblerwidget.cpp \
+    assemblyworker.cpp \
     assemblyresult.cpp \
+    batchassembler.cpp \
+    buildcache.cpp \
     bytespinbox.cpp \
     centralwidget.cpp \
+    codeanalyzer.cpp \
     config.cpp \
     cpu.cpp \
     cpustate.cpp \
@@ -27,29 +31,68 @@ SOURCES += \
     disassembler.cpp \
     disassemblerview.cpp \
     disassemblerwidget.cpp \
+    disassemblycache.cpp \
     screenwidget.cpp \
+    sourceeditor.cpp \
+    sourcemap.cpp \
     emulator.cpp \
     executionstatistics.cpp \
     filedatastorage.cpp \
+    framerecorder.cpp \
+    headlesscapture.cpp \
+    hexview.cpp \
+    incrementalassembler.cpp \
+    lineparser.cpp \
+    linker.cpp \
+    listing.cpp \
+    listingindex.cpp \
     main.cpp \
     mainwindow.cpp \
     memory.cpp \
+    memorypatch.cpp \
     memorywidget.cpp \
     mnemonics.cpp \
+    moduleassembler.cpp \
+    objectmodule.cpp \
+    peepholeoptimizer.cpp \
+    projectbuilder.cpp \
+    refreshscheduler.cpp \
     runlevel.cpp \
     symboltable.cpp \
+    videodevice.cpp \
     videowidget.cpp \
     wordspinbox.cpp \
     test/assemblertest.cpp \
     test/instructionstest.cpp \
-    test/flagstest.cpp
+    test/flagstest.cpp \
+    test/disassemblertest.cpp \
+    test/codeanalyzertest.cpp \
+    test/videodevicetest.cpp \
+    test/framerecordertest.cpp \
+    test/incrementalassemblertest.cpp \
+    test/memorypatchtest.cpp \
+    test/linkertest.cpp \
+    test/buildcachetest.cpp \
+    test/symboltabletest.cpp \
+    test/listingtest.cpp \
+    test/peepholeoptimizertest.cpp \
+    test/sourcemaptest.cpp \
+    test/batchassemblertest.cpp \
+    test/refreshschedulertest.cpp \
+    test/headlesscapturetest.cpp \
+    test/addressrangetest.cpp \
+    test/testfiles.cpp
 
 HEADERS += \
     addressrange.h \
     assembler.h \
     assemblerwidget.h \
+    assemblyworker.h \
     assemblyresult.h \
+    batchassembler.h \
+    buildcache.h \
     centralwidget.h \
+    codeanalyzer.h \
     commondefs.h \
     commonformatters.h \
     config.h \
@@ -64,38 +107,73 @@ HEADERS += \
     disassembler.h \
     disassemblerview.h \
     disassemblerwidget.h \
+    disassemblycache.h \
     operandvalue.h \
     screenwidget.h \
+    sourceeditor.h \
+    sourcemap.h \
     emulator.h \
     emulatorstate.h \
     executionstatistics.h \
     filedatastorage.h \
+    framepacing.h \
+    framerecorder.h \
+    headlesscapture.h \
+    hexview.h \
+    incrementalassembler.h \
     instruction.h \
     instructiontable.h \
     instructiontype.h \
+    lineparser.h \
+    linker.h \
+    listing.h \
+    listingindex.h \
     mainwindow.h \
     memory.h \
+    memorypatch.h \
     memorywidget.h \
     mnemonics.h \
+    moduleassembler.h \
+    objectmodule.h \
+    peepholeoptimizer.h \
     operandptr.h \
     operandsformat.h \
     processorstatus.h \
+    projectbuilder.h \
+    refreshscheduler.h \
     registers.h \
     runlevel.h \
     stackpointer.h \
     symboltable.h \
     uitools.h \
+    videodevice.h \
     videowidget.h \
     wordspinbox.h \
     test/assemblertest.h \
     test/instructionstest.h \
-    test/flagstest.h
+    test/flagstest.h \
+    test/disassemblertest.h \
+    test/codeanalyzertest.h \
+    test/videodevicetest.h \
+    test/framerecordertest.h \
+    test/incrementalassemblertest.h \
+    test/memorypatchtest.h \
+    test/linkertest.h \
+    test/buildcachetest.h \
+    test/symboltabletest.h \
+    test/listingtest.h \
+    test/peepholeoptimizertest.h \
+    test/sourcemaptest.h \
+    test/batchassemblertest.h \
+    test/refreshschedulertest.h \
+    test/headlesscapturetest.h \
+    test/addressrangetest.h \
+    test/testfiles.h
 
 FORMS += \
     assemblerwidget.ui \
     centralwidget.ui \
     cpuwidget.ui \
-    disassemblerview.ui \
     disassemblerwidget.ui \
     mainwindow.ui \
     memorywidget.ui \
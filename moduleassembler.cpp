@@ -0,0 +1,149 @@
+#include "moduleassembler.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStringList>
+#include <QTextStream>
+
+ModuleAssembler::ModuleAssembler() : scratch(std::make_unique<Memory>()), assembler(*scratch) {
+}
+
+void ModuleAssembler::setOptimize(bool enable) {
+  // assembled the other way, so no longer up to date
+  if (enable != optimize) sourceFiles.clear();
+  optimize = enable;
+}
+
+bool ModuleAssembler::assemble(const QString& fileName) {
+  QString source;
+  if (!readSource(fileName, source)) {
+    sourceFiles.clear();
+    lines.clear();
+    errorList = {{fileName, -1, 0, AssemblyResult::FileNotFound, {}}};
+    return false;
+  }
+  return assemble(fileName, source);
+}
+
+bool ModuleAssembler::assemble(const QString& fileName, const QString& source) {
+  sourceFiles.clear();
+  lines.clear();
+  errorList.clear();
+  rewriteList.clear();
+  expand(fileName, source, 0);
+  if (!errorList.empty()) return false;
+
+  assembler.setObjectOutput(&object);
+  if (optimize) optimizeLines();
+  for (auto scans = 1;; scans++) {
+    if (!runPass(Assembler::ProcessingMode::ScanForSymbols)) return false;
+    if (assembler.sizesSettled()) break;
+    if (scans == MaxScanPasses) {
+      errorList.push_back({fileName, -1, 0, AssemblyResult::SizesNotSettled, {}});
+      return false;
+    }
+  }
+  if (!runPass(Assembler::ProcessingMode::EmitCode)) return false;
+
+  for (const auto& source : sourceFiles) object.files.append(source.fileName);
+  return true;
+}
+
+void ModuleAssembler::optimizeLines() {
+  std::vector<ParsedLine> parsed;
+  parsed.reserve(lines.size());
+  for (const auto& line : lines) parsed.push_back(line.parsed);
+
+  const auto rewrites = PeepholeOptimizer(assembler).optimize(parsed);
+  for (const auto& rewrite : rewrites) {
+    const auto& line = lines[static_cast<size_t>(rewrite.line)];
+    rewriteList.push_back({sourceFiles[static_cast<size_t>(line.file)].fileName, line.number, rewrite.kind,
+                           rewrite.bytesSaved, rewrite.cyclesSaved});
+  }
+  if (rewrites.empty()) return;
+
+  for (size_t i = 0; i < lines.size(); i++) lines[i].parsed = std::move(parsed[i]);
+}
+
+bool ModuleAssembler::runPass(Assembler::ProcessingMode mode) {
+  assembler.initPreserveSymbols();
+  assembler.changeMode(mode);
+  for (const auto& line : lines) {
+    const auto section = static_cast<int>(object.sections.size()) - 1;
+    const auto offset = object.sections.back().bytes.size();
+    if (const auto result = assembler.processLine(line.parsed); result != AssemblyResult::Ok)
+      addError(line.file, line.number, assembler.errorColumn(), result, line.parsed);
+    else
+      addLineInfo(line, section, offset);
+  }
+  return errorList.empty();
+}
+
+bool ModuleAssembler::upToDate() const {
+  if (sourceFiles.empty()) return false;
+
+  QString contents;
+  for (const auto& source : sourceFiles) {
+    if (!readSource(source.fileName, contents) || contents != source.contents) return false;
+  }
+  return true;
+}
+
+bool ModuleAssembler::readSource(const QString& fileName, QString& contents) {
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return false;
+  contents = QTextStream(&file).readAll();
+  return true;
+}
+
+void ModuleAssembler::expand(const QString& fileName, const QString& source, int depth) {
+  const auto file = static_cast<int>(sourceFiles.size());
+  sourceFiles.push_back({fileName, source});
+
+  auto number = 0;
+  for (const auto& text : source.split('\n')) {
+    Line line{{}, file, number++};
+    if (const auto result = parser.parse(text, line.parsed); result != AssemblyResult::Ok) {
+      addError(file, line.number, parser.errorColumn(), result, line.parsed);
+    } else if (line.parsed.kind == ParsedLine::Include) {
+      include(line, depth);
+    } else {
+      lines.push_back(std::move(line));
+    }
+  }
+}
+
+// the label of an include line names the address where the included code starts
+void ModuleAssembler::include(const Line& line, int depth) {
+  if (!line.parsed.label.isEmpty()) {
+    auto label = line;
+    label.parsed.kind = ParsedLine::NoOperation;
+    lines.push_back(std::move(label));
+  }
+
+  const auto& includingFile = sourceFiles[static_cast<size_t>(line.file)].fileName;
+  const auto fileName = QFileInfo(includingFile).dir().filePath(line.parsed.includePath);
+  QString source;
+  if (depth == MaxIncludeDepth)
+    addError(line.file, line.number, line.parsed.operationColumn, AssemblyResult::IncludeTooDeep, line.parsed);
+  else if (!readSource(fileName, source))
+    addError(line.file, line.number, line.parsed.operationColumn, AssemblyResult::IncludeNotFound, line.parsed);
+  else
+    expand(fileName, source, depth + 1);
+}
+
+// a line that emits code cannot start a section, so its code follows what was in the section before
+void ModuleAssembler::addLineInfo(const Line& line, int section, size_t offset) {
+  const auto size = object.sections.back().bytes.size() - offset;
+  if (section != static_cast<int>(object.sections.size()) - 1 || !size) return;
+
+  object.lines.push_back({section, static_cast<Address>(offset), static_cast<Address>(size), line.file, line.number});
+}
+
+void ModuleAssembler::addError(int file, int line, int column, AssemblyResult result, const ParsedLine& parsed) {
+  QString symbol;
+  for (const auto& op : parsed.operands) {
+    if (op.column == column) symbol = op.symbol;
+  }
+  errorList.push_back({sourceFiles[static_cast<size_t>(file)].fileName, line, column, result, symbol});
+}
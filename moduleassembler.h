@@ -0,0 +1,83 @@
+#pragma once
+
+#include "assembler.h"
+#include "objectmodule.h"
+#include "peepholeoptimizer.h"
+#include <QString>
+#include <memory>
+#include <vector>
+
+// Assembles a source file and the files it includes into an object module
+class ModuleAssembler {
+public:
+  static constexpr int MaxIncludeDepth = 16;
+  // each scan but the last moves an instruction to zero page, so only pathological sources come close
+  static constexpr int MaxScanPasses = 32;
+
+  struct SourceFile {
+    QString fileName;
+    QString contents;
+  };
+
+  struct Error {
+    QString fileName;
+    int line; // counted from 0, -1 for the whole file
+    int column;
+    AssemblyResult result;
+    QString symbol;
+  };
+
+  struct Rewrite {
+    QString fileName;
+    int line; // counted from 0
+    PeepholeOptimizer::Rewrite::Kind kind;
+    int bytesSaved;
+    int cyclesSaved;
+  };
+
+  ModuleAssembler();
+
+  // the sources go through the PeepholeOptimizer before they are assembled
+  void setOptimize(bool);
+
+  // returns false if there were errors; includes are found relative to the file that includes them
+  bool assemble(const QString& fileName);
+  bool assemble(const QString& fileName, const QString& source);
+
+  const ObjectModule& module() const { return object; }
+  const std::vector<Error>& errors() const { return errorList; }
+  const std::vector<Rewrite>& rewrites() const { return rewriteList; }
+
+  // the file itself first, then its includes in the order read
+  const std::vector<SourceFile>& sources() const { return sourceFiles; }
+
+  // true if none of the sources changed on disk since they were assembled
+  bool upToDate() const;
+
+  // as the sources are read for assembly
+  static bool readSource(const QString& fileName, QString& contents);
+
+private:
+  struct Line {
+    ParsedLine parsed;
+    int file;
+    int number;
+  };
+
+  std::unique_ptr<Memory> scratch;
+  Assembler assembler;
+  LineParser parser;
+  ObjectModule object;
+  std::vector<SourceFile> sourceFiles;
+  std::vector<Line> lines;
+  std::vector<Error> errorList;
+  std::vector<Rewrite> rewriteList;
+  bool optimize = false;
+
+  void optimizeLines();
+  bool runPass(Assembler::ProcessingMode);
+  void expand(const QString& fileName, const QString& source, int depth);
+  void include(const Line&, int depth);
+  void addLineInfo(const Line&, int section, size_t offset);
+  void addError(int file, int line, int column, AssemblyResult, const ParsedLine&);
+};
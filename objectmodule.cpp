@@ -0,0 +1,117 @@
+#include "objectmodule.h"
+#include <QDataStream>
+
+QByteArray ObjectModule::toByteArray() const {
+  QByteArray buffer(Magic, sizeof Magic);
+  QDataStream out(&buffer, QIODevice::WriteOnly | QIODevice::Append);
+  out << FormatVersion;
+
+  out << static_cast<quint32>(sections.size());
+  for (const auto& section : sections) {
+    out << section.relocatable << section.origin
+        << QByteArray(reinterpret_cast<const char*>(section.bytes.data()), static_cast<int>(section.bytes.size()));
+  }
+
+  out << static_cast<quint32>(exports.size());
+  for (const auto& symbol : exports) out << symbol.name << symbol.relocatable << symbol.value;
+
+  out << static_cast<quint32>(labels.size());
+  for (const auto& symbol : labels) out << symbol.name << symbol.relocatable << symbol.value;
+
+  out << static_cast<quint32>(relocations.size());
+  for (const auto& r : relocations) {
+    out << static_cast<quint8>(r.kind) << static_cast<quint8>(r.selector) << static_cast<qint32>(r.section) << r.offset
+        << r.symbol << r.relocatable << r.addend;
+  }
+
+  out << static_cast<quint32>(files.size());
+  for (const auto& file : files) out << file;
+
+  out << static_cast<quint32>(lines.size());
+  for (const auto& line : lines) {
+    out << static_cast<qint32>(line.section) << line.offset << line.size << static_cast<qint32>(line.file)
+        << static_cast<qint32>(line.number);
+  }
+  return buffer;
+}
+
+std::optional<ObjectModule> ObjectModule::fromByteArray(const QByteArray& buffer) {
+  if (!buffer.startsWith(QByteArray(Magic, sizeof Magic))) return std::nullopt;
+
+  QDataStream in(buffer.mid(sizeof Magic));
+  quint32 version = 0;
+  in >> version;
+  if (version != FormatVersion) return std::nullopt;
+
+  ObjectModule module;
+  quint32 count = 0;
+  in >> count;
+  for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++) {
+    Section section;
+    QByteArray bytes;
+    in >> section.relocatable >> section.origin >> bytes;
+    section.bytes.assign(bytes.begin(), bytes.end());
+    module.sections.push_back(std::move(section));
+  }
+
+  in >> count;
+  for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++) {
+    Symbol symbol;
+    in >> symbol.name >> symbol.relocatable >> symbol.value;
+    module.exports.push_back(std::move(symbol));
+  }
+
+  in >> count;
+  for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++) {
+    Symbol symbol;
+    in >> symbol.name >> symbol.relocatable >> symbol.value;
+    module.labels.push_back(std::move(symbol));
+  }
+
+  in >> count;
+  for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++) {
+    Relocation r;
+    quint8 kind = 0;
+    quint8 selector = 0;
+    qint32 section = 0;
+    in >> kind >> selector >> section >> r.offset >> r.symbol >> r.relocatable >> r.addend;
+    if (kind > Relocation::Displacement || selector > ParsedOperand::HiByte) return std::nullopt;
+    r.kind = static_cast<Relocation::Kind>(kind);
+    r.selector = static_cast<ParsedOperand::ByteSelector>(selector);
+    r.section = section;
+    module.relocations.push_back(std::move(r));
+  }
+
+  in >> count;
+  for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++) {
+    QString file;
+    in >> file;
+    module.files.append(file);
+  }
+
+  in >> count;
+  for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++) {
+    qint32 section = 0;
+    qint32 file = 0;
+    qint32 number = 0;
+    Line line;
+    in >> section >> line.offset >> line.size >> file >> number;
+    line.section = section;
+    line.file = file;
+    line.number = number;
+    module.lines.push_back(line);
+  }
+
+  if (in.status() != QDataStream::Ok) return std::nullopt;
+  const auto validSection = [&](int section) { return section >= 0 && static_cast<size_t>(section) < module.sections.size(); };
+  for (const auto& r : module.relocations) {
+    if (!validSection(r.section)) return std::nullopt;
+    // the linker writes the field without checking it again
+    const auto fieldSize = r.kind == Relocation::Word ? 2u : 1u;
+    if (r.offset + fieldSize > module.sections[static_cast<size_t>(r.section)].bytes.size()) return std::nullopt;
+  }
+  for (const auto& line : module.lines) {
+    if (!validSection(line.section) || line.file < 0 || line.file >= static_cast<int>(module.files.size())) return std::nullopt;
+  }
+  return module;
+}
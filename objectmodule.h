@@ -0,0 +1,60 @@
+#pragma once
+
+#include "commondefs.h"
+#include "lineparser.h"
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <optional>
+#include <vector>
+
+// Output of assembling one source file: code that runs before the first .ORG is relocatable and placed by the linker,
+// every .ORG starts an absolute section
+struct ObjectModule {
+  static constexpr char Magic[8] = {'M', 'O', '6', '5', 'X', 'O', 'B', 'J'};
+  static constexpr quint32 FormatVersion = 3;
+
+  struct Section {
+    bool relocatable;
+    Address origin; // 0 for the relocatable section
+    Data bytes;
+  };
+
+  struct Symbol {
+    QString name;
+    bool relocatable; // the value is an offset into the relocatable section
+    Address value;
+  };
+
+  // a field to be filled in by the linker
+  struct Relocation {
+    enum Kind : uint8_t { DataByte, OperandByte, Word, Displacement };
+
+    Kind kind;
+    ParsedOperand::ByteSelector selector;
+    int section;
+    Address offset; // of the field in its section
+    QString symbol; // imported, empty for a symbol of the module
+    bool relocatable; // the addend is an offset into the relocatable section of the module
+    Address addend;
+  };
+
+  // the code of a source line, to map addresses back to the source
+  struct Line {
+    int section;
+    Address offset;
+    Address size;
+    int file; // index in files
+    int number; // counted from 0
+  };
+
+  std::vector<Section> sections;
+  std::vector<Symbol> exports;
+  std::vector<Symbol> labels; // every symbol the module defines, for symbol files and listings
+  std::vector<Relocation> relocations;
+  QStringList files; // the source file first, then its includes
+  std::vector<Line> lines;
+
+  QByteArray toByteArray() const;
+  static std::optional<ObjectModule> fromByteArray(const QByteArray&);
+};
@@ -0,0 +1,344 @@
+#include "peepholeoptimizer.h"
+#include "instructiontable.h"
+#include "moduleassembler.h"
+#include <algorithm>
+#include <map>
+
+static InstructionType loadOf(InstructionType store) {
+  switch (store) {
+  case STA: return LDA;
+  case STX: return LDX;
+  case STY: return LDY;
+  default: return None;
+  }
+}
+
+static InstructionType invertedBranch(InstructionType branch) {
+  switch (branch) {
+  case BCC: return BCS;
+  case BCS: return BCC;
+  case BEQ: return BNE;
+  case BNE: return BEQ;
+  case BMI: return BPL;
+  case BPL: return BMI;
+  case BVC: return BVS;
+  case BVS: return BVC;
+  default: return None;
+  }
+}
+
+// the indirect modes are left out, as a store through a pointer may change the pointer
+static bool addressesDirectly(OperandsFormat format) {
+  switch (format) {
+  case ZeroPage:
+  case ZeroPageX:
+  case ZeroPageY:
+  case Absolute:
+  case AbsoluteX:
+  case AbsoluteY: return true;
+  default: return false;
+  }
+}
+
+// sets N and Z without reading them, so whatever set them before does not matter
+static bool overwritesNZ(InstructionType type) {
+  switch (type) {
+  case LDA:
+  case LDX:
+  case LDY:
+  case AND:
+  case ORA:
+  case EOR:
+  case ADC:
+  case SBC:
+  case CMP:
+  case CPX:
+  case CPY:
+  case BIT:
+  case INC:
+  case INX:
+  case INY:
+  case DEC:
+  case DEX:
+  case DEY:
+  case ASL:
+  case LSR:
+  case ROL:
+  case ROR:
+  case TAX:
+  case TAY:
+  case TXA:
+  case TYA:
+  case TSX:
+  case PLA:
+  case PLP: return true;
+  default: return false;
+  }
+}
+
+static bool preservesCarry(InstructionType type) {
+  switch (type) {
+  case LDA:
+  case LDX:
+  case LDY:
+  case STA:
+  case STX:
+  case STY:
+  case AND:
+  case ORA:
+  case EOR:
+  case BIT:
+  case INC:
+  case INX:
+  case INY:
+  case DEC:
+  case DEX:
+  case DEY:
+  case TAX:
+  case TAY:
+  case TXA:
+  case TYA:
+  case TSX:
+  case TXS:
+  case PHA:
+  case PHP:
+  case PLA:
+  case CLD:
+  case SED:
+  case CLI:
+  case SEI:
+  case CLV:
+  case NOP:
+  case BEQ:
+  case BNE:
+  case BMI:
+  case BPL:
+  case BVC:
+  case BVS: return true;
+  default: return false;
+  }
+}
+
+static bool isInstruction(const ParsedLine& line, InstructionType type) {
+  return line.kind == ParsedLine::Instruction && line.type == type;
+}
+
+static bool sameOperand(const ParsedLine& a, const ParsedLine& b) {
+  if (a.format != b.format || a.operands.size() != 1 || b.operands.size() != 1) return false;
+  const auto& x = a.operands.front();
+  const auto& y = b.operands.front();
+  return x.symbol == y.symbol && x.literal == y.literal && x.selector == y.selector;
+}
+
+// the next line that does something or may be jumped to, -1 at the end
+static int following(const std::vector<ParsedLine>& lines, int index) {
+  for (auto i = index + 1; i < static_cast<int>(lines.size()); i++) {
+    const auto& line = lines[static_cast<size_t>(i)];
+    if (!line.label.isEmpty() || (line.kind != ParsedLine::NoOperation && line.kind != ParsedLine::Export)) return i;
+  }
+  return -1;
+}
+
+// a literal target may be any address, also one inside the code a rewrite takes out or moves
+static bool jumpsToLiteral(const ParsedLine& line) {
+  if (line.kind != ParsedLine::Instruction || line.operands.empty() || !line.operands.front().isLiteral()) return false;
+  return invertedBranch(line.type) != None || line.type == JMP || line.type == JSR;
+}
+
+static void remove(ParsedLine& line) {
+  line.kind = ParsedLine::NoOperation;
+  line.type = None;
+  line.format = ImpliedOrAccumulator;
+  line.operands.clear();
+}
+
+PeepholeOptimizer::PeepholeOptimizer(Assembler& assembler) : assembler(assembler) {
+}
+
+std::vector<PeepholeOptimizer::Rewrite> PeepholeOptimizer::optimize(std::vector<ParsedLine>& lines) {
+  if (std::any_of(lines.begin(), lines.end(), jumpsToLiteral)) return {};
+  assembler.init();
+  if (!scan(lines)) return {};
+
+  // one rewrite may make way for another, e.g. a tail call in a branch over a jump
+  auto optimized = lines;
+  std::vector<Rewrite> rewrites;
+  for (;;) {
+    const auto count = rewrites.size();
+    removeLoadsAfterStores(optimized, rewrites);
+    removeKnownCarry(optimized, rewrites);
+    replaceTailCalls(optimized, rewrites);
+    invertBranchesOverJumps(optimized, rewrites);
+    if (rewrites.size() == count) break;
+    if (!scan(optimized)) return {};
+  }
+
+  // code that moved may break what held before, e.g. a branch to a label before an .ALIGN
+  if (rewrites.empty() || !verify(optimized)) return {};
+
+  lines = std::move(optimized);
+  std::stable_sort(rewrites.begin(), rewrites.end(), [](const auto& a, const auto& b) { return a.line < b.line; });
+  return rewrites;
+}
+
+QString PeepholeOptimizer::describe(const Rewrite& rewrite) {
+  QString text;
+  switch (rewrite.kind) {
+  case Rewrite::LoadAfterStore: text = "load of the value just stored removed"; break;
+  case Rewrite::CarryKnown: text = "carry already in that state, CLC/SEC removed"; break;
+  case Rewrite::TailCall: text = "JSR followed by RTS turned into JMP"; break;
+  case Rewrite::BranchOverJump: text = "branch over JMP inverted"; break;
+  }
+  return text + QString(" (-%1 bytes, -%2 cycles)").arg(rewrite.bytesSaved).arg(rewrite.cyclesSaved);
+}
+
+bool PeepholeOptimizer::scan(const std::vector<ParsedLine>& lines) {
+  addresses.resize(lines.size());
+  for (auto scans = 1;; scans++) {
+    assembler.initPreserveSymbols();
+    assembler.changeMode(Assembler::ProcessingMode::ScanForSymbols);
+    for (size_t i = 0; i < lines.size(); i++) {
+      if (assembler.processLine(lines[i]) != AssemblyResult::Ok) return false;
+      addresses[i] = assembler.lastLocationCounter;
+    }
+    if (assembler.sizesSettled()) return true;
+    if (scans == ModuleAssembler::MaxScanPasses) return false;
+  }
+}
+
+bool PeepholeOptimizer::verify(const std::vector<ParsedLine>& lines) {
+  assembler.initPreserveSymbols();
+  assembler.changeMode(Assembler::ProcessingMode::EmitCode);
+  return std::all_of(lines.begin(), lines.end(), [this](const auto& line) {
+    return assembler.processLine(line) == AssemblyResult::Ok;
+  });
+}
+
+int PeepholeOptimizer::cycles(const ParsedLine& line) const {
+  const auto opcode = assembler.emittedOpcode(line);
+  return opcode < 0 ? 0 : InstructionTable[opcode].cycles;
+}
+
+// STA x followed by LDA x leaves A as it was, only the flags the load sets have to be set again by what follows
+void PeepholeOptimizer::removeLoadsAfterStores(std::vector<ParsedLine>& lines, std::vector<Rewrite>& rewrites) const {
+  for (auto i = 0; i < static_cast<int>(lines.size()); i++) {
+    const auto& store = lines[static_cast<size_t>(i)];
+    const auto load = loadOf(store.type);
+    if (store.kind != ParsedLine::Instruction || load == None || !addressesDirectly(store.format)) continue;
+
+    const auto next = following(lines, i);
+    if (next < 0) continue;
+    auto& line = lines[static_cast<size_t>(next)];
+    if (!line.label.isEmpty() || !isInstruction(line, load) || !sameOperand(store, line)) continue;
+
+    const auto after = following(lines, next);
+    if (after < 0) continue;
+    const auto& use = lines[static_cast<size_t>(after)];
+    if (use.kind != ParsedLine::Instruction || !overwritesNZ(use.type)) continue;
+
+    rewrites.push_back({Rewrite::LoadAfterStore, next, assembler.emittedSize(line), cycles(line)});
+    remove(line);
+  }
+}
+
+// a label may be jumped to with the carry in any state, so what is known about it ends there
+void PeepholeOptimizer::removeKnownCarry(std::vector<ParsedLine>& lines, std::vector<Rewrite>& rewrites) const {
+  enum { Unknown, Clear, Set } carry = Unknown;
+  for (auto i = 0; i < static_cast<int>(lines.size()); i++) {
+    auto& line = lines[static_cast<size_t>(i)];
+    if (!line.label.isEmpty()) carry = Unknown;
+    if (line.kind == ParsedLine::NoOperation || line.kind == ParsedLine::Export || line.kind == ParsedLine::SamePage)
+      continue;
+    if (line.kind != ParsedLine::Instruction) {
+      carry = Unknown;
+      continue;
+    }
+
+    switch (line.type) {
+    case CLC:
+    case SEC: {
+      const auto state = line.type == CLC ? Clear : Set;
+      if (carry == state && line.label.isEmpty()) {
+        rewrites.push_back({Rewrite::CarryKnown, i, assembler.emittedSize(line), cycles(line)});
+        remove(line);
+      }
+      carry = state;
+      break;
+    }
+    // on the way through, the branch was not taken
+    case BCC: carry = Set; break;
+    case BCS: carry = Clear; break;
+    default:
+      if (!preservesCarry(line.type)) carry = Unknown;
+      break;
+    }
+  }
+}
+
+// the called routine returns straight to the caller, the RTS stays if something else jumps to it
+void PeepholeOptimizer::replaceTailCalls(std::vector<ParsedLine>& lines, std::vector<Rewrite>& rewrites) const {
+  for (auto i = 0; i < static_cast<int>(lines.size()); i++) {
+    auto& call = lines[static_cast<size_t>(i)];
+    if (!isInstruction(call, JSR)) continue;
+
+    const auto next = following(lines, i);
+    if (next < 0 || !isInstruction(lines[static_cast<size_t>(next)], RTS)) continue;
+    auto& ret = lines[static_cast<size_t>(next)];
+
+    const auto before = cycles(call) + cycles(ret);
+    call.type = JMP;
+    auto bytes = 0;
+    if (ret.label.isEmpty()) {
+      bytes = assembler.emittedSize(ret);
+      remove(ret);
+    }
+    rewrites.push_back({Rewrite::TailCall, i, bytes, before - cycles(call)});
+  }
+}
+
+// BNE skip / JMP far / skip: becomes BEQ far / skip:, if the code between the branch and far does not move
+// anything to an address of its own, as then no other rewrite can take far out of range
+void PeepholeOptimizer::invertBranchesOverJumps(std::vector<ParsedLine>& lines, std::vector<Rewrite>& rewrites) const {
+  std::map<QString, int> lineOfLabel;
+  std::vector<int> directivesBefore(lines.size() + 1);
+  for (size_t i = 0; i < lines.size(); i++) {
+    const auto& line = lines[i];
+    if (!line.label.isEmpty()) lineOfLabel[line.label] = static_cast<int>(i);
+    const auto moves = line.kind == ParsedLine::SetLocationCounter || line.kind == ParsedLine::Align ||
+                       line.kind == ParsedLine::KeepOnPage;
+    directivesBefore[i + 1] = directivesBefore[i] + moves;
+  }
+
+  for (auto i = 0; i < static_cast<int>(lines.size()); i++) {
+    auto& branch = lines[static_cast<size_t>(i)];
+    const auto inverted = invertedBranch(branch.type);
+    if (branch.kind != ParsedLine::Instruction || inverted == None || branch.operands.front().isLiteral()) continue;
+
+    const auto next = following(lines, i);
+    if (next < 0) continue;
+    auto& jump = lines[static_cast<size_t>(next)];
+    if (!isInstruction(jump, JMP) || jump.format != Absolute || !jump.label.isEmpty()) continue;
+    const auto& target = jump.operands.front();
+    if (target.isLiteral() || target.selector != ParsedOperand::WholeValue) continue;
+
+    const auto after = following(lines, next);
+    if (after < 0 || lines[static_cast<size_t>(after)].label != branch.operands.front().symbol) continue;
+
+    const auto it = lineOfLabel.find(target.symbol);
+    if (it == lineOfLabel.end()) continue;
+    const auto first = std::min(i, it->second);
+    const auto last = std::max(i, it->second);
+    if (directivesBefore[static_cast<size_t>(last + 1)] != directivesBefore[static_cast<size_t>(first)]) continue;
+
+    const auto bytes = assembler.emittedSize(jump);
+    const auto origin = addresses[static_cast<size_t>(i)] + 2;
+    const auto displacement = addresses[static_cast<size_t>(it->second)] - origin - (it->second > i ? bytes : 0);
+    if (displacement < -128 || displacement > 127) continue;
+
+    const auto crosses = (origin ^ (origin + displacement)) & 0xff00;
+    rewrites.push_back({Rewrite::BranchOverJump, i, bytes, cycles(jump) - (crosses ? 2 : 1)});
+    branch.type = inverted;
+    branch.operands.front().symbol = target.symbol;
+    remove(jump);
+  }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "assembler.h"
+#include "lineparser.h"
+#include <QString>
+#include <vector>
+
+// Rewrites the instructions of a source into fewer bytes or cycles with the same effect on registers and memory,
+// provided that reading memory has no side effects and no routine looks at its return address
+class PeepholeOptimizer {
+public:
+  struct Rewrite {
+    enum Kind { LoadAfterStore, CarryKnown, TailCall, BranchOverJump };
+
+    Kind kind;
+    int line;
+    int bytesSaved;
+    int cyclesSaved; // for a branch over a jump, on the way that took the jump
+  };
+
+  // runs its passes with the assembler, so the code has to be assembled again afterwards
+  explicit PeepholeOptimizer(Assembler&);
+
+  // a line keeps its index and its label when its instruction goes; unless the source assembles both before and
+  // after, the lines are left as they were and there are no rewrites, as also when it branches or jumps to a literal
+  // address, which need not be at a label
+  std::vector<Rewrite> optimize(std::vector<ParsedLine>&);
+
+  static QString describe(const Rewrite&);
+
+private:
+  Assembler& assembler;
+  std::vector<Address> addresses; // of the lines in the last scan
+
+  bool scan(const std::vector<ParsedLine>&);
+  bool verify(const std::vector<ParsedLine>&);
+  int cycles(const ParsedLine&) const;
+
+  void removeLoadsAfterStores(std::vector<ParsedLine>&, std::vector<Rewrite>&) const;
+  void removeKnownCarry(std::vector<ParsedLine>&, std::vector<Rewrite>&) const;
+  void replaceTailCalls(std::vector<ParsedLine>&, std::vector<Rewrite>&) const;
+  void invertBranchesOverJumps(std::vector<ParsedLine>&, std::vector<Rewrite>&) const;
+};
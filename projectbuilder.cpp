@@ -0,0 +1,63 @@
+#include "projectbuilder.h"
+#include <QtConcurrentMap>
+
+bool ProjectBuilder::build(const QStringList& fileNames, Address origin) {
+  errorList.clear();
+  rewriteList.clear();
+  assembled = 0;
+  const auto useCache = cache && !optimize;
+  if (useCache) {
+    if (auto cached = cache->load(fileNames, origin)) {
+      result = std::move(*cached);
+      return true;
+    }
+  }
+  result = {};
+
+  std::map<QString, std::unique_ptr<ModuleAssembler>> previous;
+  previous.swap(modules);
+
+  std::vector<Job> jobs;
+  for (const auto& fileName : fileNames) {
+    auto& module = modules[fileName];
+    if (module) continue; // listed twice, the linker reports its symbols as already defined
+
+    const auto it = previous.find(fileName);
+    module = it != previous.end() ? std::move(it->second) : std::make_unique<ModuleAssembler>();
+    module->setOptimize(optimize);
+    jobs.push_back({fileName, module.get(), false});
+  }
+
+  // a module that failed is assembled again, as its errors may have come from a file that is gone
+  QtConcurrent::blockingMap(jobs, [](Job& job) {
+    if (job.module->errors().empty() && job.module->upToDate()) return;
+    job.module->assemble(job.fileName);
+    job.assembled = true;
+  });
+
+  for (const auto& job : jobs) {
+    if (job.assembled) assembled++;
+    errorList.insert(errorList.end(), job.module->errors().begin(), job.module->errors().end());
+    rewriteList.insert(rewriteList.end(), job.module->rewrites().begin(), job.module->rewrites().end());
+  }
+  if (!errorList.empty()) return false;
+
+  std::vector<const ObjectModule*> objects;
+  for (const auto& fileName : fileNames) objects.push_back(&modules[fileName]->module());
+  if (linker.link(objects, origin)) {
+    result = linker.output();
+    if (useCache) {
+      std::vector<ModuleAssembler::SourceFile> sources;
+      for (const auto& fileName : fileNames) {
+        const auto& moduleSources = modules[fileName]->sources();
+        sources.insert(sources.end(), moduleSources.begin(), moduleSources.end());
+      }
+      cache->store(fileNames, origin, sources, result);
+    }
+    return true;
+  }
+
+  for (const auto& error : linker.errors())
+    errorList.push_back({fileNames[error.module], -1, 0, error.result, error.symbol});
+  return false;
+}
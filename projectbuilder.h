@@ -0,0 +1,55 @@
+#pragma once
+
+#include "buildcache.h"
+#include "commondefs.h"
+#include "linker.h"
+#include "moduleassembler.h"
+#include <QString>
+#include <QStringList>
+#include <map>
+#include <memory>
+#include <vector>
+
+// Assembles the files of a project in parallel and links them in the given order; a file is assembled again
+// only when it or one of its includes changed since the previous build
+class ProjectBuilder {
+public:
+  using Error = ModuleAssembler::Error; // line -1 for the errors of linking
+  using Rewrite = ModuleAssembler::Rewrite;
+
+  // with a cache, a build of a project that did not change since it was stored skips assembling and linking
+  void setCache(const BuildCache* cache) { this->cache = cache; }
+
+  // the cache is keyed by the sources alone, so optimized builds bypass it
+  void setOptimize(bool enable) { optimize = enable; }
+
+  // returns false if there were errors
+  bool build(const QStringList& fileNames, Address origin);
+
+  const BuildOutput& output() const { return result; }
+  const MemoryPatch& image() const { return result.image; }
+  const SymbolTable& symbols() const { return result.symbols; }
+  const std::vector<Error>& errors() const { return errorList; }
+
+  // of every module in the last build, also the ones that were up to date
+  const std::vector<Rewrite>& rewrites() const { return rewriteList; }
+
+  // modules assembled by the last build, the others were up to date or it came from the cache
+  int assembledCount() const { return assembled; }
+
+private:
+  struct Job {
+    QString fileName;
+    ModuleAssembler* module;
+    bool assembled;
+  };
+
+  std::map<QString, std::unique_ptr<ModuleAssembler>> modules;
+  Linker linker;
+  const BuildCache* cache = nullptr;
+  BuildOutput result;
+  std::vector<Error> errorList;
+  std::vector<Rewrite> rewriteList;
+  int assembled = 0;
+  bool optimize = false;
+};
@@ -0,0 +1,67 @@
+#include "refreshscheduler.h"
+#include <QEvent>
+#include <QGuiApplication>
+#include <QScreen>
+#include <QWidget>
+
+static void merge(AddressRange& range, AddressRange changed) {
+  if (changed.valid()) {
+    range.expand(changed.first);
+    range.expand(changed.last);
+  }
+}
+
+RefreshScheduler::RefreshScheduler(QObject* parent) : QObject(parent) {
+  const auto screen = QGuiApplication::primaryScreen();
+  const auto rate = screen && screen->refreshRate() > 0 ? screen->refreshRate() : 60.0;
+  timer.setSingleShot(true);
+  timer.setTimerType(Qt::PreciseTimer);
+  timer.setInterval(std::max(1, qRound(1000 / rate)));
+  connect(&timer, &QTimer::timeout, this, &RefreshScheduler::flush);
+}
+
+void RefreshScheduler::addView(QWidget* widget, MemoryHandler memoryHandler, StateHandler stateHandler) {
+  const auto changedRange = memoryHandler ? AddressRange::Max : AddressRange::Invalid;
+  const auto stateChanged = static_cast<bool>(stateHandler);
+  views.push_back({widget, std::move(memoryHandler), std::move(stateHandler), changedRange, stateChanged});
+  widget->installEventFilter(this);
+  schedule();
+}
+
+void RefreshScheduler::publishMemoryChange(AddressRange range) {
+  for (auto& view : views) {
+    if (view.memoryHandler) merge(view.changedRange, range);
+  }
+  schedule();
+}
+
+void RefreshScheduler::publishState(EmulatorState state) {
+  lastState = state;
+  for (auto& view : views) {
+    if (view.stateHandler) view.stateChanged = true;
+  }
+  schedule();
+}
+
+void RefreshScheduler::flush() {
+  timer.stop();
+  for (auto& view : views) {
+    // hidden views keep collecting changes and catch up once shown
+    if (!view.pending() || !view.widget->isVisible()) continue;
+
+    const QSignalBlocker blocker(view.widget);
+    if (view.stateChanged && view.stateHandler) view.stateHandler(lastState);
+    if (view.changedRange.valid() && view.memoryHandler) view.memoryHandler(view.changedRange);
+    view.changedRange = AddressRange::Invalid;
+    view.stateChanged = false;
+  }
+}
+
+bool RefreshScheduler::eventFilter(QObject* watched, QEvent* event) {
+  if (event->type() == QEvent::Show) schedule();
+  return QObject::eventFilter(watched, event);
+}
+
+void RefreshScheduler::schedule() {
+  if (!timer.isActive()) timer.start();
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "addressrange.h"
+#include "emulatorstate.h"
+#include <QObject>
+#include <QTimer>
+#include <functional>
+#include <vector>
+
+class QWidget;
+
+// Accumulates memory and state changes per view and refreshes each visible view at most once per display frame
+class RefreshScheduler : public QObject {
+  Q_OBJECT
+
+public:
+  using MemoryHandler = std::function<void(AddressRange)>;
+  using StateHandler = std::function<void(const EmulatorState&)>;
+
+  explicit RefreshScheduler(QObject* parent = nullptr);
+
+  // either handler may be empty
+  void addView(QWidget*, MemoryHandler, StateHandler = {});
+  int framePeriod() const { return timer.interval(); }
+
+public slots:
+  void publishMemoryChange(AddressRange);
+  void publishState(EmulatorState);
+  void flush();
+
+protected:
+  bool eventFilter(QObject*, QEvent*) override;
+
+private:
+  struct View {
+    QWidget* widget;
+    MemoryHandler memoryHandler;
+    StateHandler stateHandler;
+    AddressRange changedRange;
+    bool stateChanged;
+
+    bool pending() const { return stateChanged || changedRange.valid(); }
+  };
+
+  std::vector<View> views;
+  EmulatorState lastState{};
+  QTimer timer;
+
+  void schedule();
+};
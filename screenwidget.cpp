@@ -1,31 +1,122 @@
 #include "screenwidget.h"
 #include <QPainter>
-#include <QRandomGenerator>
+#include <QPaintEvent>
+#include <cstring>
 
-ScreenWidget::ScreenWidget(QWidget* parent) : QWidget(parent), colorTable(256) {
+ScreenWidget::ScreenWidget(QWidget* parent) : QWidget(parent) {
   setColorTableToC64Palette();
+  setAttribute(Qt::WA_OpaquePaintEvent);
 }
 
 void ScreenWidget::setFrameBuffer(const uint8_t* buf, int resx, int resy) {
-  if (frameBuffer != buf) {
-    frameBuffer = buf;
+  if (frameBuffer == buf && resolutionX == resx && resolutionY == resy) return;
+
+  frameBuffer = buf;
+  if (resolutionX != resx || resolutionY != resy) {
     resolutionX = resx;
     resolutionY = resy;
-    update();
+    image = QImage(resx, resy, QImage::Format_ARGB32);
+    shadow.resize(static_cast<size_t>(resx * resy));
+    rescale();
+    updateGeometry();
   }
+
+  for (int row = 0; row < resolutionY; row++) convertRow(row);
+  firstDirtyRow = 0;
+  lastDirtyRow = resolutionY - 1;
+  update();
+}
+
+QSize ScreenWidget::sizeHint() const {
+  if (!resolutionX || !resolutionY) return minimumSize();
+
+  const auto hintScale = std::max(1, 256 / resolutionX);
+  return {resolutionX * hintScale, resolutionY * hintScale};
 }
 
-void ScreenWidget::paintEvent(QPaintEvent*) {
+void ScreenWidget::refresh() {
   if (!frameBuffer) return;
 
+  for (int row = 0; row < resolutionY; row++) {
+    const auto offset = static_cast<size_t>(row * resolutionX);
+    if (std::memcmp(&shadow[offset], frameBuffer + offset, static_cast<size_t>(resolutionX))) {
+      convertRow(row);
+      firstDirtyRow = std::min(firstDirtyRow, row);
+      lastDirtyRow = std::max(lastDirtyRow, row);
+    }
+  }
+
+  if (firstDirtyRow <= lastDirtyRow) {
+    const auto rect = screenRect();
+    const auto top = rect.y() + firstDirtyRow * rect.height() / resolutionY;
+    const auto bottom = rect.y() + ((lastDirtyRow + 1) * rect.height() + resolutionY - 1) / resolutionY;
+    update(rect.x(), top, rect.width(), bottom - top);
+  }
+}
+
+void ScreenWidget::paintEvent(QPaintEvent* event) {
   QPainter painter(this);
-  painter.setPen(Qt::gray);
-  painter.setBrush(QBrush(Qt::black));
+  if (!frameBuffer) {
+    painter.fillRect(event->rect(), Qt::black);
+    return;
+  }
 
-  QImage image(frameBuffer, resolutionX, resolutionY, QImage::Format_Indexed8);
-  image.setColorTable(colorTable);
+  updatePixmap();
+  const auto rect = screenRect();
+  if (!rect.contains(event->rect())) painter.fillRect(event->rect(), Qt::black);
+  painter.drawPixmap(rect, pixmap);
+}
 
-  painter.drawImage(rect(), image);
+void ScreenWidget::resizeEvent(QResizeEvent*) {
+  rescale();
+}
+
+void ScreenWidget::rescale() {
+  if (!resolutionX || !resolutionY) return;
+
+  scale = std::max(1, std::min(width() / resolutionX, height() / resolutionY));
+  pixmap = QPixmap(resolutionX * scale, resolutionY * scale);
+  firstDirtyRow = 0;
+  lastDirtyRow = resolutionY - 1;
+  update();
+}
+
+void ScreenWidget::convertRow(int row) {
+  const auto offset = static_cast<size_t>(row * resolutionX);
+  const auto src = frameBuffer + offset;
+  auto dst = reinterpret_cast<QRgb*>(image.scanLine(row));
+  // a plain table lookup, left to the compiler to vectorize (gather) where the target supports it
+  for (int x = 0; x < resolutionX; x++) dst[x] = colorTable[src[x]];
+  std::memcpy(&shadow[offset], src, static_cast<size_t>(resolutionX));
+}
+
+// copies the converted rows into the pixmap, scaling by an integer factor without filtering
+void ScreenWidget::updatePixmap() {
+  if (firstDirtyRow > lastDirtyRow) return;
+
+  QPainter painter(&pixmap);
+  painter.setRenderHint(QPainter::SmoothPixmapTransform, false);
+  const auto rows = lastDirtyRow - firstDirtyRow + 1;
+  painter.drawImage(QRect(0, firstDirtyRow * scale, pixmap.width(), rows * scale), image,
+                    QRect(0, firstDirtyRow, resolutionX, rows));
+  firstDirtyRow = resolutionY;
+  lastDirtyRow = -1;
+}
+
+// centered, shrunk keeping the aspect ratio if the frame does not fit even unscaled
+QRect ScreenWidget::screenRect() const {
+  auto w = pixmap.width();
+  auto h = pixmap.height();
+  if (w > width() || h > height()) {
+    if (w * height() > h * width()) {
+      h = h * width() / w;
+      w = width();
+    } else {
+      w = w * height() / h;
+      h = height();
+    }
+  }
+  return {(width() - w) / 2, (height() - h) / 2, w, h};
 }
 
 void ScreenWidget::setColorTableToC64Palette() {
@@ -1,7 +1,10 @@
 #pragma once
 
+#include "commondefs.h"
 #include <QImage>
+#include <QPixmap>
 #include <QWidget>
+#include <array>
 
 class ScreenWidget : public QWidget
 {
@@ -9,19 +12,35 @@ class ScreenWidget : public QWidget
 public:
   explicit ScreenWidget(QWidget* parent = nullptr);
 
+  QSize sizeHint() const override;
+
 signals:
 
 public slots:
   void setFrameBuffer(const uint8_t*, int resx, int resy);
+  void refresh();
 
 protected:
   void paintEvent(QPaintEvent* event) override;
+  void resizeEvent(QResizeEvent* event) override;
 
 private:
-  QVector<QRgb> colorTable;
-  int resolutionX;
-  int resolutionY;
+  std::array<QRgb, 256> colorTable;
+  int resolutionX = 0;
+  int resolutionY = 0;
   const uint8_t* frameBuffer = nullptr;
 
+  // frame buffer content already converted into image, image scaled into pixmap
+  Data shadow;
+  QImage image;
+  QPixmap pixmap;
+  int scale = 1;
+  int firstDirtyRow = 0;
+  int lastDirtyRow = -1;
+
   void setColorTableToC64Palette();
+  void rescale();
+  void convertRow(int row);
+  void updatePixmap();
+  QRect screenRect() const;
 };
@@ -0,0 +1,91 @@
+#include "sourceeditor.h"
+#include <QPaintEvent>
+#include <QPainter>
+#include <QTextBlock>
+#include <algorithm>
+
+static constexpr int Padding = 6;
+
+class AnnotationArea : public QWidget {
+public:
+  explicit AnnotationArea(SourceEditor* editor) : QWidget(editor), editor(editor) {}
+
+protected:
+  void paintEvent(QPaintEvent* event) override { editor->paintAnnotations(event); }
+
+private:
+  SourceEditor* editor;
+};
+
+SourceEditor::SourceEditor(QWidget* parent) : QPlainTextEdit(parent), annotationArea(new AnnotationArea(this)) {
+  connect(this, &QPlainTextEdit::updateRequest, this, &SourceEditor::updateAnnotationArea);
+  updateMargins();
+}
+
+void SourceEditor::setAnnotations(const QStringList& list, int longest) {
+  annotations = list;
+  longestAnnotation = longest;
+  updateMargins();
+  annotationArea->update();
+}
+
+// called as often as the program counter is shown, so the selections change only with the line
+void SourceEditor::setExecutedLine(int line) {
+  if (line == executedLine) return;
+  executedLine = line;
+
+  QList<QTextEdit::ExtraSelection> selections;
+  if (const auto block = document()->findBlockByNumber(line); block.isValid()) {
+    QTextEdit::ExtraSelection selection;
+    selection.format.setBackground(palette().color(QPalette::Highlight).lighter(170));
+    selection.format.setProperty(QTextFormat::FullWidthSelection, true);
+    selection.cursor = QTextCursor(block);
+    selections.append(selection);
+  }
+  setExtraSelections(selections);
+}
+
+// as wide as the longest annotation, up to MaxAnnotationChars
+int SourceEditor::annotationWidth() const {
+  if (!longestAnnotation) return 0;
+  return fontMetrics().horizontalAdvance(QString(std::min(longestAnnotation, MaxAnnotationChars), '0')) + 2 * Padding;
+}
+
+void SourceEditor::updateMargins() {
+  const auto width = annotationWidth();
+  setViewportMargins(0, 0, width, 0);
+  const auto rect = contentsRect();
+  annotationArea->setGeometry(QRect(rect.right() - width + 1, rect.top(), width, rect.height()));
+}
+
+void SourceEditor::updateAnnotationArea(const QRect& rect, int dy) {
+  if (dy)
+    annotationArea->scroll(0, dy);
+  else
+    annotationArea->update(0, rect.y(), annotationArea->width(), rect.height());
+}
+
+void SourceEditor::resizeEvent(QResizeEvent* event) {
+  QPlainTextEdit::resizeEvent(event);
+  updateMargins();
+}
+
+void SourceEditor::paintAnnotations(QPaintEvent* event) {
+  QPainter painter(annotationArea);
+  painter.fillRect(event->rect(), palette().color(QPalette::AlternateBase));
+  painter.setPen(palette().color(QPalette::PlaceholderText));
+
+  const auto width = annotationArea->width() - 2 * Padding;
+  auto block = firstVisibleBlock();
+  auto top = qRound(blockBoundingGeometry(block).translated(contentOffset()).top());
+  while (block.isValid() && top <= event->rect().bottom()) {
+    const auto bottom = top + qRound(blockBoundingRect(block).height());
+    const auto number = block.blockNumber();
+    if (block.isVisible() && bottom >= event->rect().top() && number < static_cast<int>(annotations.size())) {
+      const auto text = fontMetrics().elidedText(annotations[number], Qt::ElideRight, width);
+      painter.drawText(Padding, top, width, fontMetrics().height(), Qt::AlignLeft, text);
+    }
+    block = block.next();
+    top = bottom;
+  }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QPlainTextEdit>
+#include <QStringList>
+
+// Plain text editor with a column right of the text showing an annotation per line, e.g. its cycles
+class SourceEditor : public QPlainTextEdit {
+  Q_OBJECT
+
+public:
+  static constexpr int MaxAnnotationChars = 48;
+
+  explicit SourceEditor(QWidget* parent = nullptr);
+
+  // lines past the end of the list have none, the longest annotation in characters sets the width
+  void setAnnotations(const QStringList&, int longest);
+
+  // highlights the line, -1 for none
+  void setExecutedLine(int);
+
+protected:
+  void resizeEvent(QResizeEvent*) override;
+
+private:
+  friend class AnnotationArea;
+
+  QWidget* annotationArea;
+  QStringList annotations;
+  int longestAnnotation = 0;
+  int executedLine = -1;
+
+  int annotationWidth() const;
+  void updateMargins();
+  void updateAnnotationArea(const QRect&, int dy);
+  void paintAnnotations(QPaintEvent*);
+};
@@ -0,0 +1,16 @@
+#include "sourcemap.h"
+
+SourceMap::SourceMap() : locations(Memory::Size) {
+}
+
+// code running past the end of memory continues at its start
+void SourceMap::add(Address address, size_t size, int file, int line) {
+  for (size_t i = 0; i < size; i++) locations[static_cast<Address>(address + i)] = {file, line};
+}
+
+void SourceMap::remove(Address address, size_t size, int file, int line) {
+  for (size_t i = 0; i < size; i++) {
+    auto& location = locations[static_cast<Address>(address + i)];
+    if (location.file == file && location.line == line) location = {};
+  }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "memory.h"
+#include <vector>
+
+// The source line that emitted each byte of memory, so the line of the program counter is found by an array index
+class SourceMap {
+public:
+  struct Location {
+    int file = -1; // index in BuildOutput::files, 0 for the editor
+    int line = -1; // counted from 0, -1 where no code was assembled
+
+    bool valid() const { return line >= 0; }
+  };
+
+  SourceMap();
+
+  // a later line emitting to the same address replaces the earlier one
+  void add(Address address, size_t size, int file, int line);
+
+  // clears the addresses still mapped to the line
+  void remove(Address address, size_t size, int file, int line);
+
+  const Location& at(Address address) const { return locations[address]; }
+
+private:
+  std::vector<Location> locations;
+};
@@ -1,12 +1,167 @@
 #include "symboltable.h"
+#include <algorithm>
+#include <stdexcept>
+
+static constexpr size_t MinCapacity = 16;
+
+// FNV-1a over the UTF-16 code units
+uint32_t SymbolTable::hash(const QString& name) {
+  uint32_t h = 2166136261u;
+  for (const auto c : name) h = (h ^ c.unicode()) * 16777619u;
+  return h;
+}
 
 bool SymbolTable::put(const QString& name, uint16_t value) {
-  if (find(name) != end()) return false;
-  operator[](name) = value;
+  const auto h = hash(name);
+  if (find(name, h) != NotFound) return false;
+  insert(name, h, value);
   return true;
 }
 
-std::optional<int> SymbolTable::get(const QString& name) const {
-  if (const auto it = find(name); it != end()) return it->second;
+void SymbolTable::set(const QString& name, uint16_t value) {
+  const auto h = hash(name);
+  const auto index = find(name, h);
+  if (index == NotFound) {
+    insert(name, h, value);
+  } else if (entries[index].value != value) {
+    unlinkValue(index);
+    entries[index].value = value;
+    linkValue(index);
+  }
+}
+
+std::optional<uint16_t> SymbolTable::get(const QString& name) const {
+  if (const auto index = find(name); index != NotFound) return entries[index].value;
   return std::nullopt;
 }
+
+uint16_t SymbolTable::at(const QString& name) const {
+  const auto index = find(name);
+  if (index == NotFound) throw std::out_of_range("symbol not defined");
+  return entries[index].value;
+}
+
+bool SymbolTable::erase(const QString& name) {
+  const auto h = hash(name);
+  const auto mask = buckets.size() - 1;
+  for (auto i = h & mask; !buckets.empty() && buckets[i] != Empty; i = (i + 1) & mask) {
+    if (buckets[i] == Removed) continue;
+    const auto index = buckets[i] - 1;
+    auto& e = entries[index];
+    if (e.hash != h || nameOf(e) != name) continue;
+
+    unlinkValue(index);
+    e.defined = false;
+    buckets[i] = Removed;
+    defined--;
+    return true;
+  }
+  return false;
+}
+
+void SymbolTable::clear() {
+  for (const auto& e : entries) firstWithValue[e.value] = 0;
+  arena.clear();
+  entries.clear();
+  buckets.clear();
+  defined = 0;
+}
+
+QStringView SymbolTable::symbolAt(uint16_t value) const {
+  if (firstWithValue.empty() || !firstWithValue[value]) return {};
+  return nameOf(entries[firstWithValue[value] - 1]);
+}
+
+std::vector<QStringView> SymbolTable::symbolsAt(uint16_t value) const {
+  std::vector<QStringView> names;
+  if (firstWithValue.empty()) return names;
+  for (auto next = firstWithValue[value]; next; next = entries[next - 1].nextWithValue) names.push_back(nameOf(entries[next - 1]));
+  return names;
+}
+
+bool SymbolTable::operator==(const SymbolTable& other) const {
+  if (size() != other.size()) return false;
+  for (const auto& e : entries) {
+    if (!e.defined) continue;
+    const auto index = other.find(nameOf(e).toString(), e.hash);
+    if (index == NotFound || other.entries[index].value != e.value) return false;
+  }
+  return true;
+}
+
+uint32_t SymbolTable::find(const QString& name) const {
+  return find(name, hash(name));
+}
+
+// names are compared only when the hashes are equal
+uint32_t SymbolTable::find(const QString& name, uint32_t h) const {
+  if (buckets.empty()) return NotFound;
+
+  const auto mask = buckets.size() - 1;
+  for (auto i = h & mask; buckets[i] != Empty; i = (i + 1) & mask) {
+    if (buckets[i] == Removed) continue;
+    const auto index = buckets[i] - 1;
+    const auto& e = entries[index];
+    if (e.hash == h && nameOf(e) == name) return index;
+  }
+  return NotFound;
+}
+
+void SymbolTable::insert(const QString& name, uint32_t h, uint16_t value) {
+  // removed entries keep their buckets, so they count until the next rebuild drops them
+  if ((entries.size() + 1) * 4 > buckets.size() * 3) rebuild(std::max(MinCapacity, (defined + 1) * 2));
+  if (firstWithValue.empty()) firstWithValue.resize(AddressSpace);
+
+  const auto index = static_cast<uint32_t>(entries.size());
+  entries.push_back({h, static_cast<uint32_t>(arena.size()), static_cast<int>(name.size()), value, true, 0});
+  arena.insert(arena.end(), name.begin(), name.end());
+
+  const auto mask = buckets.size() - 1;
+  auto i = h & mask;
+  while (buckets[i] != Empty && buckets[i] != Removed) i = (i + 1) & mask;
+  buckets[i] = index + 1;
+  linkValue(index);
+  defined++;
+}
+
+// appended, so that the first symbol defined with a value comes first
+void SymbolTable::linkValue(uint32_t index) {
+  entries[index].nextWithValue = 0;
+  auto* link = &firstWithValue[entries[index].value];
+  while (*link) link = &entries[*link - 1].nextWithValue;
+  *link = index + 1;
+}
+
+void SymbolTable::unlinkValue(uint32_t index) {
+  auto* link = &firstWithValue[entries[index].value];
+  while (*link != index + 1) link = &entries[*link - 1].nextWithValue;
+  *link = entries[index].nextWithValue;
+}
+
+// drops removed entries with their names, which renumbers the rest
+void SymbolTable::rebuild(size_t capacity) {
+  size_t size = MinCapacity;
+  while (size < capacity) size *= 2;
+
+  std::vector<QChar> oldArena;
+  std::vector<Entry> oldEntries;
+  oldArena.swap(arena);
+  oldEntries.swap(entries);
+  buckets.assign(size, Empty);
+  for (const auto& e : oldEntries) firstWithValue[e.value] = 0;
+  defined = 0;
+
+  for (const auto& e : oldEntries) {
+    if (!e.defined) continue;
+
+    const auto index = static_cast<uint32_t>(entries.size());
+    entries.push_back({e.hash, static_cast<uint32_t>(arena.size()), e.length, e.value, true, 0});
+    arena.insert(arena.end(), oldArena.begin() + e.offset, oldArena.begin() + e.offset + e.length);
+
+    auto i = e.hash & (size - 1);
+    while (buckets[i] != Empty) i = (i + 1) & (size - 1);
+    buckets[i] = index + 1;
+    linkValue(index);
+    defined++;
+  }
+}
@@ -1,10 +1,108 @@
 #pragma once
 
 #include <QString>
-#include <map>
+#include <QStringView>
 #include <optional>
+#include <vector>
 
-struct SymbolTable : std::map<QString, uint16_t> {
+// Interns symbol names into one character arena and finds them through an open addressing table of their hashes,
+// computed once per name; symbols are also chained by value, so the ones at an address are found in O(1)
+class SymbolTable {
+public:
+  class const_iterator;
+
+  // returns false if the name is already defined
   bool put(const QString& name, uint16_t value);
-  std::optional<int> get(const QString& name) const;
+
+  // defines the name or changes its value
+  void set(const QString& name, uint16_t value);
+
+  std::optional<uint16_t> get(const QString& name) const;
+  uint16_t at(const QString& name) const; // throws std::out_of_range if not defined
+  bool contains(const QString& name) const { return find(name) != NotFound; }
+  bool erase(const QString& name);
+  void clear();
+
+  size_t size() const { return defined; }
+  bool empty() const { return !defined; }
+
+  // the first symbol defined with the value, empty if none
+  QStringView symbolAt(uint16_t value) const;
+
+  // in the order defined
+  std::vector<QStringView> symbolsAt(uint16_t value) const;
+
+  // in the order defined
+  const_iterator begin() const;
+  const_iterator end() const;
+
+  // the same names with the same values
+  bool operator==(const SymbolTable&) const;
+  bool operator!=(const SymbolTable& other) const { return !(*this == other); }
+
+private:
+  static constexpr uint32_t NotFound = UINT32_MAX;
+  static constexpr uint32_t Empty = 0;
+  static constexpr uint32_t Removed = UINT32_MAX; // a bucket that is skipped, not the end of a probe sequence
+  static constexpr size_t AddressSpace = 0x10000;
+
+  struct Entry {
+    uint32_t hash;
+    uint32_t offset; // in the arena
+    int length;
+    uint16_t value;
+    bool defined;
+    uint32_t nextWithValue; // index + 1, 0 for the last one
+  };
+
+  std::vector<QChar> arena;
+  std::vector<Entry> entries;
+  std::vector<uint32_t> buckets; // entry index + 1, a power of 2 in size
+  std::vector<uint32_t> firstWithValue; // entry index + 1 for every value, allocated with the first symbol
+  size_t defined = 0;
+
+  static uint32_t hash(const QString&);
+  QStringView nameOf(const Entry& e) const { return QStringView(arena.data() + e.offset, e.length); }
+  uint32_t find(const QString&) const;
+  uint32_t find(const QString&, uint32_t hash) const;
+  void insert(const QString&, uint32_t hash, uint16_t value);
+  void linkValue(uint32_t index);
+  void unlinkValue(uint32_t index);
+  void rebuild(size_t capacity);
+
+  friend class const_iterator;
 };
+
+class SymbolTable::const_iterator {
+public:
+  const_iterator(const SymbolTable& table, size_t index) : table(table), index(index) { skipRemoved(); }
+
+  std::pair<QStringView, uint16_t> operator*() const {
+    const auto& e = table.entries[index];
+    return {table.nameOf(e), e.value};
+  }
+
+  const_iterator& operator++() {
+    index++;
+    skipRemoved();
+    return *this;
+  }
+
+  bool operator!=(const const_iterator& other) const { return index != other.index; }
+
+private:
+  const SymbolTable& table;
+  size_t index;
+
+  void skipRemoved() {
+    while (index < table.entries.size() && !table.entries[index].defined) index++;
+  }
+};
+
+inline SymbolTable::const_iterator SymbolTable::begin() const {
+  return {*this, 0};
+}
+
+inline SymbolTable::const_iterator SymbolTable::end() const {
+  return {*this, entries.size()};
+}
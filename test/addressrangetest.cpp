@@ -0,0 +1,37 @@
+#include "addressrangetest.h"
+#include "addressrange.h"
+#include <QTest>
+
+AddressRangeTest::AddressRangeTest(QObject* parent) : QObject(parent) {
+}
+
+void AddressRangeTest::testOverlaps() {
+  QVERIFY(AddressRange(0x1000, 0x10ff).overlapsWith({0x10ff, 0x2000}));
+  QVERIFY(!AddressRange(0x1000, 0x10ff).overlapsWith({0x1100, 0x2000}));
+  QVERIFY(AddressRange::Max.overlapsWith(0xffff));
+  QVERIFY(!AddressRange::Max.overlapsWith(AddressRange::Invalid));
+  QVERIFY(!AddressRange::Invalid.overlapsWith(AddressRange::Max));
+}
+
+void AddressRangeTest::testWrapping() {
+  auto parts = AddressRange::wrapping(0x1000, 0x100);
+  QCOMPARE(parts[0].first, Address(0x1000));
+  QCOMPARE(parts[0].last, Address(0x10ff));
+  QVERIFY(!parts[1].valid());
+
+  parts = AddressRange::wrapping(0xff00, 0x100);
+  QCOMPARE(parts[0].last, Address(0xffff));
+  QVERIFY(!parts[1].valid());
+
+  parts = AddressRange::wrapping(0xff00, 0x180);
+  QCOMPARE(parts[0].first, Address(0xff00));
+  QCOMPARE(parts[0].last, Address(0xffff));
+  QCOMPARE(parts[1].first, Address(0x0000));
+  QCOMPARE(parts[1].last, Address(0x007f));
+
+  parts = AddressRange::wrapping(0x8000, 0x10000);
+  QCOMPARE(parts[0].first, Address(0x0000));
+  QCOMPARE(parts[0].last, Address(0xffff));
+  QVERIFY(!parts[1].valid());
+  QVERIFY(!AddressRange::wrapping(0x1000, 0)[0].valid());
+}
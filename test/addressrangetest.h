@@ -0,0 +1,13 @@
+#pragma once
+
+#include <QObject>
+
+class AddressRangeTest : public QObject {
+  Q_OBJECT
+public:
+  explicit AddressRangeTest(QObject* parent = nullptr);
+
+private slots:
+  void testOverlaps();
+  void testWrapping();
+};
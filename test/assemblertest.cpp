@@ -1,4 +1,6 @@
 #include "assemblertest.h"
+#include "instructiontable.h"
+#include "mnemonics.h"
 #include <QTest>
 
 #define TEST_INST(instr) QVERIFY(assembler.processLine(instr) == AssemblyResult::Ok)
@@ -100,6 +102,13 @@ void AssemblerTest::testRelativeModeLabel() {
 
 void AssemblerTest::testRelativeModePlus() {
   TEST_INST_2("BVS +8", 0x70, 8);
+  TEST_INST_2("BCC 64", 0x90, 64);
+  TEST_INST_2("BCS -2", 0xb0, 0xfe);
+
+  // only a decimal number is a displacement
+  QCOMPARE(assembler.processLine("  BNE $40"), AssemblyResult::SyntaxError);
+  QCOMPARE(assembler.errorColumn(), 6);
+  QCOMPARE(assembler.processLine("  BNE %101"), AssemblyResult::SyntaxError);
 }
 
 void AssemblerTest::testOrg() {
@@ -217,3 +226,127 @@ void AssemblerTest::testSymbolDef() {
   TEST_INST("lda init");
   QCOMPARE(assembler.locationCounter, 0x1003);
 }
+
+void AssemblerTest::testWhitespace() {
+  TEST_INST_2("LDA ( $8c , X )", 0xa1, 0x8c);
+  TEST_INST_2("\tLDA ($8c) , y\t; comment", 0xb1, 0x8c);
+  TEST_INST_2("  STX $7a, Y", 0x96, 0x7a);
+  TEST_INST_1("  lbl:  NOP", 0xea);
+}
+
+void AssemblerTest::testErrorColumn() {
+  QCOMPARE(assembler.processLine("  LDA $10,Z"), AssemblyResult::SyntaxError);
+  QCOMPARE(assembler.errorColumn(), 10);
+  QCOMPARE(assembler.processLine("LDA #$12345"), AssemblyResult::SyntaxError);
+  QCOMPARE(assembler.errorColumn(), 10);
+  QCOMPARE(assembler.processLine("\tLDX #1 junk"), AssemblyResult::SyntaxError);
+  QCOMPARE(assembler.errorColumn(), 8);
+  QCOMPARE(assembler.processLine("  XYZ #1"), AssemblyResult::InvalidMnemonic);
+  QCOMPARE(assembler.errorColumn(), 2);
+  QCOMPARE(assembler.processLine("  STA #1"), AssemblyResult::InvalidInstructionFormat);
+  QCOMPARE(assembler.errorColumn(), 2);
+  QCOMPARE(assembler.processLine(".BYTE 1, 2, 256"), AssemblyResult::ValueOutOfRange);
+  QCOMPARE(assembler.errorColumn(), 12);
+  QCOMPARE(assembler.processLine("  LDA (nowhere),Y"), AssemblyResult::SymbolNotDefined);
+  QCOMPARE(assembler.errorColumn(), 7);
+  QCOMPARE(assembler.processLine(".FOO 1"), AssemblyResult::SyntaxError);
+  QCOMPARE(assembler.errorColumn(), 0);
+}
+
+void AssemblerTest::testInstructionLookup() {
+  for (int type = ADC; type <= KIL; type++) {
+    const auto m = Mnemonics[static_cast<size_t>(type)];
+    QCOMPARE(findMnemonic(m[0], m[1], m[2]), type);
+    QCOMPARE(findMnemonic(m[0] | 0x20, m[1] | 0x20, m[2] | 0x20), type);
+  }
+  QCOMPARE(findMnemonic('A', 'D', '@'), None);
+
+  for (int opcode = 0; opcode < Instruction::NumberOfOpCodes; opcode++) {
+    const auto& ins = InstructionTable[static_cast<size_t>(opcode)];
+    if (ins.type != KIL) QCOMPARE(OpcodeTable[ins.type][ins.mode], opcode);
+  }
+}
+
+void AssemblerTest::testZeroPageSymbols() {
+  assembler.symbolTable.put("var", 0x80);
+  assembler.symbolTable.put("far", 0x1234);
+  TEST_INST_2("LDA var", 0xa5, 0x80);
+  TEST_INST_2("STX var,Y", 0x96, 0x80);
+  TEST_INST_3("LDA var,Y", 0xb9, 0x80, 0x00);
+  TEST_INST_3("LDA $10,Y", 0xb9, 0x10, 0x00);
+  TEST_INST_3("JMP var", 0x4c, 0x80, 0x00);
+  TEST_INST_2("LDA <far", 0xa5, 0x34);
+  TEST_INST_2("LDA >far,X", 0xb5, 0x12);
+  TEST_INST_3("LDA far", 0xad, 0x34, 0x12);
+}
+
+void AssemblerTest::testSizeRelaxation() {
+  const std::vector<QString> source = {
+      "  .ORG $1000",
+      "  LDA counter",   // zero page once the second pass knows where counter is
+      "  STA counter,Y", // STA has no zero page,Y form
+      "  LDX counter,Y",
+      "  BNE end",
+      "end: RTS",
+      "  .ORG $0080",
+      "counter: .BYTE 0",
+  };
+
+  auto scans = 0;
+  do {
+    assembler.initPreserveSymbols();
+    assembler.changeMode(Assembler::ProcessingMode::ScanForSymbols);
+    for (const auto& line : source) TEST_INST(line);
+    scans++;
+  } while (!assembler.sizesSettled() && scans < 4);
+  QCOMPARE(scans, 2);
+  QCOMPARE(assembler.symbolTable.get("end"), 0x1009);
+
+  assembler.initPreserveSymbols();
+  for (const auto& line : source) TEST_INST(line);
+  const auto expected = Data({0xa5, 0x80, 0x99, 0x80, 0x00, 0xb6, 0x80, 0xd0, 0x00, 0x60});
+  QVERIFY(std::equal(expected.begin(), expected.end(), memory.cbegin() + 0x1000));
+
+  assembler.initPreserveSymbols();
+  assembler.changeMode(Assembler::ProcessingMode::ScanForSymbols);
+  TEST_INST("end: NOP");
+  QCOMPARE(assembler.processLine("end: NOP"), AssemblyResult::SymbolAlreadyDefined);
+}
+
+void AssemblerTest::testAlign() {
+  TEST_INST("  .ORG $1003");
+  TEST_INST("  .ALIGN 4");
+  QCOMPARE(assembler.locationCounter, 0x1004);
+  TEST_INST("  .align 4");
+  QCOMPARE(assembler.locationCounter, 0x1004);
+  TEST_INST("  .ALIGN $100");
+  QCOMPARE(assembler.locationCounter, 0x1100);
+
+  // .PAGE only moves to the next page if the bytes would not fit on this one
+  TEST_INST("  .ORG $10f0");
+  TEST_INST("  .PAGE 16");
+  QCOMPARE(assembler.locationCounter, 0x10f0);
+  TEST_INST("  .PAGE 17");
+  QCOMPARE(assembler.locationCounter, 0x1100);
+
+  QCOMPARE(assembler.processLine("  .PAGE 257"), AssemblyResult::ValueOutOfRange);
+  QCOMPARE(assembler.processLine("  .ALIGN 0"), AssemblyResult::ValueOutOfRange);
+  QCOMPARE(assembler.processLine("  .ALIGN size"), AssemblyResult::NumericOperandRequired);
+  QCOMPARE(assembler.errorColumn(), 9);
+  TEST_INST("  .ORG $fff0");
+  QCOMPARE(assembler.processLine("  .PAGE 32"), AssemblyResult::ValueOutOfRange);
+}
+
+void AssemblerTest::testSamePage() {
+  const std::vector<QString> source = {"  .ORG $10f8", "loop: DEX", "  BNE loop", "  .ORG $10fe", "wait: DEY", "  BNE wait"};
+  assembler.changeMode(Assembler::ProcessingMode::ScanForSymbols);
+  for (const auto& line : source) TEST_INST(line);
+  assembler.initPreserveSymbols();
+  for (auto i = 0; i < 3; i++) TEST_INST(source[static_cast<size_t>(i)]);
+  TEST_INST("  .SAMEPAGE loop");
+  for (auto i = 3; i < 6; i++) TEST_INST(source[static_cast<size_t>(i)]);
+  QCOMPARE(assembler.processLine("  .SAMEPAGE wait"), AssemblyResult::PageCrossed);
+  QCOMPARE(assembler.errorColumn(), 12);
+  QCOMPARE(assembler.processLine("  .SAMEPAGE nowhere"), AssemblyResult::SymbolNotDefined);
+  QCOMPARE(assembler.processLine("  .SAMEPAGE loop, wait"), AssemblyResult::SyntaxError);
+}
@@ -56,4 +56,11 @@ private slots:
   void testHiBytePrefix();
   void testLoHiBytePrefix();
   void testSymbolDef();
+  void testWhitespace();
+  void testErrorColumn();
+  void testInstructionLookup();
+  void testZeroPageSymbols();
+  void testSizeRelaxation();
+  void testAlign();
+  void testSamePage();
 };
@@ -0,0 +1,167 @@
+#include "batchassemblertest.h"
+#include "batchassembler.h"
+#include "buildcache.h"
+#include <QDir>
+#include <QFile>
+#include <QTest>
+
+BatchAssemblerTest::BatchAssemblerTest(QObject* parent) : QObject(parent) {
+}
+
+void BatchAssemblerTest::init() {
+  temp = std::make_unique<TestFiles>();
+  QVERIFY(temp->valid());
+  temp->write("ba_one.asm", "start: LDX #2\n"
+                            "loop: DEX\n"
+                            " BNE loop\n"
+                            " .INCLUDE \"ba_data.asm\"\n");
+  temp->write("ba_data.asm", " RTS\n"
+                             "table: .BYTE 1, 2\n");
+  temp->write("ba_two.asm", " .ORG $0300\n"
+                            " .BYTE 1\n"
+                            " .ORG $0304\n"
+                            " .BYTE 2\n");
+  temp->write("ba_bad.asm", " NOP\n"
+                            " FOO\n");
+  temp->write("ba_import.asm", " JMP elsewhere\n");
+}
+
+void BatchAssemblerTest::cleanup() {
+  temp.reset();
+}
+
+void BatchAssemblerTest::testOutputs() {
+  BatchAssembler::Options options;
+  options.origin = 0x600;
+  BatchAssembler assembler(options);
+  QVERIFY(assembler.assemble({temp->path("ba_one.asm"), temp->path("ba_two.asm")}));
+
+  const auto& results = assembler.results();
+  QCOMPARE(results.size(), size_t(2));
+  QCOMPARE(results[0].fileName, temp->path("ba_one.asm"));
+  QCOMPARE(results[0].lines, 6);
+  QCOMPARE(results[0].bytes, 8);
+  QCOMPARE(results[1].bytes, 2);
+
+  QCOMPARE(temp->read("ba_one.bin"), QByteArray("\xa2\x02\xca\xd0\xfd\x60\x01\x02", 8));
+  QCOMPARE(temp->read("ba_one.sym"), QByteArray("start = $0600\nloop = $0602\ntable = $0606\n"));
+  const auto listing = QString::fromUtf8(temp->read("ba_one.lst"));
+  QVERIFY(listing.contains("; " + temp->path("ba_data.asm") + "\n"));
+  QVERIFY(listing.contains("\n0602  CA"));
+  QVERIFY(listing.contains("\n0606  01 02"));
+
+  // the gap between the sections is filled
+  QCOMPARE(temp->read("ba_two.bin"), QByteArray("\x01\x00\x00\x00\x02", 5));
+  QVERIFY(temp->read("ba_two.sym").isEmpty());
+}
+
+void BatchAssemblerTest::testErrors() {
+  BatchAssembler::Options options;
+  options.listings = false;
+  BatchAssembler assembler(options);
+  QVERIFY(!assembler.assemble({temp->path("ba_bad.asm"), temp->path("ba_missing.asm"), temp->path("ba_import.asm"),
+                               temp->path("ba_two.asm")}));
+
+  const auto& results = assembler.results();
+  QCOMPARE(results[0].errors.size(), size_t(1));
+  QCOMPARE(results[0].errors[0].line, 1);
+  QCOMPARE(results[0].errors[0].result, AssemblyResult::InvalidMnemonic);
+  QVERIFY(!QFile::exists(temp->path("ba_bad.bin")));
+
+  QCOMPARE(results[1].errors[0].result, AssemblyResult::FileNotFound);
+
+  QCOMPARE(results[2].errors.size(), size_t(1));
+  QCOMPARE(results[2].errors[0].line, -1);
+  QCOMPARE(results[2].errors[0].result, AssemblyResult::SymbolNotDefined);
+  QCOMPARE(results[2].errors[0].symbol, QString("elsewhere"));
+
+  // the others are still assembled
+  QVERIFY(results[3].ok());
+  QVERIFY(QFile::exists(temp->path("ba_two.bin")));
+  QVERIFY(QFile::exists(temp->path("ba_two.sym")));
+  QVERIFY(!QFile::exists(temp->path("ba_two.lst")));
+}
+
+void BatchAssemblerTest::testCache() {
+  BatchAssembler::Options options;
+  options.origin = 0x600;
+  options.cacheDirectory = temp->path("cache");
+  QVERIFY(BatchAssembler(options).assemble({temp->path("ba_one.asm")}));
+  QVERIFY(BuildCache(options.cacheDirectory).load({temp->path("ba_one.asm")}, options.origin));
+  const auto binary = temp->read("ba_one.bin");
+  const auto listing = temp->read("ba_one.lst");
+  QVERIFY(QFile::remove(temp->path("ba_one.bin")));
+
+  // from the cache, with the same outputs
+  BatchAssembler cached(options);
+  QVERIFY(cached.assemble({temp->path("ba_one.asm")}));
+  QCOMPARE(cached.results()[0].lines, 6);
+  QCOMPARE(temp->read("ba_one.bin"), binary);
+  QCOMPARE(temp->read("ba_one.lst"), listing);
+}
+
+void BatchAssemblerTest::testCollision() {
+  for (const auto directory : {"a", "b", "out"}) QVERIFY(QDir().mkpath(temp->path(directory)));
+  temp->write("a/prog.asm", " NOP\n");
+  temp->write("b/prog.asm", " BRK\n");
+
+  BatchAssembler::Options options;
+  options.outputDirectory = temp->path("out");
+  BatchAssembler assembler(options);
+  QVERIFY(!assembler.assemble({temp->path("a/prog.asm"), temp->path("b/prog.asm"), temp->path("ba_two.asm")}));
+
+  const auto& results = assembler.results();
+  QVERIFY(results[0].ok());
+  QCOMPARE(results[1].collidesWith, temp->path("a/prog.asm"));
+  QVERIFY(results[2].ok());
+  QCOMPARE(temp->read("out/prog.bin"), QByteArray("\xea", 1));
+
+  // next to their sources they do not collide
+  QVERIFY(BatchAssembler({}).assemble({temp->path("a/prog.asm"), temp->path("b/prog.asm")}));
+}
+
+void BatchAssemblerTest::testProject() {
+  temp->write("ba_main.asm", "start: JSR init\n"
+                             " JMP start\n");
+  temp->write("ba_init.asm", "init: LDX #0\n"
+                             " RTS\n"
+                             " .EXPORT init\n");
+  const QStringList files{temp->path("ba_main.asm"), temp->path("ba_init.asm")};
+
+  BatchAssembler::Options options;
+  options.origin = 0x600;
+  options.project = temp->path("ba_project");
+  BatchAssembler assembler(options);
+  QVERIFY(assembler.assemble(files));
+  QCOMPARE(assembler.results().size(), size_t(1));
+  QCOMPARE(assembler.results()[0].assembled, 2);
+  QCOMPARE(assembler.results()[0].files, files);
+  QCOMPARE(assembler.results()[0].lines, 5);
+  QCOMPARE(temp->read("ba_project.bin"), QByteArray("\x20\x06\x06\x4c\x00\x06\xa2\x00\x60", 9));
+  QCOMPARE(temp->read("ba_project.sym"), QByteArray("start = $0600\ninit = $0606\n"));
+  const auto listing = QString::fromUtf8(temp->read("ba_project.lst"));
+  QVERIFY(listing.contains("; " + files[1] + "\n"));
+  QVERIFY(listing.contains("\n0606  A2 00"));
+
+  // the project keeps its modules, so a change assembles only the module it is in
+  temp->write("ba_init.asm", "init: LDX #1\n"
+                             " RTS\n"
+                             " .EXPORT init\n");
+  QVERIFY(assembler.assemble(files));
+  QCOMPARE(assembler.results()[0].assembled, 1);
+  QCOMPARE(temp->read("ba_project.bin"), QByteArray("\x20\x06\x06\x4c\x00\x06\xa2\x01\x60", 9));
+
+  temp->write("ba_main.asm", " JSR missing\n");
+  QVERIFY(!assembler.assemble(files));
+  QCOMPARE(assembler.results()[0].errors.size(), size_t(1));
+  QCOMPARE(assembler.results()[0].errors[0].fileName, files[0]);
+  QCOMPARE(assembler.results()[0].errors[0].result, AssemblyResult::SymbolNotDefined);
+}
+
+void BatchAssemblerTest::testOutputFileName() {
+  QCOMPARE(BatchAssembler({}).outputFileName("/src/prog.v1.asm", "bin"), QString("/src/prog.v1.bin"));
+
+  BatchAssembler::Options options;
+  options.outputDirectory = "/out";
+  QCOMPARE(BatchAssembler(options).outputFileName("/src/prog.asm", "lst"), QString("/out/prog.lst"));
+}
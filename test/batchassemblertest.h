@@ -0,0 +1,25 @@
+#pragma once
+
+#include "testfiles.h"
+#include <QObject>
+#include <QString>
+#include <memory>
+
+class BatchAssemblerTest : public QObject {
+  Q_OBJECT
+public:
+  explicit BatchAssemblerTest(QObject* parent = nullptr);
+
+private:
+  std::unique_ptr<TestFiles> temp;
+
+private slots:
+  void init();
+  void cleanup();
+  void testOutputs();
+  void testErrors();
+  void testCache();
+  void testCollision();
+  void testProject();
+  void testOutputFileName();
+};
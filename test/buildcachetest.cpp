@@ -0,0 +1,107 @@
+#include "buildcachetest.h"
+#include "buildcache.h"
+#include "projectbuilder.h"
+#include <QFile>
+#include <QTest>
+
+BuildCacheTest::BuildCacheTest(QObject* parent) : QObject(parent) {
+}
+
+void BuildCacheTest::init() {
+  temp = std::make_unique<TestFiles>();
+  QVERIFY(temp->valid());
+  temp->write("bc_main.asm", "start: JSR sub\n"
+                             "\n"
+                             " JMP start\n"
+                             " .EXPORT start");
+  temp->write("bc_sub.asm", "sub: LDA table\n"
+                            " .INCLUDE \"bc_data.asm\"\n"
+                            " .EXPORT sub");
+  temp->write("bc_data.asm", " RTS\n"
+                             "table: .BYTE 1, 2\n");
+}
+
+void BuildCacheTest::cleanup() {
+  temp.reset();
+}
+
+void BuildCacheTest::testLineMap() {
+  ProjectBuilder builder;
+  QVERIFY(builder.build({temp->path("bc_main.asm"), temp->path("bc_sub.asm")}, 0x600));
+
+  const auto& output = builder.output();
+  QCOMPARE(output.files.size(), 3);
+  QCOMPARE(output.files[2], temp->path("bc_data.asm"));
+  QCOMPARE(output.lines.size(), size_t(5));
+  QCOMPARE(output.lines[1].address, Address(0x603));
+  QCOMPARE(output.lines[1].number, 2);
+  QCOMPARE(output.lines[4].address, Address(0x60a));
+  QCOMPARE(output.lines[4].size, Address(2));
+  QCOMPARE(output.lines[4].file, 2);
+  QCOMPARE(output.lines[4].number, 1);
+}
+
+void BuildCacheTest::testReload() {
+  const QStringList files{temp->path("bc_main.asm"), temp->path("bc_sub.asm")};
+  const BuildCache cache(temp->path("cache"));
+  QVERIFY(!cache.load(files, 0x600));
+
+  ProjectBuilder builder;
+  builder.setCache(&cache);
+  QVERIFY(builder.build(files, 0x600));
+  QCOMPARE(builder.assembledCount(), 2);
+
+  // as after a restart
+  ProjectBuilder restarted;
+  restarted.setCache(&cache);
+  QVERIFY(restarted.build(files, 0x600));
+  QCOMPARE(restarted.assembledCount(), 0);
+
+  const auto& stored = builder.output();
+  const auto& loaded = restarted.output();
+  QCOMPARE(loaded.image.chunks.size(), stored.image.chunks.size());
+  for (size_t i = 0; i < stored.image.chunks.size(); i++) {
+    QCOMPARE(loaded.image.chunks[i].first, stored.image.chunks[i].first);
+    QCOMPARE(loaded.image.chunks[i].bytes, stored.image.chunks[i].bytes);
+  }
+  QCOMPARE(loaded.symbols, stored.symbols);
+  QCOMPARE(loaded.files, stored.files);
+  QCOMPARE(loaded.lines.size(), stored.lines.size());
+  QCOMPARE(loaded.lines.back().address, stored.lines.back().address);
+  QCOMPARE(loaded.lines.back().file, stored.lines.back().file);
+  QCOMPARE(loaded.labels.size(), size_t(3));
+  QCOMPARE(loaded.labels.back().name, QString("table"));
+  QCOMPARE(loaded.labels.back().value, stored.labels.back().value);
+}
+
+void BuildCacheTest::testInvalidation() {
+  const QStringList files{temp->path("bc_main.asm"), temp->path("bc_sub.asm")};
+  const BuildCache cache(temp->path("cache"));
+  ProjectBuilder builder;
+  builder.setCache(&cache);
+  QVERIFY(builder.build(files, 0x600));
+  QVERIFY(cache.load(files, 0x600));
+  QVERIFY(!cache.load(files, 0x700));
+  QVERIFY(!cache.load({files[1], files[0]}, 0x600));
+
+  // a change of an include, then of a file listed in the project
+  temp->write("bc_data.asm", " RTS\n"
+                             "table: .BYTE 1, 3\n");
+  QVERIFY(!cache.load(files, 0x600));
+  QVERIFY(builder.build(files, 0x600));
+  QCOMPARE(builder.assembledCount(), 1);
+  QCOMPARE(builder.image().chunks.back().bytes.back(), uint8_t(3));
+  QVERIFY(cache.load(files, 0x600));
+
+  temp->write("bc_main.asm", "start: JMP start\n"
+                             " .EXPORT start");
+  QVERIFY(!cache.load(files, 0x600));
+  QVERIFY(builder.build(files, 0x600));
+  QCOMPARE(builder.symbols().at("sub"), uint16_t(0x603));
+
+  QFile entry(cache.entryFileName(files, 0x600));
+  QVERIFY(entry.open(QIODevice::WriteOnly));
+  entry.write(QByteArray("MO65XBLD"));
+  entry.close();
+  QVERIFY(!cache.load(files, 0x600));
+}
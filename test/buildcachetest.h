@@ -0,0 +1,22 @@
+#pragma once
+
+#include "testfiles.h"
+#include <QObject>
+#include <QString>
+#include <memory>
+
+class BuildCacheTest : public QObject {
+  Q_OBJECT
+public:
+  explicit BuildCacheTest(QObject* parent = nullptr);
+
+private:
+  std::unique_ptr<TestFiles> temp;
+
+private slots:
+  void init();
+  void cleanup();
+  void testLineMap();
+  void testReload();
+  void testInvalidation();
+};
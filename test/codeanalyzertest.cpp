@@ -0,0 +1,194 @@
+#include "codeanalyzertest.h"
+#include "codeanalyzer.h"
+#include "cpudefs.h"
+#include "disassemblycache.h"
+#include "listingindex.h"
+#include <QTest>
+#include <memory>
+
+CodeAnalyzerTest::CodeAnalyzerTest(QObject* parent) : QObject(parent) {
+}
+
+void CodeAnalyzerTest::load(Address addr, std::initializer_list<uint8_t> bytes) {
+  for (auto b : bytes) memory[addr++] = b;
+}
+
+void CodeAnalyzerTest::init() {
+  std::fill(memory.begin(), memory.end(), 0xff);
+  memory.setWord(NmiVector, 0x0300);
+  memory.setWord(ResetVector, 0x0200);
+  memory.setWord(IrqVector, 0x0300);
+  load(0x0300, {0x40}); // RTI
+}
+
+void CodeAnalyzerTest::testVectors() {
+  load(0x0200, {0xa9, 0x00, 0x4c, 0x00, 0x02}); // LDA #0 / JMP $0200
+  auto analyzer = std::make_unique<CodeAnalyzer>(memory);
+  QVERIFY(analyzer->update());
+  QCOMPARE(analyzer->kind(0x0200), CodeAnalyzer::OpcodeByte);
+  QCOMPARE(analyzer->kind(0x0201), CodeAnalyzer::OperandByte);
+  QCOMPARE(analyzer->kind(0x0202), CodeAnalyzer::OpcodeByte);
+  QCOMPARE(analyzer->kind(0x0205), CodeAnalyzer::DataByte);
+  QCOMPARE(analyzer->kind(0x0300), CodeAnalyzer::OpcodeByte);
+  QCOMPARE(analyzer->kind(NmiVector), CodeAnalyzer::DataByte);
+  QCOMPARE(analyzer->blocks().size(), size_t(2));
+  QCOMPARE(analyzer->blockAt(0x0203)->first, Address(0x0200));
+  QCOMPARE(analyzer->blockAt(0x0203)->successors, std::vector<Address>{0x0200});
+  QVERIFY(!analyzer->update());
+}
+
+void CodeAnalyzerTest::testBranches() {
+  // LDX #3 / loop: DEX / BNE loop / RTS / data
+  load(0x0200, {0xa2, 0x03, 0xca, 0xd0, 0xfd, 0x60, 0x12, 0x34});
+  auto analyzer = std::make_unique<CodeAnalyzer>(memory);
+  analyzer->update();
+  QCOMPARE(analyzer->kind(0x0205), CodeAnalyzer::OpcodeByte);
+  QCOMPARE(analyzer->kind(0x0206), CodeAnalyzer::DataByte);
+  QCOMPARE(analyzer->kind(0x0207), CodeAnalyzer::DataByte);
+
+  const auto entry = analyzer->blockAt(0x0200);
+  const auto loop = analyzer->blockAt(0x0202);
+  const auto exit = analyzer->blockAt(0x0205);
+  QVERIFY(entry && loop && exit);
+  QCOMPARE(entry->successors, std::vector<Address>{0x0202});
+  QCOMPARE(loop->last, Address(0x0203));
+  QCOMPARE(loop->successors, (std::vector<Address>{0x0202, 0x0205}));
+  QVERIFY(exit->successors.empty());
+  QVERIFY(!analyzer->blockAt(0x0206));
+}
+
+void CodeAnalyzerTest::testSubroutine() {
+  // JSR $0210 / BRK / ... / $0210: RTS
+  load(0x0200, {0x20, 0x10, 0x02, 0x00});
+  load(0x0210, {0x60});
+  load(0x0400, {0xe8, 0x60}); // INX / RTS, reachable only from an entry point
+  auto analyzer = std::make_unique<CodeAnalyzer>(memory);
+  analyzer->update();
+  QCOMPARE(analyzer->kind(0x0203), CodeAnalyzer::OpcodeByte);
+  QCOMPARE(analyzer->kind(0x0210), CodeAnalyzer::OpcodeByte);
+  QCOMPARE(analyzer->blockAt(0x0200)->successors, (std::vector<Address>{0x0210, 0x0203}));
+  QCOMPARE(analyzer->kind(0x0400), CodeAnalyzer::DataByte);
+
+  analyzer->addEntryPoint(0x0400);
+  QVERIFY(analyzer->update());
+  QCOMPARE(analyzer->kind(0x0400), CodeAnalyzer::OpcodeByte);
+  QCOMPARE(analyzer->kind(0x0401), CodeAnalyzer::OpcodeByte);
+
+  // as after loading a new program
+  analyzer->clearEntryPoints();
+  QVERIFY(analyzer->update());
+  QCOMPARE(analyzer->kind(0x0400), CodeAnalyzer::DataByte);
+  QCOMPARE(analyzer->kind(0x0203), CodeAnalyzer::OpcodeByte);
+}
+
+void CodeAnalyzerTest::testIndirectJump() {
+  // JMP ($02FF) reads the high byte from $0200, not $0300
+  load(0x0200, {0x6c, 0xff, 0x02});
+  memory[0x02ff] = 0x50;
+  load(0x0250, {0x60});
+  auto analyzer = std::make_unique<CodeAnalyzer>(memory);
+  analyzer->update();
+  QCOMPARE(analyzer->kind(0x0250), CodeAnalyzer::DataByte);
+
+  memory[0x02ff] = 0x10;
+  memory[0x6c10] = 0x60;
+  analyzer->invalidate(0x02ff);
+  QVERIFY(analyzer->update());
+  QCOMPARE(analyzer->kind(0x6c10), CodeAnalyzer::OpcodeByte);
+}
+
+void CodeAnalyzerTest::testInvalidation() {
+  load(0x0200, {0xea, 0x60}); // NOP / RTS
+  auto analyzer = std::make_unique<CodeAnalyzer>(memory);
+  analyzer->update();
+  const auto generation = analyzer->generation();
+
+  memory[0x1000] = 0x00;
+  analyzer->invalidate(AddressRange::Max);
+  QVERIFY(!analyzer->update());
+
+  memory[0x0201] = 0xea; // NOP, execution continues into $0202
+  memory[0x0202] = 0x60;
+  analyzer->invalidate({0x0201, 0x0202});
+  QVERIFY(analyzer->update());
+  QCOMPARE(analyzer->generation(), generation + 1);
+  QCOMPARE(analyzer->kind(0x0202), CodeAnalyzer::OpcodeByte);
+}
+
+void CodeAnalyzerTest::testListingIndex() {
+  load(0x0200, {0xa9, 0x00, 0x8d, 0x00, 0xd0, 0x60}); // LDA #0 / STA $D000 / RTS
+  auto analyzer = std::make_unique<CodeAnalyzer>(memory);
+  analyzer->update();
+  auto index = std::make_unique<ListingIndex>(memory, *analyzer);
+
+  // $0000-$01FF in data rows of 3 bytes, the last one shortened to 2 before code starts
+  const auto first = index->rowOf(0x0200);
+  QCOMPARE(first, 0x200 / 3 + 1);
+  QCOMPARE(index->rowAddress(first - 1), Address(0x01fe));
+  QCOMPARE(index->rowLength(first - 1), uint8_t(2));
+  QVERIFY(index->isDataRow(first - 1));
+
+  QVERIFY(!index->isDataRow(first));
+  QCOMPARE(index->rowOf(0x0201), first);
+  QCOMPARE(index->rowOf(0x0204), first + 1);
+  QCOMPARE(index->rowAddress(first + 2), Address(0x0205));
+  QVERIFY(index->isRowStart(0x0202));
+  QVERIFY(!index->isRowStart(0x0203));
+  QCOMPARE(index->rowAddress(index->rows() - 1) + index->rowLength(index->rows() - 1), 0x10000);
+}
+
+// views share one analysis, each redoes its rows when it changed, whichever view ran it
+void CodeAnalyzerTest::testSharedAnalysis() {
+  load(0x0200, {0xa9, 0x00, 0x60}); // LDA #0 / RTS
+  auto analyzer = std::make_unique<CodeAnalyzer>(memory);
+  auto cpuView = std::make_unique<DisassemblyCache>(memory, *analyzer);
+  auto memoryView = std::make_unique<DisassemblyCache>(memory, *analyzer);
+  QCOMPARE(analyzer->generation(), 1u);
+  QVERIFY(memoryView->index().isDataRow(memoryView->index().rowOf(0x0203)));
+
+  load(0x0202, {0xea, 0x60}); // NOP / RTS
+  cpuView->invalidate({0x0202, 0x0203});
+  memoryView->invalidate({0x0202, 0x0203});
+  QVERIFY(cpuView->refresh());
+  QVERIFY(memoryView->refresh());
+  QCOMPARE(analyzer->generation(), 2u);
+  QVERIFY(!memoryView->index().isDataRow(memoryView->index().rowOf(0x0203)));
+  QVERIFY(!cpuView->refresh());
+  QVERIFY(!memoryView->refresh());
+}
+
+// an index updated for the changed range is the one built from scratch
+void CodeAnalyzerTest::testListingIndexUpdate() {
+  load(0x0200, {0xa9, 0x00, 0x8d, 0x00, 0xd0, 0x60}); // LDA #0 / STA $D000 / RTS
+  auto analyzer = std::make_unique<CodeAnalyzer>(memory);
+  analyzer->update();
+  auto index = std::make_unique<ListingIndex>(memory, *analyzer);
+  auto rebuilt = std::make_unique<ListingIndex>(memory, *analyzer);
+
+  const auto change = [&](Address addr, std::initializer_list<uint8_t> bytes) {
+    load(addr, bytes);
+    analyzer->invalidate();
+    QVERIFY(analyzer->update());
+    index->update(analyzer->changedRange());
+    rebuilt->rebuild();
+    QCOMPARE(index->rows(), rebuilt->rows());
+    for (auto row = 0; row < index->rows(); row++) {
+      QCOMPARE(index->rowAddress(row), rebuilt->rowAddress(row));
+      QCOMPARE(index->rowLength(row), rebuilt->rowLength(row));
+    }
+    for (uint32_t a = 0; a < Memory::Size; a++) QCOMPARE(index->rowOf(static_cast<Address>(a)), rebuilt->rowOf(static_cast<Address>(a)));
+  };
+
+  // STA $D000 becomes STA $00 / NOP, one row more
+  change(0x0202, {0x85, 0x00, 0xea});
+  QCOMPARE(analyzer->changedRange().first, Address(0x0202));
+  QCOMPARE(analyzer->changedRange().last, Address(0x0204));
+
+  // RTS becomes a jump to code at the start and the end of memory
+  change(0x0205, {0x4c, 0xfe, 0xff});
+  change(0xfffe, {0x4c, 0x00, 0x00});
+  change(0x0000, {0x60});
+  change(0x0205, {0x60});
+  QCOMPARE(analyzer->changedRange().first, Address(0x0000));
+  QCOMPARE(analyzer->changedRange().last, Address(0xffff));
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "memory.h"
+#include <QObject>
+
+class CodeAnalyzerTest : public QObject {
+  Q_OBJECT
+public:
+  explicit CodeAnalyzerTest(QObject* parent = nullptr);
+
+private:
+  Memory memory;
+
+  void load(Address, std::initializer_list<uint8_t>);
+
+private slots:
+  void init();
+  void testVectors();
+  void testBranches();
+  void testSubroutine();
+  void testIndirectJump();
+  void testInvalidation();
+  void testListingIndex();
+  void testSharedAnalysis();
+  void testListingIndexUpdate();
+};
@@ -0,0 +1,87 @@
+#include "disassemblertest.h"
+#include "disassembler.h"
+#include <QTest>
+
+DisassemblerTest::DisassemblerTest(QObject* parent) : QObject(parent) {
+}
+
+void DisassemblerTest::init() {
+  std::fill(memory.begin(), memory.end(), 0);
+}
+
+QString DisassemblerTest::disassembleAt(Address addr, std::initializer_list<uint8_t> bytes) {
+  auto a = addr;
+  for (auto b : bytes) memory[a++] = b;
+  Disassembler dis(memory, addr);
+  char buf[Disassembler::MaxLineLength];
+  const auto length = dis.disassemble(buf);
+  const auto str = QString::fromLatin1(buf, static_cast<int>(length));
+  if (dis.disassemble() != str) return "QString and buffer output differ";
+  return str;
+}
+
+void DisassemblerTest::testImplied() {
+  QCOMPARE(disassembleAt(0, {0xea}), QString("EA        NOP "));
+  QCOMPARE(disassembleAt(0, {0x0a}), QString("0A        ASL "));
+}
+
+void DisassemblerTest::testOperands() {
+  QCOMPARE(disassembleAt(0, {0xa9, 0x0f}), QString("A9 0F     LDA #$0F"));
+  QCOMPARE(disassembleAt(0, {0xb5, 0x80}), QString("B5 80     LDA $80,X"));
+  QCOMPARE(disassembleAt(0, {0xb6, 0x80}), QString("B6 80     LDX $80,Y"));
+  QCOMPARE(disassembleAt(0, {0xa1, 0x20}), QString("A1 20     LDA ($20,X)"));
+  QCOMPARE(disassembleAt(0, {0xb1, 0x20}), QString("B1 20     LDA ($20),Y"));
+  QCOMPARE(disassembleAt(0, {0x8d, 0x34, 0x12}), QString("8D 34 12  STA $1234"));
+  QCOMPARE(disassembleAt(0, {0xbd, 0x00, 0xc0}), QString("BD 00 C0  LDA $C000,X"));
+  QCOMPARE(disassembleAt(0, {0x6c, 0xfc, 0xff}), QString("6C FC FF  JMP ($FFFC)"));
+}
+
+void DisassemblerTest::testBranch() {
+  QCOMPARE(disassembleAt(0, {0xd0, 0xfe}), QString("D0 FE     BNE -2"));
+  QCOMPARE(disassembleAt(0, {0x10, 0x7f}), QString("10 7F     BPL +127"));
+  QCOMPARE(disassembleAt(0, {0x30, 0x80}), QString("30 80     BMI -128"));
+  QCOMPARE(disassembleAt(0, {0xf0, 0x00}), QString("F0 00     BEQ 0"));
+}
+
+void DisassemblerTest::testWrapAround() {
+  memory[0] = 0x12;
+  QCOMPARE(disassembleAt(0xfffe, {0x4c, 0x34}), QString("4C 34 12  JMP $1234"));
+}
+
+void DisassemblerTest::testRange() {
+  const uint8_t code[] = {0xa9, 0x01, 0x8d, 0x00, 0x02, 0xe8, 0xd0, 0xf8};
+  std::copy(std::begin(code), std::end(code), &memory[0x600]);
+  Disassembler dis(memory);
+  std::vector<Address> addresses;
+  QString lastLine;
+  dis.disassembleRange({0x600, 0x607}, [&](Address addr, const char* line, size_t length) {
+    addresses.push_back(addr);
+    lastLine = QString::fromLatin1(line, static_cast<int>(length));
+  });
+  QCOMPARE(addresses, (std::vector<Address>{0x600, 0x602, 0x605, 0x606}));
+  QCOMPARE(lastLine, QString("D0 F8     BNE -8"));
+
+  // NOPs everywhere but a JMP at $FFFE whose operand wraps to $0000
+  std::fill(memory.begin(), memory.end(), 0xea);
+  memory[0xfffe] = 0x4c;
+  memory[0xffff] = 0x34;
+  memory[0x0000] = 0x12;
+  size_t count = 0;
+  size_t outOfSequence = 0;
+  dis.disassembleRange(AddressRange::Max, [&](Address addr, const char* line, size_t length) {
+    if (addr != count) outOfSequence++;
+    lastLine = QString::fromLatin1(line, static_cast<int>(length));
+    count++;
+  });
+  QCOMPARE(count, size_t(0xffff));
+  QCOMPARE(outOfSequence, size_t(0));
+  QCOMPARE(lastLine, QString("4C 34 12  JMP $1234"));
+
+  addresses.clear();
+  dis.disassembleRange({0xfffc, 0xffff}, [&](Address addr, const char*, size_t) { addresses.push_back(addr); });
+  QCOMPARE(addresses, (std::vector<Address>{0xfffc, 0xfffd, 0xfffe}));
+
+  addresses.clear();
+  dis.disassembleRange({0xfffd, 0xfffe}, [&](Address addr, const char*, size_t) { addresses.push_back(addr); });
+  QCOMPARE(addresses, (std::vector<Address>{0xfffd, 0xfffe}));
+}
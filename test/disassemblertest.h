@@ -0,0 +1,23 @@
+#pragma once
+
+#include "memory.h"
+#include <QObject>
+
+class DisassemblerTest : public QObject {
+  Q_OBJECT
+public:
+  explicit DisassemblerTest(QObject* parent = nullptr);
+
+private:
+  Memory memory;
+
+  QString disassembleAt(Address, std::initializer_list<uint8_t>);
+
+private slots:
+  void init();
+  void testImplied();
+  void testOperands();
+  void testBranch();
+  void testWrapAround();
+  void testRange();
+};
@@ -0,0 +1,128 @@
+#include "framerecordertest.h"
+#include "framerecorder.h"
+#include "testfiles.h"
+#include <QFile>
+#include <QTest>
+
+static Data makeFrame(int width, int height, uint8_t seed) {
+  Data pixels(static_cast<size_t>(width * height));
+  for (size_t i = 0; i < pixels.size(); i++) pixels[i] = static_cast<uint8_t>(i * 7 + seed);
+  return pixels;
+}
+
+FrameRecorderTest::FrameRecorderTest(QObject* parent) : QObject(parent) {
+}
+
+void FrameRecorderTest::testHash() {
+  const auto a = makeFrame(32, 32, 0);
+  auto b = a;
+  QCOMPARE(FrameRecorder::hash(a.data(), 32, 32), FrameRecorder::hash(b.data(), 32, 32));
+  b[1000] ^= 1;
+  QVERIFY(FrameRecorder::hash(a.data(), 32, 32) != FrameRecorder::hash(b.data(), 32, 32));
+  // same bytes, different shape
+  QVERIFY(FrameRecorder::hash(a.data(), 16, 64) != FrameRecorder::hash(a.data(), 32, 32));
+}
+
+void FrameRecorderTest::testHashLogAndGolden() {
+  TestFiles temp;
+  const auto goldenLog = temp.path("golden.hashes");
+  const auto log = temp.path("run.hashes");
+
+  FrameRecorder recorder;
+  CaptureOptions options;
+  options.hashLogFileName = goldenLog;
+  options.waitWhenBehind = true;
+  QVERIFY(recorder.start(options));
+  for (uint8_t i = 0; i < 200; i++) recorder.addFrame(makeFrame(32, 32, i), 32, 32);
+  auto summary = recorder.stop();
+  QCOMPARE(summary.frames, uint64_t(200));
+  QCOMPARE(summary.mismatches, uint64_t(0));
+
+  const auto hashes = FrameRecorder::readHashLog(goldenLog);
+  QCOMPARE(hashes.size(), size_t(200));
+  const auto frame = makeFrame(32, 32, 3);
+  QCOMPARE(hashes[3], FrameRecorder::hash(frame.data(), 32, 32));
+
+  options.hashLogFileName = log;
+  options.goldenFileName = goldenLog;
+  QVERIFY(recorder.start(options));
+  for (uint8_t i = 0; i < 200; i++) recorder.addFrame(makeFrame(32, 32, i == 150 || i == 170 ? 0 : i), 32, 32);
+  summary = recorder.stop();
+  QCOMPARE(summary.mismatches, uint64_t(2));
+  QCOMPARE(summary.firstMismatch, int64_t(150));
+
+}
+
+void FrameRecorderTest::testDroppedFrames() {
+  TestFiles temp;
+  const auto log = temp.path("dropped.hashes");
+  FrameRecorder recorder;
+  CaptureOptions options;
+  options.hashLogFileName = log;
+  options.maxQueuedFrames = 0; // as if the disk never kept up
+  QVERIFY(recorder.start(options));
+  for (uint8_t i = 0; i < 5; i++) recorder.addFrame(makeFrame(32, 32, i), 32, 32);
+  const auto summary = recorder.stop();
+  QCOMPARE(summary.frames, uint64_t(0));
+  QCOMPARE(summary.droppedFrames, uint64_t(5));
+  QVERIFY(FrameRecorder::readHashLog(log).empty());
+}
+
+void FrameRecorderTest::testY4m() {
+  TestFiles temp;
+  const auto fileName = temp.path("capture.y4m");
+  FrameRecorder recorder;
+  CaptureOptions options;
+  options.videoFileName = fileName;
+  options.frameRate = 50;
+  QVERIFY(recorder.start(options));
+  recorder.addFrame(makeFrame(4, 2, 0), 4, 2);
+  recorder.addFrame(makeFrame(2, 2, 0), 2, 2);
+  recorder.addFrame(makeFrame(4, 2, 1), 4, 2);
+  const auto summary = recorder.stop();
+  QCOMPARE(summary.skippedFrames, uint64_t(1));
+
+  QFile file(fileName);
+  QVERIFY(file.open(QIODevice::ReadOnly));
+  const auto content = file.readAll();
+  const QByteArray header("YUV4MPEG2 W4 H2 F50:1 Ip A1:1 Cmono\n");
+  QCOMPARE(content.size(), header.size() + 2 * (6 + 8));
+  QVERIFY(content.startsWith(header));
+  file.close();
+}
+
+void FrameRecorderTest::testRaw() {
+  TestFiles temp;
+  const auto fileName = temp.path("capture.raw");
+  const auto goldenLog = temp.path("raw.hashes");
+  FrameRecorder recorder;
+  CaptureOptions options;
+  options.hashLogFileName = goldenLog;
+  QVERIFY(recorder.start(options));
+  for (uint8_t i = 0; i < 3; i++) recorder.addFrame(makeFrame(320, 200, i), 320, 200);
+  recorder.stop();
+
+  // only the mismatching frame is recorded
+  options.hashLogFileName.clear();
+  options.goldenFileName = goldenLog;
+  options.videoFileName = fileName;
+  options.onlyMismatches = true;
+  QVERIFY(recorder.start(options));
+  for (uint8_t i = 0; i < 3; i++) recorder.addFrame(makeFrame(320, 200, i == 1 ? 9 : i), 320, 200);
+  recorder.stop();
+
+  QFile file(fileName);
+  QVERIFY(file.open(QIODevice::ReadOnly));
+  const auto content = file.readAll();
+  const auto bytes = reinterpret_cast<const uint8_t*>(content.constData());
+  QVERIFY(std::equal(bytes, bytes + 8, FrameRecorder::RawFileMagic));
+  const auto field = [&](int i) { return bytes[8 + 4 * i] | bytes[9 + 4 * i] << 8 | bytes[10 + 4 * i] << 16; };
+  QCOMPARE(field(0), 1);
+  QCOMPARE(field(1), 320);
+  QCOMPARE(field(2), 200);
+  QCOMPARE(content.size(), 8 + 16 + field(3));
+  const auto pixels = qUncompress(bytes + 24, field(3));
+  const auto expected = makeFrame(320, 200, 9);
+  QVERIFY(std::equal(expected.begin(), expected.end(), reinterpret_cast<const uint8_t*>(pixels.constData())));
+  file.close();
+}
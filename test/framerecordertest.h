@@ -0,0 +1,17 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+
+class FrameRecorderTest : public QObject {
+  Q_OBJECT
+public:
+  explicit FrameRecorderTest(QObject* parent = nullptr);
+
+private slots:
+  void testHash();
+  void testHashLogAndGolden();
+  void testDroppedFrames();
+  void testY4m();
+  void testRaw();
+};
@@ -0,0 +1,67 @@
+#include "headlesscapturetest.h"
+#include "headlesscapture.h"
+#include "testfiles.h"
+#include <QFile>
+#include <QTest>
+
+HeadlessCaptureTest::HeadlessCaptureTest(QObject* parent) : QObject(parent) {
+}
+
+void HeadlessCaptureTest::init() {
+  std::fill(memory.begin(), memory.end(), 0);
+  // loop: INC $0200 / JMP loop, so the first pixel of the default screen changes from frame to frame
+  const Data program = {0xee, 0x00, 0x02, 0x4c, 0x00, 0x06};
+  std::copy(program.begin(), program.end(), memory.begin() + 0x0600);
+}
+
+void HeadlessCaptureTest::testGoldenRun() {
+  TestFiles temp;
+  HeadlessCapture::Options options;
+  options.start = 0x0600;
+  options.frames = 10;
+  options.clock = 6000;
+  options.capture.hashLogFileName = temp.path("golden.hashes");
+  auto summary = HeadlessCapture(memory).run(options);
+  QVERIFY(summary.ok());
+  QCOMPARE(summary.frames, uint64_t(10));
+  const auto golden = FrameRecorder::readHashLog(options.capture.hashLogFileName);
+  QCOMPARE(golden.size(), size_t(10));
+  QVERIFY(golden[0] != golden[1]);
+
+  // the same run again matches
+  init();
+  options.capture.hashLogFileName = temp.path("run.hashes");
+  options.capture.goldenFileName = temp.path("golden.hashes");
+  summary = HeadlessCapture(memory).run(options);
+  QCOMPARE(summary.frames, uint64_t(10));
+  QCOMPARE(summary.mismatches, uint64_t(0));
+  QCOMPARE(FrameRecorder::readHashLog(options.capture.hashLogFileName), golden);
+
+  // the golden run has no frames past 10, only those are recorded
+  init();
+  options.frames = 12;
+  options.capture.videoFileName = temp.path("mismatches.y4m");
+  options.capture.onlyMismatches = true;
+  summary = HeadlessCapture(memory).run(options);
+  QCOMPARE(summary.frames, uint64_t(12));
+  QCOMPARE(summary.mismatches, uint64_t(2));
+  QCOMPARE(summary.firstMismatch, int64_t(10));
+  const auto video = temp.read("mismatches.y4m");
+  QVERIFY(video.startsWith("YUV4MPEG2 W32 H32 F60:1 "));
+  QCOMPARE(video.count("FRAME\n"), 2);
+}
+
+void HeadlessCaptureTest::testHalted() {
+  TestFiles temp;
+  memory[0x0603] = 0x02; // KIL
+  HeadlessCapture::Options options;
+  options.start = 0x0600;
+  options.frames = 10;
+  options.capture.hashLogFileName = temp.path("halted.hashes");
+  const auto summary = HeadlessCapture(memory).run(options);
+  QVERIFY(summary.ok());
+  QCOMPARE(summary.frames, uint64_t(0));
+
+  options.capture.goldenFileName = temp.path("missing.hashes");
+  QVERIFY(!HeadlessCapture(memory).run(options).ok());
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "memory.h"
+#include <QObject>
+
+class HeadlessCaptureTest : public QObject {
+  Q_OBJECT
+public:
+  explicit HeadlessCaptureTest(QObject* parent = nullptr);
+
+private:
+  Memory memory;
+
+private slots:
+  void init();
+  void testGoldenRun();
+  void testHalted();
+};
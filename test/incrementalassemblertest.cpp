@@ -0,0 +1,216 @@
+#include "incrementalassemblertest.h"
+#include "incrementalassembler.h"
+#include <QTest>
+#include <memory>
+
+static const std::vector<QString> Program = {
+    "  .ORG $0800",       // 0
+    "start: LDX #3",      // 1
+    "loop: DEX",          // 2
+    "  BNE loop",         // 3
+    "  JSR sub",          // 4
+    "  JMP start",        // 5
+    "sub: LDA table,X",   // 6
+    "  RTS",              // 7
+    "table: .BYTE 1,2,3", // 8
+};
+
+IncrementalAssemblerTest::IncrementalAssemblerTest(QObject* parent) : QObject(parent) {
+}
+
+void IncrementalAssemblerTest::init() {
+  std::fill(memory.begin(), memory.end(), 0);
+}
+
+// compares the memory with what assembling the whole source in passes gives
+bool IncrementalAssemblerTest::matchesFullAssembly(const std::vector<QString>& source) {
+  auto reference = std::make_unique<Memory>();
+  std::fill(reference->begin(), reference->end(), 0);
+  Assembler assembler(*reference);
+  do {
+    assembler.initPreserveSymbols();
+    assembler.changeMode(Assembler::ProcessingMode::ScanForSymbols);
+    for (const auto& line : source) {
+      if (assembler.processLine(line) != AssemblyResult::Ok) return false;
+    }
+  } while (!assembler.sizesSettled());
+
+  assembler.initPreserveSymbols();
+  for (const auto& line : source) {
+    if (assembler.processLine(line) != AssemblyResult::Ok) return false;
+  }
+  return std::equal(memory.cbegin(), memory.cend(), reference->cbegin());
+}
+
+void IncrementalAssemblerTest::testFullAssembly() {
+  IncrementalAssembler assembler(memory);
+  assembler.replaceLines(0, 0, Program);
+  const auto range = assembler.update();
+  QCOMPARE(range.first, Address(0x0800));
+  QCOMPARE(range.last, Address(0x0811));
+  QCOMPARE(assembler.bytesWritten(), 18);
+  QVERIFY(assembler.errors().empty());
+  QCOMPARE(assembler.symbols().size(), size_t(4));
+  QVERIFY(matchesFullAssembly(Program));
+}
+
+void IncrementalAssemblerTest::testEditInPlace() {
+  IncrementalAssembler assembler(memory);
+  assembler.replaceLines(0, 0, Program);
+  assembler.update();
+
+  auto source = Program;
+  source[1] = "start: LDX #2";
+  assembler.replaceLines(1, 1, {source[1]});
+  const auto range = assembler.update();
+  QCOMPARE(range.first, Address(0x0800));
+  QCOMPARE(range.last, Address(0x0801));
+  QCOMPARE(assembler.bytesWritten(), 2);
+  QVERIFY(matchesFullAssembly(source));
+}
+
+void IncrementalAssemblerTest::testUnchangedBytes() {
+  IncrementalAssembler assembler(memory);
+  assembler.replaceLines(0, 0, Program);
+  assembler.update();
+
+  assembler.replaceLines(7, 1, {"  RTS ; back"});
+  QVERIFY(!assembler.update().valid());
+  QCOMPARE(assembler.bytesWritten(), 0);
+}
+
+void IncrementalAssemblerTest::testInsertShiftsSymbols() {
+  IncrementalAssembler assembler(memory);
+  assembler.replaceLines(0, 0, Program);
+  assembler.update();
+
+  auto source = Program;
+  source.insert(source.begin() + 3, "  NOP");
+  assembler.replaceLines(3, 0, {"  NOP"});
+  const auto range = assembler.update();
+  QCOMPARE(assembler.lineCount(), 10);
+  QCOMPARE(range.first, Address(0x0803));
+  QCOMPARE(range.last, Address(0x0812));
+  QCOMPARE(assembler.symbols().at("table"), uint16_t(0x0810));
+  QVERIFY(matchesFullAssembly(source));
+
+  source.erase(source.begin() + 3);
+  assembler.replaceLines(3, 1, {});
+  assembler.update();
+  QCOMPARE(assembler.symbols().at("table"), uint16_t(0x080f));
+  QCOMPARE(memory[0x0803], uint8_t(0xd0));
+  QCOMPARE(memory[0x0804], uint8_t(0xfd));
+}
+
+void IncrementalAssemblerTest::testRemoveDefinition() {
+  IncrementalAssembler assembler(memory);
+  assembler.replaceLines(0, 0, Program);
+  assembler.update();
+
+  assembler.replaceLines(6, 1, {"  LDA table,X"});
+  assembler.update();
+  const auto errors = assembler.errors();
+  QCOMPARE(errors.size(), size_t(1));
+  QCOMPARE(errors.front().result, AssemblyResult::SymbolNotDefined);
+  QCOMPARE(errors.front().line, 4);
+  QCOMPARE(errors.front().column, 6);
+  QCOMPARE(errors.front().symbol, QString("sub"));
+
+  assembler.replaceLines(6, 1, {Program[6]});
+  assembler.update();
+  QVERIFY(assembler.errors().empty());
+  QVERIFY(matchesFullAssembly(Program));
+}
+
+void IncrementalAssemblerTest::testDuplicateLabel() {
+  IncrementalAssembler assembler(memory);
+  assembler.replaceLines(0, 0, {"  .ORG $0900", "x: NOP", "x: RTS", "  JMP x"});
+  assembler.update();
+  auto errors = assembler.errors();
+  QCOMPARE(errors.size(), size_t(1));
+  QCOMPARE(errors.front().result, AssemblyResult::SymbolAlreadyDefined);
+  QCOMPARE(errors.front().line, 2);
+  QCOMPARE(memory[0x0903], uint8_t(0x00));
+
+  // the remaining definition takes over
+  assembler.replaceLines(1, 1, {"  NOP"});
+  assembler.update();
+  QVERIFY(assembler.errors().empty());
+  QCOMPARE(assembler.symbols().at("x"), uint16_t(0x0901));
+  QVERIFY(matchesFullAssembly({"  .ORG $0900", "  NOP", "x: RTS", "  JMP x"}));
+}
+
+void IncrementalAssemblerTest::testErrors() {
+  IncrementalAssembler assembler(memory);
+  assembler.replaceLines(0, 0, {"  LDA #1", "  LDA #", "  BNE far", "  .ORG $0200", "far: RTS"});
+  assembler.update();
+  const auto errors = assembler.errors();
+  QCOMPARE(errors.size(), size_t(2));
+  QCOMPARE(errors[0].result, AssemblyResult::SyntaxError);
+  QCOMPARE(errors[0].line, 1);
+  QCOMPARE(errors[0].column, 7);
+  QCOMPARE(errors[1].result, AssemblyResult::ValueOutOfRange);
+  QCOMPARE(errors[1].line, 2);
+  QCOMPARE(errors[1].symbol, QString("far"));
+  QCOMPARE(memory[0x0200], uint8_t(0x60));
+}
+
+void IncrementalAssemblerTest::testInvalidateMemory() {
+  IncrementalAssembler assembler(memory);
+  assembler.replaceLines(0, 0, Program);
+  assembler.update();
+
+  memory[0x0805] = 0xea;
+  QVERIFY(!assembler.update().valid());
+  assembler.invalidateMemory();
+  const auto range = assembler.update();
+  QCOMPARE(range.first, Address(0x0800));
+  QCOMPARE(range.last, Address(0x0811));
+  QVERIFY(matchesFullAssembly(Program));
+}
+
+void IncrementalAssemblerTest::testZeroPageRelaxation() {
+  const std::vector<QString> source = {
+      "  .ORG $0800",
+      "  LDA var",
+      "  INC var",
+      "  RTS",
+      "  .ORG $00f0",
+      "buf: .BYTE 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0",
+      "var: .BYTE 0",
+  };
+  IncrementalAssembler assembler(memory);
+  assembler.replaceLines(0, 0, source);
+  assembler.update();
+  QCOMPARE(assembler.symbols().get("var"), Address(0x100));
+  QVERIFY(matchesFullAssembly(source));
+
+  // var moves to zero page, so the instructions referring to it shrink and the RTS moves with them
+  assembler.replaceLines(5, 1, {"buf: .BYTE 0,0"});
+  assembler.update();
+  QCOMPARE(assembler.symbols().get("var"), Address(0xf2));
+  const auto expected = Data({0xa5, 0xf2, 0xe6, 0xf2, 0x60});
+  QVERIFY(std::equal(expected.begin(), expected.end(), memory.cbegin() + 0x800));
+  QVERIFY(assembler.errors().empty());
+
+  assembler.replaceLines(5, 1, {source[5]});
+  assembler.update();
+  QVERIFY(matchesFullAssembly(source));
+}
+
+void IncrementalAssemblerTest::testSizesNotSettled() {
+  // as absolute, lbl wraps to $0000, so the LDA shrinks to zero page, which moves lbl back to $FFFF
+  IncrementalAssembler assembler(memory);
+  assembler.replaceLines(0, 0, {"  .ORG $FFFD", "  LDA lbl", "lbl: NOP"});
+  assembler.update();
+  const auto errors = assembler.errors();
+  QCOMPARE(errors.size(), size_t(1));
+  QCOMPARE(errors.front().result, AssemblyResult::SizesNotSettled);
+  QCOMPARE(errors.front().line, 1);
+
+  assembler.replaceLines(0, 1, {"  .ORG $FFF0"});
+  assembler.update();
+  QVERIFY(assembler.errors().empty());
+  const auto expected = Data({0xad, 0xf3, 0xff, 0xea});
+  QVERIFY(std::equal(expected.begin(), expected.end(), memory.cbegin() + 0xfff0));
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "memory.h"
+#include <QObject>
+#include <QString>
+#include <vector>
+
+class IncrementalAssemblerTest : public QObject {
+  Q_OBJECT
+public:
+  explicit IncrementalAssemblerTest(QObject* parent = nullptr);
+
+private:
+  Memory memory;
+
+  bool matchesFullAssembly(const std::vector<QString>& source);
+
+private slots:
+  void init();
+  void testFullAssembly();
+  void testEditInPlace();
+  void testUnchangedBytes();
+  void testInsertShiftsSymbols();
+  void testRemoveDefinition();
+  void testDuplicateLabel();
+  void testErrors();
+  void testInvalidateMemory();
+  void testZeroPageRelaxation();
+  void testSizesNotSettled();
+};
@@ -90,6 +90,50 @@ void InstructionsTest::testReset() {
   QCOMPARE(cpu.regs.pc, 0xFCE2);
 }
 
+void InstructionsTest::testFramePacing() {
+  // main loop counting in X, vblank handler counting in Y
+  QCOMPARE(assembler.processLine("INX"), AssemblyResult::Ok);
+  QCOMPARE(assembler.processLine("JMP $0800"), AssemblyResult::Ok);
+  QCOMPARE(assembler.processLine(".ORG $0900"), AssemblyResult::Ok);
+  QCOMPARE(assembler.processLine("INY"), AssemblyResult::Ok);
+  QCOMPARE(assembler.processLine("RTI"), AssemblyResult::Ok);
+  memory.setWord(CpuAddress::NmiVector, 0x0900);
+
+  int frames = 0;
+  long cyclesAtFrame[3];
+  cpu.executeFrames(1000000, {1000, VBlankInterrupt::Nmi}, [&] {
+    cyclesAtFrame[frames] = cpu.cycles;
+    if (++frames == 3) cpu.stopExecution();
+  });
+  QCOMPARE(frames, 3);
+  QCOMPARE(cpu.state, CpuState::Stopped);
+  QCOMPARE(cpu.regs.y, uint8_t(2));
+  QCOMPARE(cpu.regs.pc, Address(0x0900));
+  for (int i = 0; i < 3; i++) QVERIFY(cyclesAtFrame[i] >= 1000 * (i + 1) && cyclesAtFrame[i] < 1000 * (i + 1) + 7);
+}
+
+void InstructionsTest::testFramePacingKeepsPendingReset() {
+  // a reset requested while running is serviced, not lost to the vblank interrupt of the same frame
+  QCOMPARE(assembler.processLine("INX"), AssemblyResult::Ok);
+  QCOMPARE(assembler.processLine("JMP $0800"), AssemblyResult::Ok);
+  QCOMPARE(assembler.processLine(".ORG $0900"), AssemblyResult::Ok);
+  QCOMPARE(assembler.processLine("RTI"), AssemblyResult::Ok);
+  QCOMPARE(assembler.processLine(".ORG $0a00"), AssemblyResult::Ok);
+  QCOMPARE(assembler.processLine("INC $10"), AssemblyResult::Ok);
+  QCOMPARE(assembler.processLine("JMP $0800"), AssemblyResult::Ok);
+  memory.setWord(CpuAddress::NmiVector, 0x0900);
+  memory.setWord(CpuAddress::ResetVector, 0x0a00);
+  memory[0x10] = 0;
+
+  int frames = 0;
+  cpu.executeFrames(1000000, {1000, VBlankInterrupt::Nmi}, [&] {
+    if (++frames == 1) cpu.triggerReset();
+    if (frames == 3) cpu.stopExecution();
+  });
+  QCOMPARE(memory[0x10], uint8_t(1));
+  QCOMPARE(cpu.runLevel, CpuRunLevel::Normal);
+}
+
 void InstructionsTest::testImpliedMode() {
   cpu.regs.p.interrupt = true;
   TEST_INST("CLI", 2);
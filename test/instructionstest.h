@@ -26,6 +26,8 @@ private slots:
 
   void testIRQ();
   void testReset();
+  void testFramePacing();
+  void testFramePacingKeepsPendingReset();
   void testImpliedMode();
   void testAccumulatorMode();
   void testImmediateMode();
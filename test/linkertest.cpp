@@ -0,0 +1,251 @@
+#include "linkertest.h"
+#include "linker.h"
+#include "moduleassembler.h"
+#include "projectbuilder.h"
+#include "testfiles.h"
+#include <QFile>
+#include <QTest>
+
+using Relocation = ObjectModule::Relocation;
+
+static ObjectModule assemble(const QString& source) {
+  ModuleAssembler assembler;
+  if (!assembler.assemble("module.asm", source)) return {};
+  return assembler.module();
+}
+
+LinkerTest::LinkerTest(QObject* parent) : QObject(parent) {
+}
+
+
+void LinkerTest::testObjectModule() {
+  const auto module = assemble("start: JSR print\n"
+                               " LDA #<start\n"
+                               " BNE start\n"
+                               " .ORG $0300\n"
+                               "table: .WORD start, table\n"
+                               " .EXPORT start, table");
+  QCOMPARE(module.sections.size(), size_t(2));
+  QVERIFY(module.sections[0].relocatable);
+  QCOMPARE(module.sections[0].bytes, Data({0x20, 0, 0, 0xa9, 0, 0xd0, 0xf9}));
+  QVERIFY(!module.sections[1].relocatable);
+  QCOMPARE(module.sections[1].origin, Address(0x300));
+  QCOMPARE(module.sections[1].bytes, Data({0, 0, 0, 3}));
+
+  QCOMPARE(module.exports.size(), size_t(2));
+  QCOMPARE(module.exports[0].name, QString("start"));
+  QVERIFY(module.exports[0].relocatable);
+  QCOMPARE(module.exports[1].value, Address(0x300));
+  QVERIFY(!module.exports[1].relocatable);
+
+  // the branch stays within the relocatable section, the absolute table is not relocated
+  QCOMPARE(module.relocations.size(), size_t(3));
+  QCOMPARE(module.relocations[0].symbol, QString("print"));
+  QCOMPARE(module.relocations[0].kind, Relocation::Word);
+  QCOMPARE(module.relocations[0].offset, Address(1));
+  QCOMPARE(module.relocations[1].kind, Relocation::OperandByte);
+  QCOMPARE(module.relocations[1].selector, ParsedOperand::LoByte);
+  QVERIFY(module.relocations[1].relocatable);
+  QCOMPARE(module.relocations[2].section, 1);
+  QCOMPARE(module.relocations[2].offset, Address(0));
+}
+
+void LinkerTest::testObjectFormat() {
+  const auto module = assemble("start: LDA data\n"
+                               " BEQ far\n"
+                               " .ORG $0400\n"
+                               "data: .BYTE >start, 7\n"
+                               " .EXPORT start");
+  const auto bytes = module.toByteArray();
+  const auto loaded = ObjectModule::fromByteArray(bytes);
+  QVERIFY(loaded.has_value());
+  QCOMPARE(loaded->toByteArray(), bytes);
+  QCOMPARE(loaded->sections[1].bytes, module.sections[1].bytes);
+  QCOMPARE(loaded->relocations.front().symbol, QString("far"));
+
+  auto corrupt = bytes;
+  corrupt[0] = 'X';
+  QVERIFY(!ObjectModule::fromByteArray(corrupt));
+  QVERIFY(!ObjectModule::fromByteArray(bytes.left(bytes.size() - 3)));
+
+  // a field past the end of its section
+  auto outside = module;
+  auto& field = outside.relocations.front();
+  field.offset = static_cast<Address>(outside.sections[static_cast<size_t>(field.section)].bytes.size());
+  QVERIFY(!ObjectModule::fromByteArray(outside.toByteArray()));
+  field.offset--;
+  QVERIFY(ObjectModule::fromByteArray(outside.toByteArray()));
+  field.kind = Relocation::Word;
+  QVERIFY(!ObjectModule::fromByteArray(outside.toByteArray()));
+}
+
+void LinkerTest::testLink() {
+  const auto main = assemble("start: JSR print\n"
+                             " RTS\n"
+                             " .EXPORT start");
+  const auto print = assemble("print: LDA #<msg\n"
+                              " LDX #>msg\n"
+                              " RTS\n"
+                              "msg: .BYTE 1\n"
+                              " .ORG $0200\n"
+                              "ptr: .WORD msg, start\n"
+                              " .EXPORT print");
+  Linker linker;
+  QVERIFY(linker.link({&main, &print}, 0x600));
+
+  const auto& chunks = linker.image().chunks;
+  QCOMPARE(chunks.size(), size_t(3));
+  QCOMPARE(chunks[0].first, Address(0x200));
+  QCOMPARE(chunks[0].bytes, Data({0x09, 0x06, 0x00, 0x06}));
+  QCOMPARE(chunks[1].first, Address(0x600));
+  QCOMPARE(chunks[1].bytes, Data({0x20, 0x04, 0x06, 0x60}));
+  QCOMPARE(chunks[2].first, Address(0x604));
+  QCOMPARE(chunks[2].bytes, Data({0xa9, 0x09, 0xa2, 0x06, 0x60, 0x01}));
+  QCOMPARE(linker.symbols().at("print"), uint16_t(0x604));
+}
+
+void LinkerTest::testBranches() {
+  const auto main = assemble("loop: BEQ done\n"
+                             " BNE exit\n"
+                             " BCC loop\n"
+                             " .ORG $0620\n"
+                             "exit: BVS loop\n"
+                             " .EXPORT exit");
+  const auto done = assemble("done: RTS\n"
+                             " .EXPORT done");
+  Linker linker;
+  QVERIFY(linker.link({&main, &done}, 0x600));
+
+  const auto& chunks = linker.image().chunks;
+  QCOMPARE(chunks.size(), size_t(3));
+  QCOMPARE(chunks[0].bytes, Data({0xf0, 0x04, 0xd0, 0x1c, 0x90, 0xfa}));
+  QCOMPARE(chunks[1].bytes, Data({0x60}));
+  QCOMPARE(chunks[2].bytes, Data({0x70, 0xde}));
+
+  Linker far;
+  QVERIFY(!far.link({&main, &done}, 0x700));
+  QCOMPARE(far.errors().front().result, AssemblyResult::ValueOutOfRange);
+}
+
+void LinkerTest::testLinkErrors() {
+  const auto a = assemble("f: JMP g\n"
+                          " .ORG $0300\n"
+                          " NOP\n"
+                          " .EXPORT f");
+  const auto b = assemble("f: NOP\n"
+                          " .EXPORT f");
+  Linker linker;
+  QVERIFY(!linker.link({&a, &b}, 0x600));
+  QCOMPARE(linker.errors().size(), size_t(2));
+  QCOMPARE(linker.errors()[0].result, AssemblyResult::SymbolAlreadyDefined);
+  QCOMPARE(linker.errors()[0].module, 1);
+  QCOMPARE(linker.errors()[1].result, AssemblyResult::SymbolNotDefined);
+  QCOMPARE(linker.errors()[1].symbol, QString("g"));
+
+  QVERIFY(!linker.link({&a, &a}, 0x600));
+  QCOMPARE(linker.errors().front().result, AssemblyResult::SectionsOverlap);
+
+  const auto pointer = assemble(" LDA (ptr),Y\n");
+  const auto zp = assemble(" .ORG $0080\n"
+                           "ptr: .WORD 0\n"
+                           " .EXPORT ptr");
+  QVERIFY(linker.link({&pointer, &zp}, 0x600));
+  QCOMPARE(linker.image().chunks.back().bytes, Data({0xb1, 0x80}));
+  const auto relocatablePointer = assemble("ptr: .WORD 0\n"
+                                           " .EXPORT ptr");
+  QVERIFY(!linker.link({&pointer, &relocatablePointer}, 0x600));
+  QCOMPARE(linker.errors().front().result, AssemblyResult::ValueOutOfRange);
+
+  ModuleAssembler assembler;
+  QVERIFY(!assembler.assemble("module.asm", "start: NOP\n .ORG start\n .EXPORT missing"));
+  QCOMPARE(assembler.errors().size(), size_t(2));
+  QCOMPARE(assembler.errors()[0].result, AssemblyResult::CommandProcessingError);
+  QCOMPARE(assembler.errors()[1].result, AssemblyResult::SymbolNotDefined);
+  QCOMPARE(assembler.errors()[1].line, 2);
+  QCOMPARE(assembler.errors()[1].symbol, QString("missing"));
+}
+
+void LinkerTest::testIncludes() {
+  TestFiles temp;
+  temp.write("inc_main.asm", "start: JSR sub\n"
+                             "sub: .INCLUDE \"inc_sub.asm\"\n"
+                             " .EXPORT start");
+  temp.write("inc_sub.asm", " LDA #1\n"
+                            " .INCLUDE \"inc_rts.asm\"");
+  temp.write("inc_rts.asm", " RTS");
+  temp.write("inc_self.asm", " NOP\n"
+                             " .INCLUDE \"inc_self.asm\"");
+
+  ModuleAssembler assembler;
+  QVERIFY(assembler.assemble(temp.path("inc_main.asm")));
+  QCOMPARE(assembler.module().sections[0].bytes, Data({0x20, 3, 0, 0xa9, 1, 0x60}));
+  QCOMPARE(assembler.sources().size(), size_t(3));
+  QCOMPARE(assembler.sources()[2].fileName, temp.path("inc_rts.asm"));
+  QVERIFY(assembler.upToDate());
+  temp.write("inc_rts.asm", " RTI");
+  QVERIFY(!assembler.upToDate());
+
+  QVERIFY(!assembler.assemble(temp.path("inc_self.asm")));
+  QCOMPARE(assembler.errors().front().result, AssemblyResult::IncludeTooDeep);
+  QCOMPARE(assembler.errors().front().line, 1);
+
+  QFile::remove(temp.path("inc_rts.asm"));
+  QVERIFY(!assembler.assemble(temp.path("inc_main.asm")));
+  QCOMPARE(assembler.errors().front().result, AssemblyResult::IncludeNotFound);
+  QCOMPARE(assembler.errors().front().fileName, temp.path("inc_sub.asm"));
+
+}
+
+void LinkerTest::testProjectBuilder() {
+  TestFiles temp;
+  temp.write("prj_main.asm", "start: JSR init\n"
+                             " JMP loop\n"
+                             " .EXPORT start");
+  temp.write("prj_init.asm", "init: LDX #0\n"
+                             " RTS\n"
+                             " .EXPORT init");
+  temp.write("prj_loop.asm", "loop: JMP loop\n"
+                             " .EXPORT loop");
+  const QStringList files{temp.path("prj_main.asm"), temp.path("prj_init.asm"), temp.path("prj_loop.asm")};
+
+  ProjectBuilder builder;
+  QVERIFY(builder.build(files, 0x600));
+  QCOMPARE(builder.assembledCount(), 3);
+  QCOMPARE(builder.symbols().at("loop"), uint16_t(0x609));
+  QCOMPARE(builder.image().chunks[0].bytes, Data({0x20, 0x06, 0x06, 0x4c, 0x09, 0x06}));
+
+  QVERIFY(builder.build(files, 0x600));
+  QCOMPARE(builder.assembledCount(), 0);
+
+  // a longer module moves the ones after it, which are only relinked
+  temp.write("prj_init.asm", "init: LDX #0\n"
+                             " LDY #0\n"
+                             " RTS\n"
+                             " .EXPORT init");
+  QVERIFY(builder.build(files, 0x600));
+  QCOMPARE(builder.assembledCount(), 1);
+  QCOMPARE(builder.symbols().at("loop"), uint16_t(0x60b));
+  QCOMPARE(builder.image().chunks[2].bytes, Data({0x4c, 0x0b, 0x06}));
+
+  temp.write("prj_loop.asm", "loop: JMP missing\n"
+                             " .EXPORT loop");
+  QVERIFY(!builder.build(files, 0x600));
+  QCOMPARE(builder.errors().size(), size_t(1));
+  QCOMPARE(builder.errors().front().fileName, files[2]);
+  QCOMPARE(builder.errors().front().line, -1);
+  QCOMPARE(builder.errors().front().result, AssemblyResult::SymbolNotDefined);
+
+}
+
+// a relocatable symbol may end up anywhere, so it is never taken for a zero page address
+void LinkerTest::testZeroPageSymbols() {
+  const auto module = assemble("  LDA var\n"
+                               "  LDA code\n"
+                               "code: RTS\n"
+                               "  .ORG $0080\n"
+                               "var: .BYTE 0");
+  QCOMPARE(module.sections.size(), size_t(2));
+  QCOMPARE(module.sections[0].bytes, Data({0xa5, 0x80, 0xad, 5, 0, 0x60}));
+  QCOMPARE(module.relocations.size(), size_t(1));
+  QCOMPARE(module.relocations[0].offset, Address(3));
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+
+class LinkerTest : public QObject {
+  Q_OBJECT
+public:
+  explicit LinkerTest(QObject* parent = nullptr);
+
+private slots:
+  void testObjectModule();
+  void testObjectFormat();
+  void testLink();
+  void testBranches();
+  void testLinkErrors();
+  void testIncludes();
+  void testProjectBuilder();
+  void testZeroPageSymbols();
+};
@@ -0,0 +1,170 @@
+#include "listingtest.h"
+#include "incrementalassembler.h"
+#include <QTest>
+#include <memory>
+
+static const std::vector<QString> Program = {
+    "  .ORG $08f8",         // 0
+    "start: LDX #3",        // 1
+    "loop: LDA table,X",    // 2
+    "  STA $0200,X",        // 3
+    "  DEX",                // 4
+    "  BNE loop",           // 5, crosses back to page $08
+    "  RTS",                // 6
+    "table: .BYTE 1,2,3,4", // 7
+};
+
+ListingTest::ListingTest(QObject* parent) : QObject(parent) {
+}
+
+void ListingTest::testCycles() {
+  IncrementalAssembler assembler(memory);
+  assembler.replaceLines(0, 0, Program);
+  assembler.update();
+  const auto& listing = assembler.listing();
+  const auto& lines = listing.lines();
+  QCOMPARE(lines.size(), Program.size());
+
+  QCOMPARE(lines[1].source.address, Address(0x08f8));
+  QCOMPARE(lines[1].source.bytes, Data({0xa2, 0x03}));
+  QCOMPARE(lines[1].cycles, 2);
+  QCOMPARE(lines[2].cycles, 4);
+  QCOMPARE(lines[2].penalty, 1);
+  QCOMPARE(lines[3].penalty, 0);
+  QVERIFY(lines[5].branch);
+  QCOMPARE(lines[5].penalty, 2);
+  QCOMPARE(lines[5].target, 0x08fa);
+  QCOMPARE(lines[7].cycles, 0);
+
+  QCOMPARE(listing.annotation(0), QString());
+  QCOMPARE(listing.annotation(3), QString("5"));
+  QCOMPARE(listing.annotation(5), QString("2/4  ! branch to $08fa crosses a page"));
+
+  // an 8-bit index stays within a table at the start of a page, a branch within a page costs 1 when taken
+  const Listing aligned({{"  LDA $0300,Y", {}, 0x1000, {0xb9, 0x00, 0x03}, true},
+                         {"  LDA ($80),Y", {}, 0x1003, {0xb1, 0x80}, true},
+                         {"  BCC +0", {}, 0x1005, {0x90, 0x00}, true},
+                         {"  .BYTE $ea", {}, 0x1007, {0xea}, false}});
+  QCOMPARE(aligned.annotation(0), QString("4"));
+  QCOMPARE(aligned.annotation(1), QString("5+1"));
+  QCOMPARE(aligned.annotation(2), QString("2/3"));
+  QCOMPARE(aligned.annotation(3), QString());
+}
+
+void ListingTest::testBlocks() {
+  IncrementalAssembler assembler(memory);
+  assembler.replaceLines(0, 0, Program);
+  assembler.update();
+  const auto& listing = assembler.listing();
+  const auto& blocks = listing.blocks();
+  QCOMPARE(blocks.size(), size_t(3));
+
+  QCOMPARE(blocks[0].label, QString("start"));
+  QCOMPARE(blocks[0].last, 1);
+  QCOMPARE(blocks[0].cycles.max, 2);
+  QCOMPARE(blocks[0].loopEnd, -1);
+
+  QCOMPARE(blocks[1].label, QString("loop"));
+  QCOMPARE(blocks[1].first, 2);
+  QCOMPARE(blocks[1].last, 6);
+  QCOMPARE(blocks[1].cycles.min, 4 + 5 + 2 + 2 + 6);
+  QCOMPARE(blocks[1].cycles.max, 5 + 5 + 2 + 4 + 6);
+  QCOMPARE(blocks[1].loopEnd, 5);
+  QCOMPARE(blocks[1].loop.min, 4 + 5 + 2 + 4);
+  QCOMPARE(blocks[1].loop.max, 5 + 5 + 2 + 4);
+  QCOMPARE(listing.annotation(2), QString("4+1  [block 19..22, loop 15..16 to line 6]"));
+  QCOMPARE(listing.annotation(7), QString("[block 0]"));
+
+  // a line in error has no bytes, so it costs nothing
+  assembler.replaceLines(4, 1, {"  DEX #1"});
+  assembler.update();
+  QCOMPARE(assembler.listing().blocks()[1].cycles.min, 4 + 5 + 2 + 6);
+}
+
+void ListingTest::testText() {
+  IncrementalAssembler assembler(memory);
+  assembler.replaceLines(0, 0, Program);
+  assembler.update();
+  const auto rows = assembler.listing().toText().split('\n');
+
+  QCOMPARE(rows[1], QString(23, QChar(' ')) + Program[0]);
+  QCOMPARE(rows[2], QString("08F8  A2 03     2      start: LDX #3"));
+  QCOMPARE(rows[6], QString("0901  D0 F7     2/4      BNE loop"));
+  QCOMPARE(rows[8], QString("0904  01 02 03         table: .BYTE 1,2,3,4"));
+  QCOMPARE(rows[9], QString("0907  04"));
+  QCOMPARE(rows[11], QString("; start            block 2"));
+}
+
+void ListingTest::testWarnings() {
+  const std::vector<QString> source = {
+      "  .ORG $0a00",
+      "  LDX #0",
+      "loop: LDA table,X",
+      "  STA $0200,X",
+      "  LDA data,X",
+      "  INX",
+      "  BNE loop",
+      "  RTS",
+      "  .ORG $0afe",
+      "table: .BYTE 1,2,3",
+      "  .ALIGN $100",
+      "data: .BYTE 4,5,6",
+  };
+  IncrementalAssembler assembler(memory);
+  assembler.replaceLines(0, 0, source);
+  assembler.update();
+  QVERIFY(assembler.errors().empty());
+
+  // the branch stays on its page and the aligned table does not cross one
+  const auto& listing = assembler.listing();
+  QCOMPARE(listing.warnings().size(), size_t(1));
+  QCOMPARE(listing.warnings()[0].kind, Listing::Warning::TableCrossesPage);
+  QCOMPARE(listing.warnings()[0].line, 2);
+  QCOMPARE(listing.warnings()[0].address, Address(0x0afe));
+  QVERIFY(listing.toText().endsWith("; warning at line 3: table at $0afe crosses a page\n"));
+
+  assembler.replaceLines(8, 1, {"  .ORG $0b00"});
+  assembler.update();
+  QVERIFY(assembler.listing().warnings().empty());
+}
+
+// an edit annotates again the lines it emits and those whose block totals or warnings change
+void ListingTest::testUpdate() {
+  auto source = Program;
+  IncrementalAssembler assembler(memory);
+  assembler.replaceLines(0, 0, source);
+  assembler.update();
+  QCOMPARE(assembler.changedAnnotations(), std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7}));
+
+  const auto replace = [&](int first, int removed, const std::vector<QString>& added) {
+    assembler.replaceLines(first, removed, added);
+    source.erase(source.begin() + first, source.begin() + first + removed);
+    source.insert(source.begin() + first, added.begin(), added.end());
+    assembler.update();
+
+    auto fullMemory = std::make_unique<Memory>();
+    IncrementalAssembler full(*fullMemory);
+    full.replaceLines(0, 0, source);
+    full.update();
+    QCOMPARE(assembler.listing().toText(), full.listing().toText());
+    for (auto i = 0; i < static_cast<int>(source.size()); i++)
+      QCOMPARE(assembler.listing().annotation(i), full.listing().annotation(i));
+  };
+
+  replace(4, 1, {"  DEY"});
+  QCOMPARE(assembler.changedAnnotations(), std::vector<int>({4}));
+
+  // the lines after a shorter store move, the loop gets faster
+  replace(3, 1, {"  STA $02,X"});
+  QCOMPARE(assembler.changedAnnotations(), std::vector<int>({2, 3, 4, 5, 6, 7}));
+
+  // the branch no longer crosses a page
+  replace(0, 1, {"  .ORG $0900"});
+  QCOMPARE(assembler.changedAnnotations(), std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7}));
+  QVERIFY(assembler.listing().warnings().empty());
+
+  replace(1, 0, {"  NOP"});
+  QCOMPARE(assembler.changedAnnotations(), std::vector<int>({1, 2, 3, 4, 5, 6, 7, 8}));
+  replace(1, 1, {});
+  QCOMPARE(assembler.changedAnnotations(), std::vector<int>({1, 2, 3, 4, 5, 6, 7}));
+}
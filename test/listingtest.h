@@ -0,0 +1,20 @@
+#pragma once
+
+#include "memory.h"
+#include <QObject>
+
+class ListingTest : public QObject {
+  Q_OBJECT
+public:
+  explicit ListingTest(QObject* parent = nullptr);
+
+private:
+  Memory memory;
+
+private slots:
+  void testCycles();
+  void testBlocks();
+  void testText();
+  void testWarnings();
+  void testUpdate();
+};
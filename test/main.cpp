@@ -1,6 +1,22 @@
+#include "addressrangetest.h"
 #include "assemblertest.h"
+#include "batchassemblertest.h"
+#include "buildcachetest.h"
+#include "codeanalyzertest.h"
+#include "disassemblertest.h"
 #include "flagstest.h"
+#include "framerecordertest.h"
+#include "headlesscapturetest.h"
+#include "incrementalassemblertest.h"
 #include "instructionstest.h"
+#include "linkertest.h"
+#include "listingtest.h"
+#include "memorypatchtest.h"
+#include "peepholeoptimizertest.h"
+#include "refreshschedulertest.h"
+#include "sourcemaptest.h"
+#include "symboltabletest.h"
+#include "videodevicetest.h"
 #include <QTest>
 #include <assemblyresult.h>
 
@@ -10,6 +26,31 @@ int main(int argc, char** argv) {
   AssemblerTest assemblerTest;
   InstructionsTest opCodesTest;
   FlagsTest flagsTest;
+  DisassemblerTest disassemblerTest;
+  CodeAnalyzerTest codeAnalyzerTest;
+  VideoDeviceTest videoDeviceTest;
+  FrameRecorderTest frameRecorderTest;
+  IncrementalAssemblerTest incrementalAssemblerTest;
+  MemoryPatchTest memoryPatchTest;
+  LinkerTest linkerTest;
+  BuildCacheTest buildCacheTest;
+  SymbolTableTest symbolTableTest;
+  ListingTest listingTest;
+  PeepholeOptimizerTest peepholeOptimizerTest;
+  SourceMapTest sourceMapTest;
+  BatchAssemblerTest batchAssemblerTest;
+  RefreshSchedulerTest refreshSchedulerTest;
+  HeadlessCaptureTest headlessCaptureTest;
+  AddressRangeTest addressRangeTest;
 
-  return QTest::qExec(&opCodesTest, argc, argv) | QTest::qExec(&assemblerTest, argc, argv) | QTest::qExec(&flagsTest, argc, argv);
+  return QTest::qExec(&opCodesTest, argc, argv) | QTest::qExec(&assemblerTest, argc, argv) | QTest::qExec(&flagsTest, argc, argv) |
+         QTest::qExec(&disassemblerTest, argc, argv) |
+         QTest::qExec(&codeAnalyzerTest, argc, argv) | QTest::qExec(&videoDeviceTest, argc, argv) |
+         QTest::qExec(&frameRecorderTest, argc, argv) | QTest::qExec(&incrementalAssemblerTest, argc, argv) |
+         QTest::qExec(&memoryPatchTest, argc, argv) | QTest::qExec(&linkerTest, argc, argv) |
+         QTest::qExec(&buildCacheTest, argc, argv) | QTest::qExec(&symbolTableTest, argc, argv) |
+         QTest::qExec(&listingTest, argc, argv) | QTest::qExec(&peepholeOptimizerTest, argc, argv) |
+         QTest::qExec(&sourceMapTest, argc, argv) | QTest::qExec(&batchAssemblerTest, argc, argv) |
+         QTest::qExec(&refreshSchedulerTest, argc, argv) | QTest::qExec(&headlessCaptureTest, argc, argv) |
+         QTest::qExec(&addressRangeTest, argc, argv);
 }
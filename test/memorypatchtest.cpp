@@ -0,0 +1,72 @@
+#include "memorypatchtest.h"
+#include "incrementalassembler.h"
+#include "memorypatch.h"
+#include <QTest>
+#include <memory>
+
+MemoryPatchTest::MemoryPatchTest(QObject* parent) : QObject(parent) {
+}
+
+void MemoryPatchTest::init() {
+  std::fill(memory.begin(), memory.end(), 0);
+}
+
+void MemoryPatchTest::testApply() {
+  MemoryPatch patch;
+  patch.chunks.push_back({0x0200, {1, 2, 3}});
+  patch.chunks.push_back({0xfffe, {4, 5}});
+  QCOMPARE(patch.size(), size_t(5));
+  QCOMPARE(patch.range().first, Address(0x0200));
+  QCOMPARE(patch.range().last, Address(0xffff));
+
+  patch.applyTo(memory);
+  QCOMPARE(memory[0x0200], uint8_t(1));
+  QCOMPARE(memory[0x0202], uint8_t(3));
+  QCOMPARE(memory[0x0203], uint8_t(0));
+  QCOMPARE(memory[0xffff], uint8_t(5));
+}
+
+void MemoryPatchTest::testTakePatch() {
+  auto staging = std::make_unique<StagingArea>();
+  for (Address addr = 0x0300; addr < 0x0310; addr++) staging->image()[addr] = static_cast<uint8_t>(addr);
+  staging->markWritten({0x0300, 0x0301});
+  staging->markWritten({0x0305, 0x0306});
+  staging->markWritten({0x0302, 0x0302});
+
+  const auto patch = staging->takePatch();
+  QCOMPARE(patch.chunks.size(), size_t(2));
+  QCOMPARE(patch.chunks[0].first, Address(0x0300));
+  QCOMPARE(patch.chunks[0].bytes, (Data{0x00, 0x01, 0x02}));
+  QCOMPARE(patch.chunks[1].first, Address(0x0305));
+  QCOMPARE(patch.chunks[1].bytes, (Data{0x05, 0x06}));
+  QVERIFY(staging->takePatch().empty());
+}
+
+// what the assembly worker does: bytes of updates with errors are held back until the source assembles cleanly
+void MemoryPatchTest::testStagedAssembly() {
+  auto staging = std::make_unique<StagingArea>();
+  IncrementalAssembler assembler(staging->image());
+  const auto stage = [&] {
+    assembler.update();
+    for (const auto range : assembler.writtenRanges()) staging->markWritten(range);
+  };
+
+  assembler.replaceLines(0, 0, {"  .ORG $0400", "  LDA #1", "  STA $d000", "  RTS"});
+  stage();
+  staging->takePatch().applyTo(memory);
+  QCOMPARE(memory[0x0401], uint8_t(1));
+
+  assembler.replaceLines(1, 1, {"  LDA #2"});
+  assembler.replaceLines(3, 1, {"  JMP nowhere"});
+  stage();
+  QCOMPARE(assembler.errors().size(), size_t(1));
+  QCOMPARE(memory[0x0401], uint8_t(1));
+
+  assembler.replaceLines(3, 1, {"  RTS"});
+  stage();
+  QVERIFY(assembler.errors().empty());
+  const auto patch = staging->takePatch();
+  QCOMPARE(patch.chunks.size(), size_t(1));
+  QCOMPARE(patch.chunks[0].first, Address(0x0400));
+  QCOMPARE(patch.chunks[0].bytes, (Data{0xa9, 0x02}));
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "memory.h"
+#include <QObject>
+
+class MemoryPatchTest : public QObject {
+  Q_OBJECT
+public:
+  explicit MemoryPatchTest(QObject* parent = nullptr);
+
+private:
+  Memory memory;
+
+private slots:
+  void init();
+  void testApply();
+  void testTakePatch();
+  void testStagedAssembly();
+};
@@ -0,0 +1,348 @@
+#include "peepholeoptimizertest.h"
+#include "cpu.h"
+#include <QTest>
+#include <random>
+
+static constexpr int RandomStates = 256;
+static constexpr int MaxSteps = 1000;
+
+using Rewrite = PeepholeOptimizer::Rewrite;
+
+static std::vector<ParsedLine> parse(const std::vector<QString>& source) {
+  LineParser parser;
+  std::vector<ParsedLine> lines(source.size());
+  for (size_t i = 0; i < source.size(); i++) parser.parse(source[i], lines[i]);
+  return lines;
+}
+
+// returns the address of the label done
+static std::optional<uint16_t> assemble(Memory& memory, const std::vector<ParsedLine>& lines) {
+  Assembler assembler(memory);
+  do {
+    assembler.initPreserveSymbols();
+    assembler.changeMode(Assembler::ProcessingMode::ScanForSymbols);
+    for (const auto& line : lines) assembler.processLine(line);
+  } while (!assembler.sizesSettled());
+  assembler.initPreserveSymbols();
+  assembler.changeMode(Assembler::ProcessingMode::EmitCode);
+  for (const auto& line : lines) {
+    if (assembler.processLine(line) != AssemblyResult::Ok) return std::nullopt;
+  }
+  return assembler.symbols().get("done");
+}
+
+static void run(Cpu& cpu, const Registers& regs, Address done) {
+  cpu.regs = regs;
+  cpu.resetStatistics();
+  for (auto steps = 0; cpu.regs.pc != done && steps < MaxSteps; steps++) cpu.execute(false, Duration::zero());
+}
+
+static void compare(const std::vector<Rewrite>& actual, const std::vector<Rewrite>& expected) {
+  QCOMPARE(actual.size(), expected.size());
+  for (size_t i = 0; i < actual.size(); i++) {
+    QCOMPARE(actual[i].kind, expected[i].kind);
+    QCOMPARE(actual[i].line, expected[i].line);
+    QCOMPARE(actual[i].bytesSaved, expected[i].bytesSaved);
+    QCOMPARE(actual[i].cyclesSaved, expected[i].cyclesSaved);
+  }
+}
+
+PeepholeOptimizerTest::PeepholeOptimizerTest(QObject* parent) : QObject(parent) {
+}
+
+std::vector<Rewrite> PeepholeOptimizerTest::optimize(std::vector<ParsedLine>& lines) {
+  Assembler assembler(scratch);
+  return PeepholeOptimizer(assembler).optimize(lines);
+}
+
+void PeepholeOptimizerTest::testLoadAfterStore() {
+  auto lines = parse({
+      "  .ORG $0800",   // 0
+      "  STA $80",      // 1
+      "  LDA $80",      // 2, removed
+      "  ADC #1",       // 3
+      "  STY $84,X",    // 4
+      "  LDY $84,X",    // 5, removed
+      "  DEY",          // 6
+      "  STA $81",      // 7
+      "  LDA $81",      // 8, its Z is read next
+      "  BEQ end",      // 9
+      "  STA ($82),Y",  // 10
+      "  LDA ($82),Y",  // 11, the store may have changed the pointer
+      "  TAX",          // 12
+      "end: RTS",       // 13
+  });
+  compare(optimize(lines), {{Rewrite::LoadAfterStore, 2, 2, 3}, {Rewrite::LoadAfterStore, 5, 2, 4}});
+  QCOMPARE(lines[2].kind, ParsedLine::NoOperation);
+  QCOMPARE(lines[5].kind, ParsedLine::NoOperation);
+  QCOMPARE(lines[8].type, LDA);
+  QCOMPARE(lines[11].type, LDA);
+}
+
+void PeepholeOptimizerTest::testKnownCarry() {
+  auto lines = parse({
+      "  .ORG $0800", // 0
+      "  CLC",        // 1
+      "  LDA $80",    // 2
+      "  CLC",        // 3, removed
+      "  ADC $81",    // 4
+      "  SEC",        // 5
+      "  SEC",        // 6, removed
+      "  SBC #1",     // 7
+      "  BCC low",    // 8
+      "  SEC",        // 9, removed as the branch was not taken
+      "low: SEC",     // 10, may be jumped to
+      "  JSR low",    // 11
+      "  SEC",        // 12, the routine may change the carry
+      "  RTS",        // 13
+  });
+  compare(optimize(lines), {{Rewrite::CarryKnown, 3, 1, 2}, {Rewrite::CarryKnown, 6, 1, 2}, {Rewrite::CarryKnown, 9, 1, 2}});
+  QCOMPARE(lines[1].type, CLC);
+  QCOMPARE(lines[3].kind, ParsedLine::NoOperation);
+  QCOMPARE(lines[10].type, SEC);
+  QCOMPARE(lines[12].type, SEC);
+}
+
+void PeepholeOptimizerTest::testTailCall() {
+  auto lines = parse({
+      "  .ORG $0800",       // 0
+      "  JSR first",        // 1
+      "  RTS",              // 2, removed
+      "first: JSR second",  // 3
+      "last: RTS",          // 4, may be jumped to
+      "second: INC $80",    // 5
+      "  RTS",              // 6
+  });
+  compare(optimize(lines), {{Rewrite::TailCall, 1, 1, 9}, {Rewrite::TailCall, 3, 0, 9}});
+  QCOMPARE(lines[1].type, JMP);
+  QCOMPARE(lines[2].kind, ParsedLine::NoOperation);
+  QCOMPARE(lines[3].type, JMP);
+  QCOMPARE(lines[3].label, QString("first"));
+  QCOMPARE(lines[4].type, RTS);
+}
+
+void PeepholeOptimizerTest::testBranchOverJump() {
+  QString filler = "  .BYTE 0";
+  for (auto i = 0; i < 130; i++) filler += ",0";
+  auto lines = parse({
+      "  .ORG $0800",   // 0
+      "loop: DEX",      // 1
+      "  BEQ skip",     // 2, becomes BNE loop
+      "  JMP loop",     // 3, removed
+      "skip: LDA $80",  // 4
+      "  BCS over",     // 5
+      "  JMP far",      // 6, too far for a branch
+      "over: RTS",      // 7
+      filler,           // 8
+      "far: RTS",       // 9
+  });
+  compare(optimize(lines), {{Rewrite::BranchOverJump, 2, 3, 2}});
+  QCOMPARE(lines[2].type, BNE);
+  QCOMPARE(lines[2].operands.front().symbol, QString("loop"));
+  QCOMPARE(lines[3].kind, ParsedLine::NoOperation);
+  QCOMPARE(lines[4].label, QString("skip"));
+  QCOMPARE(lines[5].type, BCS);
+  QCOMPARE(lines[6].type, JMP);
+}
+
+void PeepholeOptimizerTest::testUnsafeLeftAlone() {
+  const std::vector<QString> source = {
+      "  .ORG $0800",
+      "  STA $80",
+      "in: LDA $80",
+      "  TAX",
+      "  CLC",
+      "  .BYTE $18",
+      "  CLC",
+      "back: CLC",
+      "  JSR far",
+      "  NOP",
+      "  BNE next",
+      "  JMP (vector)",
+      "next: BNE there",
+      "  JMP back",
+      "  NOP",
+      "there: RTS",
+      "far: RTS",
+      "vector: .WORD far",
+  };
+  // a literal target lands on a line without a label, here the second CLC
+  const std::vector<QString> literalBranch = {"  .ORG $0800", "  SEC", "  BCS 1", "  CLC", "  CLC", "  ADC #1", "  RTS"};
+  const std::vector<QString> literalJump = {"  .ORG $0800", "  JSR $0805", "  RTS", "  NOP", "  STA $80", "  LDA $80",
+                                            "  TAX", "  RTS"};
+  for (const auto& unsafe : {source, literalBranch, literalJump}) {
+    auto lines = parse(unsafe);
+    QVERIFY(optimize(lines).empty());
+    const auto expected = parse(unsafe);
+    for (size_t i = 0; i < lines.size(); i++) {
+      QCOMPARE(lines[i].kind, expected[i].kind);
+      QCOMPARE(lines[i].type, expected[i].type);
+    }
+  }
+}
+
+// the label moves back a byte, while the branch after the .ALIGN stays
+void PeepholeOptimizerTest::testRevertWhenBroken() {
+  auto lines = parse({
+      "  .ORG $1000",
+      "  CLC",
+      "  CLC",
+      "back:",
+      "  .ALIGN $80",
+      "  BNE back",
+  });
+  QVERIFY(optimize(lines).empty());
+  QCOMPARE(lines[2].type, CLC);
+}
+
+// the routine is called from $0800 and returns to done; both versions start from the same random registers, zero
+// page and page 4, and must end with the same ones, apart from the stack below the stack pointer
+void PeepholeOptimizerTest::verifyEquivalence(const std::vector<QString>& routine, size_t expectedRewrites) {
+  std::vector<QString> source = {"  .ORG $0800", "  JSR start", "done: BRK", "start:"};
+  source.insert(source.end(), routine.begin(), routine.end());
+  const auto before = parse(source);
+  auto after = before;
+  QCOMPARE(optimize(after).size(), expectedRewrites);
+
+  const auto done = assemble(original, before);
+  QVERIFY(done);
+  const auto optimizedDone = assemble(optimized, after);
+  QVERIFY(optimizedDone);
+  QCOMPARE(*optimizedDone, *done);
+
+  std::mt19937 random(static_cast<unsigned>(expectedRewrites));
+  Cpu originalCpu(original);
+  Cpu optimizedCpu(optimized);
+  originalCpu.reset();
+  optimizedCpu.reset();
+  for (auto state = 0; state < RandomStates; state++) {
+    for (auto address = 0; address < 0x100; address++) {
+      original[static_cast<Address>(address)] = optimized[static_cast<Address>(address)] = static_cast<uint8_t>(random());
+      original[static_cast<Address>(address | 0x400)] = optimized[static_cast<Address>(address | 0x400)] =
+          static_cast<uint8_t>(random());
+    }
+    Registers regs;
+    regs.a = static_cast<uint8_t>(random());
+    regs.x = static_cast<uint8_t>(random());
+    regs.y = static_cast<uint8_t>(random());
+    regs.p = static_cast<uint8_t>(random());
+    regs.pc = 0x0800;
+    regs.sp.offset = 0xff;
+
+    run(originalCpu, regs, *done);
+    run(optimizedCpu, regs, *done);
+    QCOMPARE(originalCpu.regs.pc, *done);
+    QCOMPARE(optimizedCpu.regs.pc, *done);
+    QCOMPARE(optimizedCpu.regs.a, originalCpu.regs.a);
+    QCOMPARE(optimizedCpu.regs.x, originalCpu.regs.x);
+    QCOMPARE(optimizedCpu.regs.y, originalCpu.regs.y);
+    QCOMPARE(optimizedCpu.regs.sp.offset, originalCpu.regs.sp.offset);
+    QCOMPARE(optimizedCpu.regs.p.toByte(), originalCpu.regs.p.toByte());
+    QVERIFY(optimizedCpu.info().executionStatistics.cycles <= originalCpu.info().executionStatistics.cycles);
+    for (auto address = 0; address < 0x100; address++) {
+      QCOMPARE(optimized[static_cast<Address>(address)], original[static_cast<Address>(address)]);
+      QCOMPARE(optimized[static_cast<Address>(address | 0x400)], original[static_cast<Address>(address | 0x400)]);
+    }
+    for (auto address = originalCpu.regs.sp.address() + 1; address < 0x200; address++)
+      QCOMPARE(optimized[static_cast<Address>(address)], original[static_cast<Address>(address)]);
+  }
+}
+
+void PeepholeOptimizerTest::testRandomStates() {
+  verifyEquivalence(
+      {
+          "  LDA $80",
+          "  STA $81",
+          "  LDA $81",
+          "  ADC $0400,X",
+          "  STA $0400,Y",
+          "  LDA $0400,Y",
+          "  EOR $82",
+          "  STX $83",
+          "  LDX $83",
+          "  INX",
+          "  STA $84",
+          "  LDA $84",
+          "  BEQ zero",
+          "  INC $85",
+          "zero: RTS",
+      },
+      3);
+  verifyEquivalence(
+      {
+          "  CLC",
+          "  LDA $80",
+          "  CLC",
+          "  ADC $81",
+          "  STA $82",
+          "  SEC",
+          "  LDX $83",
+          "  SEC",
+          "  SBC $84",
+          "  BCC low",
+          "  SEC",
+          "  ROR $85",
+          "  BCS high",
+          "  CLC",
+          "  ROL $86",
+          "high: RTS",
+          "low: SEC",
+          "  ROL $87",
+          "  RTS",
+      },
+      4);
+  verifyEquivalence(
+      {
+          "  LDA $80",
+          "  BNE other",
+          "  JSR twice",
+          "  RTS",
+          "other: INC $84",
+          "twice: JSR once",
+          "once: INC $81",
+          "  JSR nested",
+          "  RTS",
+          "nested: BMI skip",
+          "  JSR once2",
+          "  RTS",
+          "skip: DEC $82",
+          "last: RTS",
+          "once2: INC $83",
+          "  RTS",
+      },
+      5);
+  verifyEquivalence(
+      {
+          "  BCC c1",
+          "  JMP c2",
+          "c1: INC $80",
+          "c2: BNE n1",
+          "  JMP n2",
+          "n1: INC $81",
+          "n2: BMI m1",
+          "  JMP m2",
+          "m1: INC $82",
+          "m2: BVS v1",
+          "  JMP finish",
+          "v1: INC $83",
+          "finish: RTS",
+      },
+      4);
+  verifyEquivalence(
+      {
+          "  SEC",
+          "  BCS 1",
+          "  CLC",
+          "  CLC",
+          "  LDA $80",
+          "  ADC #1",
+          "  STA $81",
+          "  LDA $81",
+          "  BNE 3",
+          "  JSR twice",
+          "  RTS",
+          "twice: INC $82",
+          "  RTS",
+      },
+      0);
+}
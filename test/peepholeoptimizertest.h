@@ -0,0 +1,28 @@
+#pragma once
+
+#include "memory.h"
+#include "peepholeoptimizer.h"
+#include <QObject>
+
+class PeepholeOptimizerTest : public QObject {
+  Q_OBJECT
+public:
+  explicit PeepholeOptimizerTest(QObject* parent = nullptr);
+
+private:
+  Memory scratch;
+  Memory original;
+  Memory optimized;
+
+  std::vector<PeepholeOptimizer::Rewrite> optimize(std::vector<ParsedLine>&);
+  void verifyEquivalence(const std::vector<QString>& routine, size_t expectedRewrites);
+
+private slots:
+  void testLoadAfterStore();
+  void testKnownCarry();
+  void testTailCall();
+  void testBranchOverJump();
+  void testUnsafeLeftAlone();
+  void testRevertWhenBroken();
+  void testRandomStates();
+};
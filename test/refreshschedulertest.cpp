@@ -0,0 +1,56 @@
+#include "refreshschedulertest.h"
+#include "refreshscheduler.h"
+#include <QTest>
+#include <QWidget>
+#include <vector>
+
+RefreshSchedulerTest::RefreshSchedulerTest(QObject* parent) : QObject(parent) {
+}
+
+void RefreshSchedulerTest::testViewsWithoutHandlers() {
+  QWidget memoryOnly, stateOnly, neither;
+  std::vector<AddressRange> ranges;
+  auto states = 0;
+
+  RefreshScheduler scheduler;
+  scheduler.addView(&memoryOnly, [&](AddressRange range) { ranges.push_back(range); });
+  scheduler.addView(&stateOnly, {}, [&](const EmulatorState&) { states++; });
+  scheduler.addView(&neither, {});
+  for (auto widget : {&memoryOnly, &stateOnly, &neither}) widget->show();
+
+  // each view starts with a full refresh of what it handles
+  scheduler.flush();
+  QCOMPARE(ranges.size(), size_t(1));
+  QCOMPARE(ranges[0].first, AddressRange::Max.first);
+  QCOMPARE(ranges[0].last, AddressRange::Max.last);
+  QCOMPARE(states, 1);
+
+  scheduler.publishState({});
+  scheduler.publishMemoryChange({0x1000, 0x10ff});
+  scheduler.publishMemoryChange(0x0800);
+  scheduler.flush();
+  QCOMPARE(ranges.size(), size_t(2));
+  QCOMPARE(ranges[1].first, Address(0x0800));
+  QCOMPARE(ranges[1].last, Address(0x10ff));
+  QCOMPARE(states, 2);
+
+  // nothing pending
+  scheduler.flush();
+  QCOMPARE(ranges.size(), size_t(2));
+  QCOMPARE(states, 2);
+}
+
+void RefreshSchedulerTest::testHiddenViews() {
+  QWidget widget;
+  auto states = 0;
+
+  RefreshScheduler scheduler;
+  scheduler.addView(&widget, {}, [&](const EmulatorState&) { states++; });
+  scheduler.publishState({});
+  scheduler.flush();
+  QCOMPARE(states, 0);
+
+  widget.show();
+  scheduler.flush();
+  QCOMPARE(states, 1);
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <QObject>
+
+class RefreshSchedulerTest : public QObject {
+  Q_OBJECT
+public:
+  explicit RefreshSchedulerTest(QObject* parent = nullptr);
+
+private slots:
+  void testViewsWithoutHandlers();
+  void testHiddenViews();
+};
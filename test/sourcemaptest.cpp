@@ -0,0 +1,102 @@
+#include "sourcemaptest.h"
+#include "incrementalassembler.h"
+#include "sourcemap.h"
+#include <QTest>
+#include <memory>
+
+SourceMapTest::SourceMapTest(QObject* parent) : QObject(parent) {
+}
+
+void SourceMapTest::testAddRemove() {
+  SourceMap map;
+  map.add(0x1000, 3, 0, 4);
+  map.add(0x1003, 1, 1, 0);
+  map.add(0xfffe, 3, 1, 7);
+  map.add(0x1002, 1, 2, 9);
+  QCOMPARE(map.at(0x1000).file, 0);
+  QCOMPARE(map.at(0x1001).line, 4);
+  QCOMPARE(map.at(0x1002).file, 2);
+  QCOMPARE(map.at(0x1002).line, 9);
+  QCOMPARE(map.at(0x1003).file, 1);
+  QCOMPARE(map.at(0x1003).line, 0);
+  QVERIFY(!map.at(0x1004).valid());
+  QVERIFY(!map.at(0x0fff).valid());
+  QCOMPARE(map.at(0xffff).line, 7);
+  QCOMPARE(map.at(0x0000).line, 7);
+  QVERIFY(!map.at(0x0001).valid());
+
+  // the address taken over by a later line stays with it
+  map.remove(0x1000, 3, 0, 4);
+  QVERIFY(!map.at(0x1000).valid());
+  QVERIFY(!map.at(0x1001).valid());
+  QCOMPARE(map.at(0x1002).line, 9);
+  map.remove(0xfffe, 3, 1, 7);
+  QVERIFY(!map.at(0x0000).valid());
+}
+
+void SourceMapTest::testEditorLines() {
+  IncrementalAssembler assembler(memory);
+  assembler.replaceLines(0, 0, {"  .ORG $0800", "start: LDX #3", "  ; comment", "loop: DEX", "  BNE loop", "  RTS"});
+  assembler.update();
+  auto map = assembler.sourceMap();
+  QVERIFY(!map->at(0x07ff).valid());
+  QCOMPARE(map->at(0x0800).line, 1);
+  QCOMPARE(map->at(0x0801).line, 1);
+  QCOMPARE(map->at(0x0802).line, 3);
+  QCOMPARE(map->at(0x0803).line, 4);
+  QCOMPARE(map->at(0x0805).line, 5);
+  QCOMPARE(map->at(0x0805).file, 0);
+  QVERIFY(!map->at(0x0806).valid());
+
+  assembler.replaceLines(2, 1, {"  NOP", "  NOP"});
+  assembler.replaceLines(5, 1, {"  BNE nowhere"});
+  assembler.update();
+  map = assembler.sourceMap();
+  QCOMPARE(map->at(0x0802).line, 2);
+  QCOMPARE(map->at(0x0803).line, 3);
+  QCOMPARE(map->at(0x0804).line, 4);
+  QVERIFY(!map->at(0x0805).valid());
+  QCOMPARE(map->at(0x0807).line, 6);
+}
+
+// the map handed out stays as it was, an update that moves no code hands out the same one
+void SourceMapTest::testUpdates() {
+  std::vector<QString> source = {"  .ORG $0800", "start: LDX #3", "  ; comment", "loop: DEX", "  BNE loop", "  RTS"};
+  IncrementalAssembler assembler(memory);
+  assembler.replaceLines(0, 0, source);
+  assembler.update();
+  auto held = assembler.sourceMap();
+
+  const auto replace = [&](int first, int removed, const std::vector<QString>& added) {
+    assembler.replaceLines(first, removed, added);
+    source.erase(source.begin() + first, source.begin() + first + removed);
+    source.insert(source.begin() + first, added.begin(), added.end());
+    assembler.update();
+
+    auto fullMemory = std::make_unique<Memory>();
+    IncrementalAssembler full(*fullMemory);
+    full.replaceLines(0, 0, source);
+    full.update();
+    const auto map = assembler.sourceMap();
+    const auto expected = full.sourceMap();
+    for (auto addr = 0; addr < static_cast<int>(Memory::Size); addr++) {
+      QCOMPARE(map->at(static_cast<Address>(addr)).line, expected->at(static_cast<Address>(addr)).line);
+    }
+  };
+
+  replace(2, 1, {"  ; another comment"});
+  QCOMPARE(assembler.sourceMap(), held);
+
+  // lines after an insertion are numbered again, also where their code stays in place
+  replace(0, 0, {"  ; title"});
+  QVERIFY(assembler.sourceMap() != held);
+  QCOMPARE(held->at(0x0800).line, 1);
+  QCOMPARE(assembler.sourceMap()->at(0x0800).line, 2);
+
+  held.reset();
+  replace(4, 1, {"loop: DEY", "  NOP"});
+  replace(2, 2, {});
+  replace(1, 1, {"  .ORG $0900"});
+  QVERIFY(!assembler.sourceMap()->at(0x0800).valid());
+  QCOMPARE(assembler.sourceMap()->at(0x0900).line, 2);
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "memory.h"
+#include <QObject>
+
+class SourceMapTest : public QObject {
+  Q_OBJECT
+public:
+  explicit SourceMapTest(QObject* parent = nullptr);
+
+private:
+  Memory memory;
+
+private slots:
+  void testAddRemove();
+  void testEditorLines();
+  void testUpdates();
+};
@@ -0,0 +1,91 @@
+#include "symboltabletest.h"
+#include "symboltable.h"
+#include <QTest>
+#include <map>
+
+SymbolTableTest::SymbolTableTest(QObject* parent) : QObject(parent) {
+}
+
+void SymbolTableTest::testPutGet() {
+  SymbolTable table;
+  QVERIFY(table.empty());
+  QVERIFY(table.put("start", 0x600));
+  QVERIFY(table.put("Start", 0x700));
+  QVERIFY(!table.put("start", 0x800));
+  QCOMPARE(table.size(), size_t(2));
+  QCOMPARE(table.get("start"), std::optional<uint16_t>(0x600));
+  QCOMPARE(table.get("Start"), std::optional<uint16_t>(0x700));
+  QCOMPARE(table.get("star"), std::nullopt);
+  QVERIFY(table.contains("Start"));
+  QCOMPARE(table.at("start"), uint16_t(0x600));
+
+  table.set("start", 0x900);
+  table.set("loop", 0x901);
+  QCOMPARE(table.get("start"), std::optional<uint16_t>(0x900));
+  QCOMPARE(table.size(), size_t(3));
+
+  SymbolTable other;
+  other.put("loop", 0x901);
+  other.put("Start", 0x700);
+  QVERIFY(other != table);
+  other.put("start", 0x900);
+  QVERIFY(other == table);
+
+  table.clear();
+  QVERIFY(table.empty());
+  QCOMPARE(table.get("loop"), std::nullopt);
+  QVERIFY(table.symbolAt(0x901).isEmpty());
+}
+
+void SymbolTableTest::testAddressIndex() {
+  SymbolTable table;
+  QVERIFY(table.symbolAt(0).isEmpty());
+  table.put("reset", 0xfffc);
+  table.put("main", 0x600);
+  table.put("entry", 0x600);
+  table.put("loop", 0x603);
+
+  QCOMPARE(table.symbolAt(0x600).toString(), QString("main"));
+  QCOMPARE(table.symbolsAt(0x600).size(), size_t(2));
+  QCOMPARE(table.symbolsAt(0x600)[1].toString(), QString("entry"));
+  QCOMPARE(table.symbolAt(0xfffc).toString(), QString("reset"));
+  QVERIFY(table.symbolAt(0x601).isEmpty());
+
+  table.erase("main");
+  QCOMPARE(table.symbolAt(0x600).toString(), QString("entry"));
+  table.set("loop", 0x600);
+  QCOMPARE(table.symbolsAt(0x600).size(), size_t(2));
+  QVERIFY(table.symbolAt(0x603).isEmpty());
+
+  QStringList names;
+  for (const auto& [name, value] : table) names.append(name.toString());
+  QCOMPARE(names, QStringList({"reset", "entry", "loop"}));
+}
+
+void SymbolTableTest::testEraseAndGrow() {
+  SymbolTable table;
+  std::map<QString, uint16_t> reference;
+  uint32_t seed = 1;
+  for (auto i = 0; i < 20000; i++) {
+    seed = seed * 1103515245 + 12345;
+    const auto name = QString("s%1").arg(seed >> 20 & 0x3ff);
+    const auto value = static_cast<uint16_t>(seed >> 4);
+    switch (seed >> 16 & 3) {
+    case 0: QCOMPARE(table.erase(name), reference.erase(name) > 0); break;
+    case 1:
+      table.set(name, value);
+      reference[name] = value;
+      break;
+    default: QCOMPARE(table.put(name, value), reference.emplace(name, value).second);
+    }
+  }
+
+  QCOMPARE(table.size(), reference.size());
+  for (const auto& [name, value] : reference) {
+    QCOMPARE(table.get(name), std::optional<uint16_t>(value));
+    QVERIFY(!table.symbolsAt(value).empty());
+  }
+  size_t indexed = 0;
+  for (uint32_t addr = 0; addr <= 0xffff; addr++) indexed += table.symbolsAt(static_cast<uint16_t>(addr)).size();
+  QCOMPARE(indexed, reference.size());
+}
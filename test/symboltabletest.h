@@ -0,0 +1,14 @@
+#pragma once
+
+#include <QObject>
+
+class SymbolTableTest : public QObject {
+  Q_OBJECT
+public:
+  explicit SymbolTableTest(QObject* parent = nullptr);
+
+private slots:
+  void testPutGet();
+  void testAddressIndex();
+  void testEraseAndGrow();
+};
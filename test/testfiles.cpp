@@ -0,0 +1,16 @@
+#include "testfiles.h"
+#include <QFile>
+#include <QTest>
+#include <QTextStream>
+
+void TestFiles::write(const QString& name, const QString& contents) const {
+  QFile file(path(name));
+  QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Text));
+  QTextStream(&file) << contents;
+}
+
+QByteArray TestFiles::read(const QString& name) const {
+  QFile file(path(name));
+  if (!file.open(QIODevice::ReadOnly)) return {};
+  return file.readAll();
+}
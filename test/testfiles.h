@@ -0,0 +1,19 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QTemporaryDir>
+
+// A directory of its own for the files of a test, removed with everything in it when the test ends, so runs in
+// parallel do not clobber each other and a failed run leaves nothing behind
+class TestFiles {
+public:
+  bool valid() const { return directory.isValid(); }
+  QString path(const QString& name) const { return directory.filePath(name); }
+
+  void write(const QString& name, const QString& contents) const;
+  QByteArray read(const QString& name) const; // empty if there is no such file
+
+private:
+  QTemporaryDir directory;
+};
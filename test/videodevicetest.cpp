@@ -0,0 +1,125 @@
+#include "videodevicetest.h"
+#include "videodevice.h"
+#include <QTest>
+
+VideoDeviceTest::VideoDeviceTest(QObject* parent) : QObject(parent) {
+}
+
+void VideoDeviceTest::setRegisters(std::initializer_list<uint8_t> values) {
+  auto addr = VideoDevice::RegistersBase;
+  for (auto v : values) memory[addr++] = v;
+}
+
+void VideoDeviceTest::init() {
+  std::fill(memory.begin(), memory.end(), 0);
+}
+
+void VideoDeviceTest::testDefaultMode() {
+  memory[0x200] = 5;
+  memory[0x200 + 32 * 32 - 1] = 7;
+  VideoDevice device;
+  const auto& pixels = device.render(memory);
+  QCOMPARE(device.width(), 32);
+  QCOMPARE(device.height(), 32);
+  QCOMPARE(pixels.front(), uint8_t(5));
+  QCOMPARE(pixels.back(), uint8_t(7));
+}
+
+void VideoDeviceTest::testBitmap1bpp() {
+  // 16x2 at $4000, colours 6 and 14
+  setRegisters({VideoDevice::BitmapMode, 1, 16, 0, 2, 0x00, 0x40, 0, 0, 0, 0, 0, 6, 14});
+  memory[0x4000] = 0b10000001;
+  memory[0x4003] = 0xff;
+  VideoDevice device;
+  const auto& pixels = device.render(memory);
+  QCOMPARE(device.width(), 16);
+  QCOMPARE(device.height(), 2);
+  QCOMPARE(pixels.size(), size_t(32));
+  QCOMPARE(pixels[0], uint8_t(14));
+  QCOMPARE(pixels[1], uint8_t(6));
+  QCOMPARE(pixels[7], uint8_t(14));
+  QCOMPARE(pixels[8], uint8_t(6));
+  QCOMPARE(pixels[24], uint8_t(14));
+  QCOMPARE(pixels[31], uint8_t(14));
+
+  memory[VideoDevice::RegistersBase + VideoDevice::Palette] = 2;
+  QCOMPARE(device.render(memory)[1], uint8_t(2));
+}
+
+void VideoDeviceTest::testBitmap2bpp() {
+  setRegisters({VideoDevice::BitmapMode, 2, 4, 0, 1, 0x00, 0x40, 0, 0, 0, 0, 0, 10, 11, 12, 13});
+  memory[0x4000] = 0b00011011;
+  VideoDevice device;
+  const auto& pixels = device.render(memory);
+  QCOMPARE(pixels, (Data{10, 11, 12, 13}));
+}
+
+void VideoDeviceTest::testBitmap4bpp() {
+  setRegisters({VideoDevice::BitmapMode, 4, 4, 0, 1, 0x00, 0x40});
+  memory[0x4000] = 0x12;
+  memory[0x4001] = 0xef;
+  VideoDevice device;
+  QCOMPARE(device.render(memory), (Data{1, 2, 14, 15}));
+}
+
+void VideoDeviceTest::testBitmap8bpp() {
+  setRegisters({VideoDevice::BitmapMode, 8, 3, 0, 2, 0x00, 0x40});
+  memory[0x4000] = 0x12;
+  memory[0x4005] = 0xef;
+  VideoDevice device;
+  QCOMPARE(device.render(memory), (Data{0x12, 0, 0, 0, 0, 0xef}));
+
+  // 320x200 at 4 bpp, the largest bitmap fitting in memory besides the registers
+  setRegisters({VideoDevice::BitmapMode, 4, 0x40, 0x01, 200, 0x00, 0x10});
+  memory[0x1000 + 160 * 200 - 1] = 0x09;
+  const auto& pixels = device.render(memory);
+  QCOMPARE(device.width(), 320);
+  QCOMPARE(device.height(), 200);
+  QCOMPARE(pixels.back(), uint8_t(9));
+}
+
+void VideoDeviceTest::testTextMode() {
+  // 2x1 characters, screen at $0400, charset at $2000, colours at $0800, background 6
+  setRegisters({VideoDevice::TextMode, 0, 16, 0, 8, 0x00, 0x04, 0x00, 0x20, 0x00, 0x08, 6});
+  memory[0x0400] = 1;
+  memory[0x0401] = 0;
+  memory[0x0800] = 0xf1; // only the low nibble is used
+  memory[0x0801] = 2;
+  memory[0x2000 + 8 + 0] = 0b11000000;
+  memory[0x2000 + 8 + 7] = 0b00000001;
+  memory[0x2000 + 0] = 0xff;
+  VideoDevice device;
+  const auto& pixels = device.render(memory);
+  QCOMPARE(device.width(), 16);
+  QCOMPARE(device.height(), 8);
+  QCOMPARE(pixels[0], uint8_t(1));
+  QCOMPARE(pixels[1], uint8_t(1));
+  QCOMPARE(pixels[2], uint8_t(6));
+  QCOMPARE(pixels[8], uint8_t(2));
+  QCOMPARE(pixels[15], uint8_t(2));
+  QCOMPARE(pixels[7 * 16 + 7], uint8_t(1));
+  QCOMPARE(pixels[7 * 16 + 6], uint8_t(6));
+}
+
+void VideoDeviceTest::testDependencies() {
+  VideoDevice device;
+  device.render(memory);
+  QVERIFY(device.dependsOn(0x0200));
+  QVERIFY(device.dependsOn(VideoDevice::RegistersBase + VideoDevice::Mode));
+  QVERIFY(!device.dependsOn(0x0600));
+
+  setRegisters({VideoDevice::TextMode, 0, 0x40, 0x01, 200, 0x00, 0x04, 0x00, 0x20, 0x00, 0x08});
+  device.render(memory);
+  QVERIFY(!device.dependsOn(0x0200));
+  QVERIFY(device.dependsOn(0x07e7));
+  QVERIFY(device.dependsOn(0x27ff));
+  QVERIFY(device.dependsOn(0x0800));
+
+  setRegisters({VideoDevice::BitmapMode, 8, 0x20, 0x00, 0x20, 0x00, 0xfe});
+  device.render(memory);
+  QVERIFY(device.dependsOn(0xffff));
+  QVERIFY(device.dependsOn(0x0000));
+  QVERIFY(device.dependsOn(0x01ff));
+  QVERIFY(!device.dependsOn(0x0200));
+  QVERIFY(!device.dependsOn(0xfdff));
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "memory.h"
+#include <QObject>
+
+class VideoDeviceTest : public QObject {
+  Q_OBJECT
+public:
+  explicit VideoDeviceTest(QObject* parent = nullptr);
+
+private:
+  Memory memory;
+
+  void setRegisters(std::initializer_list<uint8_t>);
+
+private slots:
+  void init();
+  void testDefaultMode();
+  void testBitmap1bpp();
+  void testBitmap2bpp();
+  void testBitmap4bpp();
+  void testBitmap8bpp();
+  void testTextMode();
+  void testDependencies();
+};
@@ -0,0 +1,155 @@
+#include "videodevice.h"
+#include <cstring>
+
+namespace {
+
+// 0xff for every set bit, most significant bit first
+constexpr std::array<std::array<uint8_t, 8>, 256> BitMasks = [] {
+  std::array<std::array<uint8_t, 8>, 256> arr{};
+  for (size_t b = 0; b < arr.size(); b++) {
+    for (size_t i = 0; i < 8; i++) arr[b][i] = (b << i) & 0x80 ? 0xff : 0x00;
+  }
+  return arr;
+}();
+
+// high nibble first
+constexpr std::array<std::array<uint8_t, 2>, 256> Nibbles = [] {
+  std::array<std::array<uint8_t, 2>, 256> arr{};
+  for (size_t b = 0; b < arr.size(); b++) arr[b] = {static_cast<uint8_t>(b >> 4), static_cast<uint8_t>(b & 0x0f)};
+  return arr;
+}();
+
+constexpr uint64_t Replicate = 0x0101010101010101;
+
+inline uint64_t load64(const void* p) {
+  uint64_t v;
+  std::memcpy(&v, p, sizeof v);
+  return v;
+}
+
+inline Address wordAt(const Memory& memory, Address addr) {
+  return static_cast<Address>(memory[addr] | memory[static_cast<Address>(addr + 1)] << 8);
+}
+
+} // namespace
+
+VideoDevice::VideoDevice() {
+  lutPalette = {0, 1, 2, 3};
+  for (size_t b = 0; b < 256; b++) {
+    for (size_t i = 0; i < 8; i++) expand1bpp[b][i] = BitMasks[b][i] & 1;
+    for (size_t i = 0; i < 4; i++) expand2bpp[b][i] = (b >> (6 - 2 * i)) & 3;
+  }
+}
+
+const Data& VideoDevice::render(const Memory& memory) {
+  const auto reg = [&](Register r) { return memory[static_cast<Address>(RegistersBase + r)]; };
+
+  sources.fill(AddressRange::Invalid);
+  switch (reg(Mode)) {
+  case BitmapMode: renderBitmap(memory, reg(BitsPerPixel)); break;
+  case TextMode: renderText(memory); break;
+  default: renderDefault(memory); break;
+  }
+  return frame;
+}
+
+bool VideoDevice::dependsOn(AddressRange range) const {
+  if (range.overlapsWith({RegistersBase, static_cast<Address>(RegistersBase + NumberOfRegisters - 1)})) return true;
+
+  return std::any_of(sources.begin(), sources.end(), [&](auto source) { return source.overlapsWith(range); });
+}
+
+void VideoDevice::watch(size_t source, Address first, size_t size) {
+  const auto parts = AddressRange::wrapping(first, size);
+  std::copy(parts.begin(), parts.end(), sources.begin() + static_cast<std::ptrdiff_t>(2 * source));
+}
+
+void VideoDevice::resize(int width, int height) {
+  frameWidth = width;
+  frameHeight = height;
+  frame.resize(static_cast<size_t>(width * height));
+}
+
+void VideoDevice::updateLookupTables(const Memory& memory) {
+  std::array<uint8_t, 4> palette;
+  for (size_t i = 0; i < palette.size(); i++) palette[i] = memory[static_cast<Address>(RegistersBase + Palette + i)];
+  if (palette == lutPalette) return;
+
+  lutPalette = palette;
+  const auto bg = Replicate * palette[0];
+  const auto fg = Replicate * palette[1];
+  for (size_t b = 0; b < 256; b++) {
+    const auto mask = load64(BitMasks[b].data());
+    const uint64_t pixels = (mask & fg) | (~mask & bg);
+    std::memcpy(expand1bpp[b].data(), &pixels, sizeof pixels);
+    for (size_t i = 0; i < 4; i++) expand2bpp[b][i] = palette[(b >> (6 - 2 * i)) & 3];
+  }
+}
+
+void VideoDevice::renderDefault(const Memory& memory) {
+  resize(DefaultResolution, DefaultResolution);
+  watch(0, defaultFrameBuffer, frame.size());
+  for (size_t i = 0; i < frame.size(); i++) frame[i] = memory[static_cast<Address>(defaultFrameBuffer + i)];
+}
+
+void VideoDevice::renderBitmap(const Memory& memory, int bpp) {
+  if (bpp != 1 && bpp != 2 && bpp != 4) bpp = 8;
+  const auto pixelsPerByte = 8 / bpp;
+  const auto reg = [&](Register r) { return memory[static_cast<Address>(RegistersBase + r)]; };
+  const auto width = std::clamp((reg(WidthLo) | reg(WidthHi) << 8) / pixelsPerByte * pixelsPerByte, pixelsPerByte, MaxWidth);
+  const auto height = std::clamp(int(reg(Height)), 1, MaxHeight);
+  const auto bytesPerRow = static_cast<size_t>(width / pixelsPerByte);
+  const auto screen = wordAt(memory, RegistersBase + ScreenLo);
+
+  resize(width, height);
+  updateLookupTables(memory);
+  watch(0, screen, bytesPerRow * static_cast<size_t>(height));
+
+  auto dst = frame.data();
+  Address src = screen;
+  const auto total = bytesPerRow * static_cast<size_t>(height);
+  switch (bpp) {
+  case 1:
+    for (size_t i = 0; i < total; i++, dst += 8) std::memcpy(dst, expand1bpp[memory[src++]].data(), 8);
+    break;
+  case 2:
+    for (size_t i = 0; i < total; i++, dst += 4) std::memcpy(dst, expand2bpp[memory[src++]].data(), 4);
+    break;
+  case 4:
+    for (size_t i = 0; i < total; i++, dst += 2) std::memcpy(dst, Nibbles[memory[src++]].data(), 2);
+    break;
+  default:
+    for (size_t i = 0; i < total; i++) *dst++ = memory[src++];
+    break;
+  }
+}
+
+void VideoDevice::renderText(const Memory& memory) {
+  const auto reg = [&](Register r) { return memory[static_cast<Address>(RegistersBase + r)]; };
+  const auto columns = std::clamp((reg(WidthLo) | reg(WidthHi) << 8) / CharSize, 1, MaxWidth / CharSize);
+  const auto rows = std::clamp(reg(Height) / CharSize, 1, MaxHeight / CharSize);
+  const auto screen = wordAt(memory, RegistersBase + ScreenLo);
+  const auto charset = wordAt(memory, RegistersBase + CharsetLo);
+  const auto colors = wordAt(memory, RegistersBase + ColorsLo);
+  const auto cells = static_cast<size_t>(columns * rows);
+  const auto bg = Replicate * reg(Background);
+
+  resize(columns * CharSize, rows * CharSize);
+  watch(0, screen, cells);
+  watch(1, charset, 256 * CharSize);
+  watch(2, colors, cells);
+
+  for (int row = 0; row < rows; row++) {
+    for (int col = 0; col < columns; col++) {
+      const auto cell = static_cast<Address>(row * columns + col);
+      const auto glyph = static_cast<Address>(charset + memory[static_cast<Address>(screen + cell)] * CharSize);
+      const auto fg = Replicate * (memory[static_cast<Address>(colors + cell)] & 0x0f);
+      auto dst = &frame[static_cast<size_t>((row * CharSize * columns + col) * CharSize)];
+      for (int line = 0; line < CharSize; line++, dst += frameWidth) {
+        const auto mask = load64(BitMasks[memory[static_cast<Address>(glyph + line)]].data());
+        const uint64_t pixels = (mask & fg) | (~mask & bg);
+        std::memcpy(dst, &pixels, sizeof pixels);
+      }
+    }
+  }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "addressrange.h"
+#include "commondefs.h"
+#include "memory.h"
+#include <array>
+
+// Frame generator configured through registers in memory, producing one palette index per pixel
+class VideoDevice {
+public:
+  static constexpr Address RegistersBase = 0xd000;
+  static constexpr int MaxWidth = 320;
+  static constexpr int MaxHeight = 200;
+  static constexpr int DefaultResolution = 32;
+  static constexpr int CharSize = 8;
+
+  enum Register : uint8_t {
+    Mode,
+    BitsPerPixel, // 1, 2, 4 or 8 in bitmap mode
+    WidthLo,      // in pixels, multiple of 8 in text mode
+    WidthHi,
+    Height,
+    ScreenLo, // bitmap data or text screen codes
+    ScreenHi,
+    CharsetLo, // text mode, 8 bytes per character
+    CharsetHi,
+    ColorsLo, // text mode, foreground colour per character
+    ColorsHi,
+    Background, // text mode
+    Palette,    // 4 colours for pixel values in 1 and 2 bpp
+    NumberOfRegisters = Palette + 4
+  };
+
+  enum VideoMode : uint8_t {
+    DefaultMode, // 32x32 bytes at the default frame buffer address, as before registers existed
+    BitmapMode,
+    TextMode
+  };
+
+  VideoDevice();
+
+  void setDefaultFrameBuffer(Address addr) { defaultFrameBuffer = addr; }
+
+  const Data& render(const Memory&);
+  const Data& pixels() const { return frame; }
+  int width() const { return frameWidth; }
+  int height() const { return frameHeight; }
+
+  // whether a write to the range may change the next frame
+  bool dependsOn(AddressRange) const;
+
+private:
+  using Pixels8 = std::array<uint8_t, 8>;
+
+  Address defaultFrameBuffer = 0x200;
+  Data frame;
+  int frameWidth = 0;
+  int frameHeight = 0;
+  std::array<AddressRange, 6> sources; // two parts per source, the second one where it wraps past $FFFF
+
+  // expansion of a source byte into pixels, the palette dependent ones rebuilt when palette registers change
+  std::array<Pixels8, 256> expand1bpp;
+  std::array<std::array<uint8_t, 4>, 256> expand2bpp;
+  std::array<uint8_t, 4> lutPalette{};
+
+  void watch(size_t source, Address first, size_t size);
+  void resize(int width, int height);
+  void updateLookupTables(const Memory&);
+  void renderDefault(const Memory&);
+  void renderBitmap(const Memory&, int bpp);
+  void renderText(const Memory&);
+};
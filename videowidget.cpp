@@ -1,11 +1,11 @@
 #include "videowidget.h"
 #include "ui_videowidget.h"
-#include <QPainter>
+#include <QFileDialog>
 
 VideoWidget::VideoWidget(QWidget* parent, const Memory& memory) : QDockWidget(parent), ui(new Ui::VideoWidget), memory(memory) {
   ui->setupUi(this);
-  connect(ui->address, QOverload<int>::of(&QSpinBox::valueChanged),
-          [&](Address addr) { ui->screen->setFrameBuffer(&memory[addr], ResolutionX, ResolutionY); });
+  connect(ui->address, QOverload<int>::of(&QSpinBox::valueChanged), this, &VideoWidget::changeFrameBufferAddress);
+  connect(ui->record, &QAbstractButton::toggled, this, &VideoWidget::toggleRecording);
 }
 
 VideoWidget::~VideoWidget() {
@@ -14,13 +14,69 @@ VideoWidget::~VideoWidget() {
 
 void VideoWidget::setFrameBufferAddress(Address addr) {
   ui->address->setValue(addr);
-  addressRange = AddressRange(addr, ResolutionX * ResolutionY - 1);
+  changeFrameBufferAddress(addr);
 }
 
 void VideoWidget::updateOnChange(AddressRange range) {
-  if (addressRange.overlapsWith(range)) updateView();
+  // published frames are not replaced by a live view of memory the program is still drawing into
+  if (running && showingFrame) return;
+
+  if (device.dependsOn(range)) {
+    showingFrame = false;
+    updateView();
+  }
+}
+
+void VideoWidget::updateState(EmulatorState es) {
+  running = es.running();
 }
 
 void VideoWidget::updateView() {
-  ui->screen->update();
+  if (showingFrame) return;
+
+  const auto& pixels = device.render(memory);
+  ui->screen->setFrameBuffer(pixels.data(), device.width(), device.height());
+  ui->screen->refresh();
+}
+
+void VideoWidget::presentFrame(const Data& pixels, int width, int height) {
+  frame = pixels;
+  showingFrame = true;
+  recorder.addFrame(frame, width, height);
+  ui->screen->setFrameBuffer(frame.data(), width, height);
+  ui->screen->refresh();
+}
+
+// of the frame paced execution publishing the frames, so a recording plays back at the same speed
+void VideoWidget::changeFrameRate(Frequency rate) {
+  frameRate = rate;
+}
+
+void VideoWidget::changeFrameBufferAddress(Address addr) {
+  device.setDefaultFrameBuffer(addr);
+  showingFrame = false;
+  updateView();
+  emit defaultFrameBufferChanged(addr);
+}
+
+void VideoWidget::toggleRecording(bool on) {
+  if (!on) {
+    const auto summary = recorder.stop();
+    auto message = tr("recorded %1 frames").arg(summary.frames);
+    if (summary.droppedFrames) message += tr(", dropped %1 the disk could not keep up with").arg(summary.droppedFrames);
+    emit operationCompleted(message, true);
+    return;
+  }
+
+  const auto fileName = QFileDialog::getSaveFileName(this, tr("Record Frames"), "",
+                                                     tr("YUV4MPEG2 (*.y4m);;Compressed palette indices (*.raw)"));
+  CaptureOptions options;
+  options.videoFileName = fileName;
+  options.hashLogFileName = fileName + ".hashes";
+  if (frameRate) options.frameRate = frameRate;
+  if (fileName.isEmpty() || !recorder.start(options)) {
+    if (!fileName.isEmpty()) emit operationCompleted(recorder.summary().error, false);
+    const QSignalBlocker blocker(ui->record);
+    ui->record->setChecked(false);
+  }
 }
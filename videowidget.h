@@ -1,7 +1,10 @@
 #pragma once
 
 #include "addressrange.h"
+#include "emulatorstate.h"
+#include "framerecorder.h"
 #include "memory.h"
+#include "videodevice.h"
 #include <QDockWidget>
 
 namespace Ui {
@@ -13,21 +16,33 @@ class VideoWidget : public QDockWidget
   Q_OBJECT
 
 public:
-  static constexpr auto ResolutionX = 32;
-  static constexpr auto ResolutionY = 32;
-
   explicit VideoWidget(QWidget* parent, const Memory& memory);
   ~VideoWidget();
 
+signals:
+  void defaultFrameBufferChanged(Address);
+  void operationCompleted(const QString& message, bool success);
+
 public slots:
   void setFrameBufferAddress(Address addr);
   void updateOnChange(AddressRange range);
+  void updateState(EmulatorState);
   void updateView();
+  void presentFrame(const Data& pixels, int width, int height);
+  void changeFrameRate(Frequency);
 
 private:
   Ui::VideoWidget *ui;
   const Memory& memory;
-  AddressRange addressRange;
 
-  void fillWithNoise();
+  // renders live memory, replaced by frames published by frame paced execution until memory changes otherwise
+  VideoDevice device;
+  Data frame;
+  bool showingFrame = false;
+  bool running = false;
+  FrameRecorder recorder;
+  Frequency frameRate = 0;
+
+  void changeFrameBufferAddress(Address addr);
+  void toggleRecording(bool);
 };